@@ -0,0 +1,48 @@
+# Embed the S-ADM/ADM templates into a C++ source file
+#
+# Run in script mode:
+#   cmake -DTEMPLATE_DIR=<dir> -DOUTPUT=<file.cpp> -P EmbedTemplates.cmake
+#
+# Each <dir>/*.xml becomes a static byte array, listed by file name in
+# sadmEmbeddedTemplates[] (see src/sadm_template.h)
+
+if(NOT TEMPLATE_DIR OR NOT OUTPUT)
+  message(FATAL_ERROR "EmbedTemplates.cmake needs TEMPLATE_DIR and OUTPUT")
+endif()
+
+file(GLOB templateFiles "${TEMPLATE_DIR}/*.xml")
+list(SORT templateFiles)
+
+set(arrays "")
+set(entries "")
+set(index 0)
+foreach(templateFile ${templateFiles})
+  get_filename_component(templateName "${templateFile}" NAME)
+  # Read as hex so the contents never pass through CMake string handling
+  file(READ "${templateFile}" hex HEX)
+  string(LENGTH "${hex}" hexLength)
+  math(EXPR size "${hexLength} / 2")
+  string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+  string(REGEX REPLACE "(0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,)" "\\1\n\t" bytes "${bytes}")
+  string(APPEND arrays "/* ${templateName} */\nstatic const unsigned char template${index}[${size}] =\n{\n\t${bytes}\n};\n\n")
+  string(APPEND entries "\t{ \"${templateName}\", template${index}, sizeof(template${index}) },\n")
+  math(EXPR index "${index} + 1")
+endforeach()
+
+if(index EQUAL 0)
+  message(FATAL_ERROR "No templates found in ${TEMPLATE_DIR}")
+endif()
+
+set(source "/* Generated by cmake/EmbedTemplates.cmake from ${TEMPLATE_DIR}, do not edit */\n\n#include \"sadm_template.h\"\n\n")
+string(APPEND source "${arrays}")
+string(APPEND source "const SadmEmbeddedTemplate sadmEmbeddedTemplates[] =\n{\n${entries}};\n\n")
+string(APPEND source "const size_t nSadmEmbeddedTemplates = ${index};\n")
+
+# Only touch the output when the contents change to avoid needless rebuilds
+if(EXISTS "${OUTPUT}")
+  file(READ "${OUTPUT}" previous)
+  if(previous STREQUAL source)
+    return()
+  endif()
+endif()
+file(WRITE "${OUTPUT}" "${source}")
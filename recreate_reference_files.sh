@@ -1,13 +1,22 @@
 #!/bin/bash
-export exe="./build_debug/dolbye2sadm"
+# Regenerates the reference files of the cases in test/cases.txt, see run_test.sh
+export exe="${exe:-./build_debug/dolbye2sadm}"
 export dde_dir="./test/dde"
 export ref_dir="./test/reference"
+export flowid_ns="3f2504e0-4f89-11d3-9a0c-0305e82c3301"
 echo $PWD
 ls $exe
-$exe $dde_dir/2+2-1.dde $ref_dir/2+2-1.xml
-$exe $dde_dir/4x2-1.dde $ref_dir/4x2-1.xml
-$exe $dde_dir/5.1+2-1.dde $ref_dir/5.1+2-1.xml
-$exe $dde_dir/5.1+2-2.dde $ref_dir/5.1+2-2.xml
-$exe $dde_dir/5.1-1.dde $ref_dir/5.1-1.xml
-$exe $dde_dir/5.1-2.dde $ref_dir/5.1-2.xml
-
+while read refName ddeStem options ; do
+	case "$refName" in
+		""|\#*) continue ;;
+	esac
+	if [[ $refName == *.txt ]]; then
+		$exe $options $dde_dir/$ddeStem.dde < /dev/null > $ref_dir/$refName
+	elif [[ $refName == *.dde ]]; then
+		`dirname $exe`/dde_extract $options $dde_dir/$ddeStem.dde $ref_dir/$refName < /dev/null
+	elif [[ $refName == *.jsonl ]]; then
+		$exe $options $ref_dir/$refName $dde_dir/$ddeStem.dde < /dev/null > /dev/null
+	else
+		$exe --flowid-ns $flowid_ns $options $dde_dir/$ddeStem.dde $ref_dir/$refName < /dev/null
+	fi
+done < ./test/cases.txt
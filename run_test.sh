@@ -1,6 +1,6 @@
 #!/bin/bash
 
-export exe_dir="./build_release"
+export exe_dir="${exe_dir:-./build_release}"
 export exe="$exe_dir/dolbye2sadm"
 
 if [ ! -f $exe ]; then
@@ -19,41 +19,68 @@ fi
 export test_dir="./test"
 export dde_dir=$test_dir/dde
 export reference_dir="./test/reference"
+export cases=$test_dir/cases.txt
+# flowIDs are derived from a fixed namespace so that outputs compare byte for byte
+export flowid_ns="3f2504e0-4f89-11d3-9a0c-0305e82c3301"
 
 pass_num=0
 fail_num=0
 
-for xmlFile in $test_dir/*.xml ; do
-	xmlFile_stem=`basename $xmlFile .xml`
-	xmlFile_nodir=`basename $xmlFile`
-	refFile=$reference_dir/$xmlFile_nodir
-	ddeFile=$dde_dir/$xmlFile_stem.dde
-	cmd="$exe $ddeFile $xmlFile"
-	echo Executing... $cmd
-	$cmd
-	echo --------------------------------------------
-	echo Validating $xmlFile...
-	xmllint --xpath "//dbmd" $xmlFile | xmllint --schema "XML Schemas/dbmd_schema.xsd" --noout -
+while read refName ddeStem options ; do
+	case "$refName" in
+		""|\#*) continue ;;
+	esac
+	refFile=$reference_dir/$refName
+	outFile=$test_dir/$refName
+	ddeFile=$dde_dir/$ddeStem.dde
+	if [[ $refName == *.txt ]]; then
+		cmd="$exe $options $ddeFile"
+		echo Executing... $cmd
+		$cmd < /dev/null > $outFile
+	elif [[ $refName == *.dde ]]; then
+		cmd="$exe_dir/dde_extract $options $ddeFile $outFile"
+		echo Executing... $cmd
+		$cmd < /dev/null
+	elif [[ $refName == *.jsonl ]]; then
+		cmd="$exe $options $outFile $ddeFile"
+		echo Executing... $cmd
+		$cmd < /dev/null > /dev/null
+	else
+		cmd="$exe --flowid-ns $flowid_ns $options $ddeFile $outFile"
+		echo Executing... $cmd
+		$cmd < /dev/null
+	fi
 	echo --------------------------------------------
 
-	if [ $? -eq "0" ]; then
+	# Outputs of one frame are one document, which is validated against the schema
+	if [[ $refName == *.xml ]] && [ `grep -c "<?xml" $outFile` -eq "1" ]; then
+		echo Validating $outFile...
+		xmllint --xpath "//dbmd" $outFile | xmllint --schema "XML Schemas/dbmd_schema.xsd" --noout -
+		if [ $? -eq "0" ]; then
+			((pass_num++))
+		else
+			((fail_num++))
+		fi
+		echo --------------------------------------------
+	fi
+
+	echo Comparing $outFile with $refFile
+	if diff $outFile $refFile > /dev/null; then
 		((pass_num++))
 	else
+		echo "*** $outFile differs from $refFile"
 		((fail_num++))
 	fi
+done < $cases
 
-	echo Comparing $xmlFile with $refFile
-	# remove flowID which will always be different and can be ignored
-	sed 's/flowID=\"[^"]*\"/flowID=\"\"/g' $xmlFile > diff_file1.tmp
-	sed 's/flowID=\"[^"]*\"/flowID=\"\"/g' $refFile > diff_file2.tmp
-	diff diff_file1.tmp diff_file2.tmp > diffs.tmp
-
-	if [ $? -eq "0" ]; then
+# Unit checks
+for unitTest in $exe_dir/timecode_index_test $exe_dir/feed_parser_test $exe_dir/dolbye_crc_test $exe_dir/shm_ring_test $exe_dir/sadm_daemon_test $exe_dir/continuity_scan_test $exe_dir/follow_reader_test $exe_dir/metadata_timeline_test ; do
+	echo Executing... $unitTest
+	if $unitTest; then
 		((pass_num++))
 	else
 		((fail_num++))
 	fi
-	rm -f diff_file1.tmp diff_file2.tmp diffs.tmp
 done
 
 echo "Number of passes: " $pass_num
@@ -0,0 +1,141 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_ADM_LAYOUT_H_
+#define		_ADM_LAYOUT_H_
+
+#include <array>
+
+#include "ddeinfo.h"
+
+#define NACMODS				8		/* AC-3 channel modes */
+#define MAX_ACMOD_TRACKS	6		/* tracks in the largest (3/2 + LFE) channel mode */
+#define MAX_ADM_TRACKS		(MAX_NPGRMS * MAX_ACMOD_TRACKS)
+#define ADM_ID_LEN			16		/* longest ADM ID + terminator */
+
+/* ADM ID text, formatted at compile time */
+struct AdmId
+{
+	char text[ADM_ID_LEN];
+};
+
+/* Format prefix followed by value as a fixed number of lower case hex digits, as ITU-R BS.2076 IDs are hex */
+constexpr AdmId MakeAdmId(const char *prefix, unsigned int value, int digits)
+{
+	AdmId id = {};
+	int len = 0;
+
+	while (prefix[len] != '\0')
+	{
+		id.text[len] = prefix[len];
+		len++;
+	}
+	for (int i = digits - 1 ; i >= 0 ; i--)
+	{
+		id.text[len + i] = "0123456789abcdef"[value & 0x0f];
+		value >>= 4;
+	}
+	return(id);
+}
+
+/* Table of n IDs, entry i holding prefix + (base + i) */
+template <size_t n>
+constexpr std::array<AdmId, n> MakeAdmIdTable(const char *prefix, unsigned int base, int digits)
+{
+	std::array<AdmId, n> tab = {};
+
+	for (size_t i = 0 ; i < n ; i++)
+	{
+		tab[i] = MakeAdmId(prefix, base + (unsigned int)i, digits);
+	}
+	return(tab);
+}
+
+/* ADM layout of one AC-3 channel mode */
+struct AcmodLayout
+{
+	int nTracks;									/* # tracks, 0 if not supported */
+	AdmId packFormatID;								/* common definitions audioPackFormat */
+	AdmId channelFormatID[MAX_ACMOD_TRACKS];		/* common definitions audioChannelFormat per track */
+};
+
+constexpr AcmodLayout MakeAcmodLayout(int nTracks, unsigned int packNo)
+{
+	AcmodLayout layout = {};
+
+	layout.nTracks = nTracks;
+	layout.packFormatID = MakeAdmId("AP_", 0x00010000 + packNo, 8);
+	for (int ch = 0 ; ch < nTracks ; ch++)
+	{
+		layout.channelFormatID[ch] = MakeAdmId("AC_", 0x00010000 + ch + 1, 8);
+	}
+	return(layout);
+}
+
+/*	Layout per ac3_acmod.
+	The only supported channel modes in spec are 2.0 and 5.1, the others are kept for test purposes.
+	Channel modes that are not in common defs (2/1 and 2/2) use the nearest equivalent pack (3.0 and 3.1) */
+inline constexpr AcmodLayout admAcmodLayoutTab[NACMODS] =
+{
+	MakeAcmodLayout(0, 0x0),	/* 1+1, not supported */
+	MakeAcmodLayout(1, 0x1),	/* 1/0 */
+	MakeAcmodLayout(2, 0x2),	/* 2/0 */
+	MakeAcmodLayout(3, 0xa),	/* 3/0 */
+	MakeAcmodLayout(3, 0xa),	/* 2/1 */
+	MakeAcmodLayout(4, 0xb),	/* 3/1 */
+	MakeAcmodLayout(4, 0xb),	/* 2/2 */
+	MakeAcmodLayout(6, 0x3)		/* 3/2 */
+};
+
+/* audioTrackUID IDs indexed by 1-based track number */
+inline constexpr std::array<AdmId, MAX_ADM_TRACKS + 1> admTrackUIDTab = MakeAdmIdTable<MAX_ADM_TRACKS + 1>("ATU_", 0, 8);
+
+/* Programme, content and object IDs indexed by 0-based programme number */
+inline constexpr std::array<AdmId, MAX_NPGRMS> admProgrammeIDTab = MakeAdmIdTable<MAX_NPGRMS>("APR_", 0x1001, 4);
+inline constexpr std::array<AdmId, MAX_NPGRMS> admContentIDTab = MakeAdmIdTable<MAX_NPGRMS>("ACO_", 0x1001, 4);
+inline constexpr std::array<AdmId, MAX_NPGRMS> admObjectIDTab = MakeAdmIdTable<MAX_NPGRMS>("AO_", 0x1001, 4);
+
+/* ADM layout of a whole Dolby E frame, one entry per programme */
+struct AdmFrameLayout
+{
+	int nProgs;									/* # programmes (from program_config) */
+	int totalTracks;							/* # tracks over all programmes */
+	int firstTrack[MAX_NPGRMS];					/* 1-based track number of each programme's first track */
+	const AcmodLayout *prog[MAX_NPGRMS];		/* channel mode layout of each programme */
+};
+
+#endif //		_ADM_LAYOUT_H_
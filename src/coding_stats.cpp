@@ -0,0 +1,160 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+#include "coding_stats.h"
+#include "dolbye_parser.h"
+
+static std::string Percent(double share)
+{
+	char text[16];
+
+	snprintf(text, sizeof(text), "%.1f%%", 100.0 * share);
+	return(text);
+}
+
+static std::string Percent(uint64_t part, uint64_t whole)
+{
+	return(Percent((whole > 0) ? (double)part / whole : 0.0));
+}
+
+/**************************************************************************************************************************************************************/
+CodingStats::CodingStats(void)
+{
+	memset(channels, 0, sizeof(channels));
+	memset(programmes, 0, sizeof(programmes));
+	for (int ch = 0 ; ch < MAX_NCHANS ; ch++)
+	{
+		channels[ch].minUnused = 1.0;
+	}
+}
+
+void CodingStats::Add(DolbyEParser &parser, const FrameInfoStruct &frameInfo)
+{
+	bool transient[MAX_NPGRMS] = { false };
+	int n = std::min(frameInfo.nChans, MAX_NCHANS);
+
+	nChans = std::max(nChans, n);
+	nProgs = std::max(nProgs, std::min(frameInfo.nProgs, MAX_NPGRMS));
+	for (int ch = 0 ; ch < n ; ch++)
+	{
+		CodingChannelStats &stats = channels[ch];
+		int progNo = parser.GetChannelProgramme(frameInfo.progConfig, ch);
+		CodingProgrammeStats *prog = (progNo >= 0 && progNo < MAX_NPGRMS) ? &programmes[progNo] : NULL;
+
+		for (int half = 0 ; half < 2 ; half++)
+		{
+			const ChannelUsageStruct &usage = parser.GetChannelUsage(ch, half);
+			if (!usage.valid || usage.subsegBits <= 0)
+			{
+				continue;
+			}
+			double unused = (double)usage.unusedBits / usage.subsegBits;
+			bool starved = (unused < CODING_STARVED_SHARE);
+
+			stats.subsegments++;
+			if (usage.groupTypeCode >= 0 && usage.groupTypeCode < CODING_GROUP_TYPES)
+			{
+				stats.groupTypes[usage.groupTypeCode]++;
+			}
+			if (usage.bandwidthCode >= 0 && usage.bandwidthCode < CODING_BANDWIDTHS)
+			{
+				stats.bandwidths[usage.bandwidthCode]++;
+			}
+			stats.lfe = stats.lfe || (usage.groupTypeCode < 0);
+			stats.unusedHistogram[std::min((int)(unused * CODING_UNUSED_BUCKETS), CODING_UNUSED_BUCKETS - 1)]++;
+			stats.bits += usage.subsegBits;
+			stats.unusedBits += usage.unusedBits;
+			stats.starved += starved;
+			stats.minUnused = std::min(stats.minUnused, unused);
+			if (prog != NULL)
+			{
+				prog->bits += usage.subsegBits;
+				prog->unusedBits += usage.unusedBits;
+				prog->starved += starved;
+				transient[progNo] = transient[progNo] || (usage.groupTypeCode == SHORT) || (usage.groupTypeCode == BRIDGE);
+			}
+		}
+	}
+	for (int progNo = 0 ; progNo < std::min(frameInfo.nProgs, MAX_NPGRMS) ; progNo++)
+	{
+		programmes[progNo].frames++;
+		programmes[progNo].transientFrames += transient[progNo];
+	}
+	frames++;
+}
+
+void CodingStats::Print(std::ostream &out, const char *const names[MAX_NCHANS]) const
+{
+	for (int ch = 0 ; ch < nChans ; ch++)
+	{
+		const CodingChannelStats &stats = channels[ch];
+		uint64_t n = stats.subsegments;
+
+		out << "Channel " << ch << " (" << names[ch] << "): " << n << " subsegments";
+		if (!stats.lfe)
+		{
+			out << ", long " << Percent(stats.groupTypes[LONG], n) << " short " << Percent(stats.groupTypes[SHORT], n)
+				<< " bridge " << Percent(stats.groupTypes[BRIDGE], n) << ", bandwidth codes";
+			for (int bw = 0 ; bw < CODING_BANDWIDTHS ; bw++)
+			{
+				if (stats.bandwidths[bw] > 0)
+				{
+					out << " " << bw << ":" << Percent(stats.bandwidths[bw], n);
+				}
+			}
+		}
+		out << ", unused bits " << Percent(stats.unusedBits, stats.bits) << " min " << Percent((n > 0) ? stats.minUnused : 0.0)
+			<< ", " << stats.starved << " near starved, unused share by tenths";
+		for (int b = 0 ; b < CODING_UNUSED_BUCKETS ; b++)
+		{
+			out << " " << stats.unusedHistogram[b];
+		}
+		out << std::endl;
+	}
+	for (int progNo = 0 ; progNo < nProgs ; progNo++)
+	{
+		const CodingProgrammeStats &prog = programmes[progNo];
+		out << "Programme " << progNo << ": " << prog.frames << " frames, " << prog.transientFrames << " with short or bridge blocks ("
+			<< Percent(prog.transientFrames, prog.frames) << "), unused bits " << Percent(prog.unusedBits, prog.bits) << ", "
+			<< prog.starved << " near starved subsegments" << std::endl;
+	}
+}
+/**************************************************************************************************************************************************************/
@@ -0,0 +1,102 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_CODING_STATS_H_
+#define		_CODING_STATS_H_
+
+#include <stdint.h>
+#include <ostream>
+
+#include "ddeinfo.h"
+
+class DolbyEParser;
+
+#define CODING_GROUP_TYPES		3			/* LONG, SHORT, BRIDGE */
+#define CODING_BANDWIDTHS		8			/* 3 bit bandwidth codes */
+#define CODING_UNUSED_BUCKETS	10			/* unused bits histogram, in tenths of the subsegment */
+#define CODING_STARVED_SHARE	0.01		/* subsegments with less than this share of bits unused are near starved */
+
+/* Whole file coding of one channel's subsegments, primary and extension counted alike */
+struct CodingChannelStats
+{
+	uint64_t subsegments;
+	uint64_t groupTypes[CODING_GROUP_TYPES];
+	uint64_t bandwidths[CODING_BANDWIDTHS];
+	uint64_t unusedHistogram[CODING_UNUSED_BUCKETS];
+	uint64_t bits;
+	uint64_t unusedBits;
+	uint64_t starved;
+	double minUnused;				/* smallest share of a subsegment unused */
+	bool lfe;
+};
+
+struct CodingProgrammeStats
+{
+	uint64_t frames;
+	uint64_t transientFrames;		/* frames in which any of its channels used short or bridge blocks */
+	uint64_t bits;
+	uint64_t unusedBits;
+	uint64_t starved;
+};
+
+/*	Histograms of each channel's group types, bandwidth codes and unused bits over a file, and the same per
+	programme, to find transient heavy content and encodes short of bits. Uses the channel usage the parser
+	records for every frame parsed in full, see DolbyEParser::GetChannelUsage() */
+class CodingStats
+{
+private:
+	int nChans = 0;
+	int nProgs = 0;
+	uint64_t frames = 0;
+	CodingChannelStats channels[MAX_NCHANS];
+	CodingProgrammeStats programmes[MAX_NPGRMS];
+
+public:
+	CodingStats(void);
+
+	// Add the frame parser has just handed to its frame callback
+	void Add(DolbyEParser &parser, const FrameInfoStruct &frameInfo);
+
+	uint64_t FrameCount(void) const { return(frames); }
+	const CodingChannelStats &Channel(int ch) const { return(channels[ch]); }
+	const CodingProgrammeStats &Programme(int progNo) const { return(programmes[progNo]); }
+
+	// A line per channel and per programme
+	void Print(std::ostream &out, const char *const names[MAX_NCHANS]) const;
+};
+
+#endif //		_CODING_STATS_H_
@@ -0,0 +1,303 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <stdexcept>
+#include <algorithm>
+#include <thread>
+#include <filesystem>
+#include <stdio.h>
+
+#include "continuity_scan.h"
+#include "dolbye_parser.h"
+
+static std::string TimecodeText(const uint8_t tc[4])
+{
+	char text[32];
+
+	if ((tc[0] & 0x3f) == 0x3f)
+	{
+		return("invalid");
+	}
+	snprintf(text, sizeof(text), "%02d:%02d:%02d:%02d (%s)",
+			 (((tc[0] >> 4) & 0x03) * 10) + (tc[0] & 0x0f), (((tc[1] >> 4) & 0x07) * 10) + (tc[1] & 0x0f),
+			 (((tc[2] >> 4) & 0x07) * 10) + (tc[2] & 0x0f), (((tc[3] >> 4) & 0x03) * 10) + (tc[3] & 0x0f),
+			 ((tc[3] >> 6) & 0x01) ? "drop" : "nondrop");
+	return(text);
+}
+
+// Whether two frame spacings can be the alternating spacings of one frame rate
+static bool InCadence(uint64_t a, uint64_t b)
+{
+	return(((a > b) ? a - b : b - a) * CONT_CADENCE_RATIO <= std::max(a, b));
+}
+
+/**************************************************************************************************************************************************************/
+ContinuityScanner::ContinuityScanner(const std::string &file, unsigned int threads) :
+	fileName(file),
+	nThreads(std::max(threads, 1u))
+{
+}
+
+// Follow frames from the first sync at or after from. Stop at the first frame at or beyond the chunk's end or,
+// with converge, at the first frame that is also in converge
+void ContinuityScanner::ScanRange(Chunk &chunk, uint64_t from, const std::vector<FrameRecord> *converge)
+{
+	FILE *fp = fopen(fileName.c_str(), "rb");
+	if (fp == NULL)
+	{
+		chunk.error = "Error: File not found";
+		return;
+	}
+	if (fseek(fp, (long)from, SEEK_SET) != 0)
+	{
+		fclose(fp);
+		chunk.error = "Error: Unable to seek in input file";
+		return;
+	}
+
+	DolbyEParser parser;
+	bool done = false;
+	parser.SetMetadataOnly(true);
+	parser.SetFrameCallback([&](const FrameInfoStruct &frameInfo)
+	{
+		uint64_t offset = from + parser.FedFrameOffset();
+		if (done)
+		{
+			return;
+		}
+		bool reached = (converge != NULL) ?
+			std::binary_search(converge->begin(), converge->end(), FrameRecord{ offset, 0, 0, { 0 } },
+				[](const FrameRecord &a, const FrameRecord &b) { return(a.offset < b.offset); }) :
+			(offset >= chunk.end);
+		if (reached)
+		{
+			chunk.next = offset;
+			done = true;
+			return;
+		}
+		FrameRecord record;
+		record.offset = offset;
+		record.frameCount = (uint16_t)frameInfo.frame_count;
+		record.frameRate = (uint8_t)frameInfo.frameRate;
+		for (int i = 0 ; i < 4 ; i++)
+		{
+			record.timecode[i] = (uint8_t)frameInfo.timecode[2 * i + 1];
+		}
+		chunk.frames.push_back(record);
+	});
+
+	// Past the end, give up if no frame starts within the distance the probe searches
+	std::vector<uint8_t> buf(SCAN_READ_SZ);
+	uint64_t position = from;
+	while (!done)
+	{
+		size_t len = fread(buf.data(), 1, buf.size(), fp);
+		if (len == 0)
+		{
+			break;
+		}
+		parser.Feed(buf.data(), len);
+		position += len;
+		uint64_t last = chunk.frames.empty() ? from : chunk.frames.back().offset;
+		if (!done && position > chunk.end && position - std::max(last, chunk.end) > PROBE_MAX_BYTES)
+		{
+			break;
+		}
+	}
+	fclose(fp);
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void ContinuityScanner::Scan(void)
+{
+	std::error_code ec;
+	fileSize = std::filesystem::file_size(fileName, ec);
+	if (ec)
+	{
+		throw std::runtime_error("Error: File not found");
+	}
+
+	// Word aligned chunks, a thread for each
+	unsigned int nChunks = (unsigned int)std::max((uint64_t)1, std::min((uint64_t)nThreads, fileSize / SCAN_READ_SZ));
+	std::vector<Chunk> chunks(nChunks);
+	for (unsigned int i = 0 ; i < nChunks ; i++)
+	{
+		chunks[i].start = (fileSize * i / nChunks) / FILE_WORD_SZ * FILE_WORD_SZ;
+		chunks[i].end = (i + 1 < nChunks) ? (fileSize * (i + 1) / nChunks) / FILE_WORD_SZ * FILE_WORD_SZ : UINT64_MAX;
+		chunks[i].next = UINT64_MAX;
+	}
+	std::vector<std::thread> threads;
+	for (unsigned int i = 1 ; i < nChunks ; i++)
+	{
+		threads.emplace_back(&ContinuityScanner::ScanRange, this, std::ref(chunks[i]), chunks[i].start, (const std::vector<FrameRecord> *)NULL);
+	}
+	ScanRange(chunks[0], chunks[0].start, NULL);
+	for (std::thread &thread : threads)
+	{
+		thread.join();
+	}
+	for (const Chunk &chunk : chunks)
+	{
+		if (!chunk.error.empty())
+		{
+			throw std::runtime_error(chunk.error);
+		}
+	}
+
+	// Join the chunks where the frames followed from one agree with those found by the next
+	for (unsigned int i = 1 ; i < nChunks ; i++)
+	{
+		Chunk &prev = chunks[i - 1];
+		Chunk &cur = chunks[i];
+		std::vector<FrameRecord>::iterator first = cur.frames.begin();
+		if (prev.next != UINT64_MAX)
+		{
+			first = std::lower_bound(cur.frames.begin(), cur.frames.end(), prev.next,
+				[](const FrameRecord &r, uint64_t offset) { return(r.offset < offset); });
+			if (first == cur.frames.end() || first->offset != prev.next)
+			{
+				// The next chunk synced elsewhere; carry on from prev's frames until the two meet
+				Chunk bridge;
+				bridge.end = UINT64_MAX;
+				bridge.next = UINT64_MAX;
+				ScanRange(bridge, prev.next, &cur.frames);
+				if (!bridge.error.empty())
+				{
+					throw std::runtime_error(bridge.error);
+				}
+				prev.frames.insert(prev.frames.end(), bridge.frames.begin(), bridge.frames.end());
+				if (bridge.next == UINT64_MAX)
+				{
+					// They never met, so prev's frames run to the end of the file
+					for (unsigned int j = i ; j < nChunks ; j++)
+					{
+						chunks[j].frames.clear();
+					}
+					break;
+				}
+				first = std::lower_bound(cur.frames.begin(), cur.frames.end(), bridge.next,
+					[](const FrameRecord &r, uint64_t offset) { return(r.offset < offset); });
+			}
+		}
+		cur.frames.erase(cur.frames.begin(), first);
+	}
+	Check(chunks);
+}
+
+void ContinuityScanner::Check(const std::vector<Chunk> &chunks)
+{
+	const FrameRecord *prev = NULL;
+	uint64_t spacing = 0;
+	uint64_t cadence[2] = { 0, 0 };		/* spacings of the stream, two alternating at fractional frame rates */
+	bool spacingReported = false;
+
+	events.clear();
+	frames = 0;
+	for (const Chunk &chunk : chunks)
+	{
+		for (const FrameRecord &frame : chunk.frames)
+		{
+			if (prev != NULL)
+			{
+				// At 29.97 and 59.94 fps the spacing alternates between two values a sample apart, so the first spacing
+				// close to the learnt one joins the cadence. Back in the cadence after a discontinuity is not another, and
+				// a new spacing, or pair of spacings, that carries on is a change of rate, reported at its first frame only
+				uint64_t gap = frame.offset - prev->offset;
+				bool reported = false;
+				if (gap != cadence[0] && gap != cadence[1])
+				{
+					if (cadence[0] == 0)
+					{
+						cadence[0] = gap;
+					}
+					else if (spacingReported && InCadence(gap, spacing))
+					{
+						cadence[0] = spacing;
+						cadence[1] = (gap != spacing) ? gap : 0;
+					}
+					else if (cadence[1] == 0 && InCadence(gap, cadence[0]))
+					{
+						cadence[1] = gap;
+					}
+					else
+					{
+						events.push_back({ CONT_SPACING, frames, frame.offset, std::to_string(spacing) + " bytes", std::to_string(gap) + " bytes" });
+						reported = true;
+					}
+				}
+				spacing = gap;
+				spacingReported = reported;
+
+				if (frame.frameCount != (uint16_t)(prev->frameCount + 1))
+				{
+					events.push_back({ CONT_FRAME_COUNT, frames, frame.offset, std::to_string(prev->frameCount), std::to_string(frame.frameCount) });
+				}
+
+				int tc[8] = { 0 };
+				int prevTc[8] = { 0 };
+				for (int i = 0 ; i < 4 ; i++)
+				{
+					tc[2 * i + 1] = frame.timecode[i];
+					prevTc[2 * i + 1] = prev->timecode[i];
+				}
+				if (!DolbyEParser::TimeCodeFollows(tc, prevTc, frame.frameRate))
+				{
+					events.push_back({ CONT_TIMECODE, frames, frame.offset, TimecodeText(prev->timecode), TimecodeText(frame.timecode) });
+				}
+			}
+			prev = &frame;
+			frames++;
+		}
+	}
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void ContinuityScanner::Print(std::ostream &out) const
+{
+	static const char *typeText[] = { "frame_count", "time code", "frame spacing" };
+
+	for (const ContinuityEvent &event : events)
+	{
+		out << "Frame " << event.frameNo << " at byte " << event.offset << ": " << typeText[event.type] << " "
+			<< event.before << " -> " << event.after << std::endl;
+	}
+}
+/**************************************************************************************************************************************************************/
@@ -0,0 +1,112 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_CONTINUITY_SCAN_H_
+#define		_CONTINUITY_SCAN_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <ostream>
+
+#define SCAN_READ_SZ		(1024 * 1024)	/* bytes read per call by each scanning thread */
+#define CONT_CADENCE_RATIO	64				/* the two spacings of a fractional frame rate differ by at most 1/64 */
+
+enum ContinuityEventType
+{
+	CONT_FRAME_COUNT,			/* frame_count is not one more than the last */
+	CONT_TIMECODE,				/* SMPTE time code does not follow on, see DolbyEParser::TimeCodeFollows() */
+	CONT_SPACING				/* frames further apart (or closer) than the stream's cadence: lost sync, or frames lost or inserted */
+};
+
+struct ContinuityEvent
+{
+	ContinuityEventType type;
+	uint64_t frameNo;			/* of the frame after the discontinuity, from 0 */
+	uint64_t offset;			/* of its preamble */
+	std::string before;			/* value in the frame before, and in this one */
+	std::string after;
+};
+
+/*	Checks frame_count, time code and frame spacing across a whole .dde file. Only the sync and metadata
+	segments of each frame are parsed. The file is split into a chunk per thread; each thread follows
+	the frames from the first sync in its chunk until it reaches the next chunk, and where it arrives on a
+	frame the next thread did not sync on (e.g. a false sync in audio data), the boundary is rescanned
+	until the two agree */
+class ContinuityScanner
+{
+private:
+	struct FrameRecord
+	{
+		uint64_t offset;
+		uint16_t frameCount;
+		uint8_t frameRate;
+		uint8_t timecode[4];	/* SMPTE_time_code bytes 1, 3, 5 and 7, the ones holding hours, minutes, seconds and frames */
+	};
+
+	struct Chunk
+	{
+		uint64_t start;
+		uint64_t end;
+		std::vector<FrameRecord> frames;	/* preambles in [start, end) */
+		uint64_t next;						/* first frame followed to at or beyond end, UINT64_MAX if none */
+		std::string error;
+	};
+
+	std::string fileName;
+	unsigned int nThreads;
+	uint64_t fileSize = 0;
+	uint64_t frames = 0;
+	std::vector<ContinuityEvent> events;
+
+	void ScanRange(Chunk &chunk, uint64_t from, const std::vector<FrameRecord> *converge);
+	void Check(const std::vector<Chunk> &chunks);
+
+public:
+	ContinuityScanner(const std::string &file, unsigned int threads);
+
+	// Scan the file, throwing if it cannot be read
+	void Scan(void);
+
+	uint64_t FrameCount(void) const { return(frames); }
+	const std::vector<ContinuityEvent> &Events(void) const { return(events); }
+
+	// One line per discontinuity
+	void Print(std::ostream &out) const;
+};
+
+#endif //		_CONTINUITY_SCAN_H_
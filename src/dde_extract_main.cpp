@@ -0,0 +1,357 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+#include "ddeinfo.h"
+#include "dolbye_parser.h"
+#include "timecode_index.h"
+
+#define CADENCE_FRAMES	5			/* frame spacings repeat every 5 frames, alternating at 29.97 and 59.94 fps */
+
+/* Byte range of whole frames in the input, and how it was found */
+struct ExtractRange
+{
+	uint64_t start;				/* first frame's preamble */
+	uint64_t end;				/* the next frame's preamble, or end of file, so each frame keeps the guard band after it */
+	uint32_t frames;
+	bool indexed;				/* the whole file was indexed, rather than the frames located from their spacing */
+};
+
+void show_usage(void)
+{
+    std::cerr << "Usage: dde_extract [options] infile.dde outfile.dde" << std::endl;
+    std::cerr << "Copies a range of whole frames of infile, with the guard band after each, to outfile." << std::endl;
+    std::cerr << "    --from pos     first frame, a frame number from 0 or a time code hh:mm:ss:ff (default the first)" << std::endl;
+    std::cerr << "    --to pos       last frame, included (default the last)" << std::endl;
+    exit(2);
+}
+
+// Offset of frame number frame, from the offsets of the first CADENCE_FRAMES + 1 frames relative to the first
+static uint64_t cadence_offset(const DolbyEProbe &first, const uint64_t cadence[CADENCE_FRAMES + 1], uint64_t frame)
+{
+    return(first.syncOffset + (frame / CADENCE_FRAMES) * cadence[CADENCE_FRAMES] + cadence[frame % CADENCE_FRAMES]);
+}
+
+// Frame number pos, if the file's frames keep the cadence of the first from the first up to it. Checked by probing the
+// frame where it should be, whose frame_count (and time code, where pos is one) must follow on from the first frame's
+static bool locate_spaced(const std::string &fileName, const DolbyEProbe &first, const uint64_t cadence[CADENCE_FRAMES + 1],
+                          const char *pos, uint32_t &frameNo, uint64_t &offset)
+{
+    int32_t timecode = -1;
+    uint64_t frame;
+
+    if (strpbrk(pos, ":;") != NULL)
+    {
+        if (!TimecodeIndex::ParseTimecode(pos, first.frameRate, timecode) || first.timecodeFrames < 0 || timecode < first.timecodeFrames)
+        {
+            return(false);
+        }
+        frame = (uint64_t)(timecode - first.timecodeFrames);
+    }
+    else
+    {
+        char *end;
+        frame = strtoull(pos, &end, 10);
+        if (*pos == '\0' || *end != '\0')
+        {
+            return(false);
+        }
+    }
+
+    if (frame > UINT32_MAX || (offset = cadence_offset(first, cadence, frame)) >= first.fileSize)
+    {
+        return(false);
+    }
+    try
+    {
+        DolbyEProbe probe = DolbyEParser::Probe(fileName, offset);
+        if (probe.syncOffset != offset || probe.frameCount != ((first.frameCount + frame) & 0xffff) ||
+            (timecode >= 0 && probe.timecodeFrames != timecode))
+        {
+            return(false);
+        }
+    }
+    catch (const std::exception &)
+    {
+        return(false);
+    }
+    frameNo = (uint32_t)frame;
+    return(true);
+}
+
+// Start of the frame after the one at offset, or the end of the file
+static uint64_t next_frame(const std::string &fileName, const DolbyEProbe &first, uint64_t offset)
+{
+    try
+    {
+        return(DolbyEParser::Probe(fileName, offset + first.frameBytes).syncOffset);
+    }
+    catch (const std::exception &)
+    {
+        return(first.fileSize);
+    }
+}
+
+// Locate the range from the first frames and their cadence, which needs a few probes whatever the size of the file.
+// If a frame is not where the cadence puts it, or is not the one expected, index the whole file instead
+static ExtractRange find_range(const std::string &fileName, const char *fromPos, const char *toPos)
+{
+    ExtractRange range;
+    DolbyEProbe first = DolbyEParser::Probe(fileName);
+    if (!first.sizeKnown)
+    {
+        throw std::runtime_error("Error: Input is not a file that can be cut");
+    }
+    uint64_t cadence[CADENCE_FRAMES + 1] = { 0 };
+    uint32_t firstFrame = 0;
+    uint32_t lastFrame = 0;
+    uint64_t lastOffset = first.syncOffset;
+    bool spaced = true;
+
+    // A file too short for a whole cadence is indexed, which costs little
+    for (int frame = 1 ; frame <= CADENCE_FRAMES && spaced ; frame++)
+    {
+        uint64_t offset = next_frame(fileName, first, first.syncOffset + cadence[frame - 1]);
+        spaced = (offset < first.fileSize);
+        cadence[frame] = offset - first.syncOffset;
+    }
+
+    if (spaced && fromPos)
+    {
+        spaced = locate_spaced(fileName, first, cadence, fromPos, firstFrame, range.start);
+    }
+    else
+    {
+        range.start = first.syncOffset;
+    }
+    if (spaced && toPos)
+    {
+        spaced = locate_spaced(fileName, first, cadence, toPos, lastFrame, lastOffset);
+    }
+    else if (spaced)
+    {
+        // The last frame is the last the cadence fits whole in the file, if it is there
+        uint64_t left = first.fileSize - first.syncOffset;
+        uint64_t frames = (left / cadence[CADENCE_FRAMES]) * CADENCE_FRAMES;
+        for (int frame = 1 ; frame < CADENCE_FRAMES && cadence[frame] <= left % cadence[CADENCE_FRAMES] ; frame++)
+        {
+            frames++;
+        }
+        std::string last = std::to_string(frames - 1);
+        spaced = locate_spaced(fileName, first, cadence, last.c_str(), lastFrame, lastOffset);
+        spaced = spaced && (next_frame(fileName, first, lastOffset) == first.fileSize);
+    }
+
+    if (spaced)
+    {
+        range.end = next_frame(fileName, first, lastOffset);
+        range.indexed = false;
+    }
+    else
+    {
+        DolbyEParser parser(fileName);
+        const TimecodeIndex &index = parser.GetTimecodeIndex();
+        firstFrame = 0;
+        lastFrame = index.FrameCount() - 1;
+        if ((fromPos && !index.FindPosition(fromPos, firstFrame)) || (toPos && !index.FindPosition(toPos, lastFrame)) || index.FrameCount() == 0)
+        {
+            throw std::runtime_error("Error: Range is not in the input file");
+        }
+        index.FrameOffset(firstFrame, range.start);
+        if (!index.FrameOffset(lastFrame + 1, range.end))
+        {
+            range.end = first.fileSize;
+        }
+        range.indexed = true;
+    }
+    if (lastFrame < firstFrame)
+    {
+        throw std::runtime_error("Error: --to is before --from in the input file");
+    }
+    range.frames = lastFrame - firstFrame + 1;
+    return(range);
+}
+
+// Copy len bytes from in at offset to out in the kernel where possible
+static void copy_range(int in, int out, uint64_t offset, uint64_t len)
+{
+    off_t inOffset = (off_t)offset;
+
+#ifdef __linux__
+    // copy_file_range() shares extents on file systems that can, otherwise sendfile() copies in the kernel
+    bool useSendfile = false;
+    while (len > 0)
+    {
+        ssize_t n = useSendfile ? sendfile(out, in, &inOffset, (size_t)std::min(len, (uint64_t)0x7ffff000)) :
+                                  copy_file_range(in, &inOffset, out, NULL, (size_t)std::min(len, (uint64_t)0x7ffff000), 0);
+        if (n < 0 && !useSendfile && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP))
+        {
+            useSendfile = true;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            throw std::runtime_error(std::string("Error: Copy failed: ") + (n < 0 ? strerror(errno) : "input ended early"));
+        }
+        len -= (uint64_t)n;
+    }
+#else
+    char buf[1 << 16];
+    while (len > 0)
+    {
+        ssize_t n = pread(in, buf, (size_t)std::min(len, (uint64_t)sizeof(buf)), inOffset);
+        if (n <= 0)
+        {
+            throw std::runtime_error(std::string("Error: Copy failed: ") + (n < 0 ? strerror(errno) : "input ended early"));
+        }
+        for (ssize_t done = 0 ; done < n ; )
+        {
+            ssize_t w = write(out, buf + done, (size_t)(n - done));
+            if (w < 0)
+            {
+                throw std::runtime_error(std::string("Error: Copy failed: ") + strerror(errno));
+            }
+            done += w;
+        }
+        inOffset += n;
+        len -= (uint64_t)n;
+    }
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+    char *inputFileName = nullptr;
+    char *outputFileName = nullptr;
+    char *fromPos = nullptr;
+    char *toPos = nullptr;
+
+    for (int arg = 1 ; arg < argc ; arg++)
+    {
+        if (!strcmp(argv[arg], "--from") && (arg + 1 < argc))
+        {
+            fromPos = argv[++arg];
+        }
+        else if (!strcmp(argv[arg], "--to") && (arg + 1 < argc))
+        {
+            toPos = argv[++arg];
+        }
+        else if (argv[arg][0] == '-' && argv[arg][1] == '-')
+        {
+            show_usage();
+        }
+        else if (!inputFileName)
+        {
+            inputFileName = argv[arg];
+        }
+        else if (!outputFileName)
+        {
+            outputFileName = argv[arg];
+        }
+        else
+        {
+            show_usage();
+        }
+    }
+    if (!inputFileName || !outputFileName)
+    {
+        show_usage();
+    }
+
+    int in = -1;
+    int out = -1;
+    try
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        ExtractRange range = find_range(inputFileName, fromPos, toPos);
+
+        if ((in = open(inputFileName, O_RDONLY)) < 0)
+        {
+            throw std::runtime_error("Error: File not found");
+        }
+        if ((out = open(outputFileName, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)
+        {
+            throw std::runtime_error(std::string("Error: Unable to open ") + outputFileName + ": " + strerror(errno));
+        }
+        copy_range(in, out, range.start, range.end - range.start);
+        if (close(out) != 0)
+        {
+            out = -1;
+            throw std::runtime_error(std::string("Error: Unable to write ") + outputFileName + ": " + strerror(errno));
+        }
+        out = -1;
+        close(in);
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << "Extracted " << range.frames << " frames, bytes " << range.start << " to " << range.end
+                  << (range.indexed ? " (file indexed)" : "") << " in " << ms << " ms" << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        if (out >= 0)
+        {
+            close(out);
+            unlink(outputFileName);
+        }
+        if (in >= 0)
+        {
+            close(in);
+        }
+        return 1;
+    }
+    return 0;
+}
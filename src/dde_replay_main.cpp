@@ -0,0 +1,333 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <memory>
+#include <functional>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ddeinfo.h"
+#include "dolbye_parser.h"
+#include "shm_ring.h"
+
+/* Exact frame periods as num / den seconds, indexed by frame rate code - 1 */
+static const long long periodNumTab[NUMFRAMERATES] = { 1001, 1, 1, 1001, 1 };
+static const long long periodDenTab[NUMFRAMERATES] = { 24000, 24, 25, 30000, 30 };
+
+struct ReplayFrame
+{
+	size_t offset;				/* of the first byte after the previous frame, so gaps go out with the frame after them */
+	size_t length;
+};
+
+void show_usage(void)
+{
+    std::cerr << "Usage: dde_replay [options] infile.dde [output]" << std::endl;
+    std::cerr << "Writes the frames of infile to output (a FIFO, a file or - for stdout, the default) at the frame rate" << std::endl;
+    std::cerr << "given by the stream's frame_rate_code." << std::endl;
+    std::cerr << "    --shm          output names a shared memory ring to create, see src/shm_ring.h" << std::endl;
+    std::cerr << "    --shm-size n   ring size in bytes, at least " << FRAME_MAX_BYTES << " (default " << SHM_RING_DEFAULT_SZ << ")" << std::endl;
+    std::cerr << "    --loop n       play the file n times, 0 to repeat until interrupted (default 1)" << std::endl;
+    std::cerr << "    --jitter us    write each frame up to us microseconds early or late, uniformly distributed" << std::endl;
+    std::cerr << "    --burst n      hold frames back and write them n at a time, when the last of each group is due" << std::endl;
+    std::cerr << "    --drop n       drop every nth frame" << std::endl;
+    std::cerr << "    --seed n       random seed for --jitter, so runs can be repeated (default 1)" << std::endl;
+    exit(2);
+}
+
+// Split the file into frames by pushing it through the parser a word at a time
+static int split_frames(const std::vector<uint8_t> &data, std::vector<ReplayFrame> &frames)
+{
+    DolbyEParser parser;
+    int frameRate = 0;
+    bool frameDone = false;
+    size_t frameStart = 0;
+
+    parser.SetFrameCallback([&](const FrameInfoStruct &frameInfo)
+    {
+        frameRate = frameInfo.frameRate;
+        frameDone = true;
+    });
+    for (size_t offset = 0 ; offset + FILE_WORD_SZ <= data.size() ; offset += FILE_WORD_SZ)
+    {
+        parser.Feed(&data[offset], FILE_WORD_SZ);
+        if (frameDone)
+        {
+            frames.push_back({frameStart, offset + FILE_WORD_SZ - frameStart});
+            frameStart = offset + FILE_WORD_SZ;
+            frameDone = false;
+        }
+    }
+    if (!frames.empty())
+    {
+        // Anything after the last frame goes with it
+        frames.back().length = data.size() - frames.back().offset;
+    }
+    return(frameRate);
+}
+
+static void write_all(int fd, const uint8_t *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = write(fd, data, len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw std::runtime_error(std::string("Error: Unable to write output: ") + strerror(errno));
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return((long long)ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
+static void sleep_until_ns(long long t)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t)(t / 1000000000);
+    ts.tv_nsec = (long)(t % 1000000000);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+    {
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *inputFileName = nullptr;
+    const char *outputFileName = "-";
+    bool outputNamed = false;
+    unsigned int loops = 1;
+    long long jitterNs = 0;
+    unsigned int burst = 1;
+    unsigned int dropEvery = 0;
+    unsigned int seed = 1;
+    bool toRing = false;
+    size_t ringSz = SHM_RING_DEFAULT_SZ;
+
+// Parse command line arguments
+    for (int arg = 1 ; arg < argc ; arg++)
+    {
+        if (!strcmp(argv[arg], "--loop") && (arg + 1 < argc))
+        {
+            loops = (unsigned int)atoi(argv[++arg]);
+        }
+        else if (!strcmp(argv[arg], "--jitter") && (arg + 1 < argc))
+        {
+            jitterNs = atoll(argv[++arg]) * 1000;
+        }
+        else if (!strcmp(argv[arg], "--burst") && (arg + 1 < argc))
+        {
+            burst = (unsigned int)atoi(argv[++arg]);
+        }
+        else if (!strcmp(argv[arg], "--drop") && (arg + 1 < argc))
+        {
+            dropEvery = (unsigned int)atoi(argv[++arg]);
+        }
+        else if (!strcmp(argv[arg], "--seed") && (arg + 1 < argc))
+        {
+            seed = (unsigned int)atoi(argv[++arg]);
+        }
+        else if (!strcmp(argv[arg], "--shm"))
+        {
+            toRing = true;
+        }
+        else if (!strcmp(argv[arg], "--shm-size") && (arg + 1 < argc))
+        {
+            ringSz = (size_t)atoll(argv[++arg]);
+        }
+        else if (argv[arg][0] == '-' && argv[arg][1] == '-')
+        {
+            show_usage();
+        }
+        else if (!inputFileName)
+        {
+            inputFileName = argv[arg];
+        }
+        else if (!outputNamed)
+        {
+            outputFileName = argv[arg];
+            outputNamed = true;
+        }
+        else
+        {
+            show_usage();
+        }
+    }
+    if (!inputFileName || burst == 0 || jitterNs < 0 || (toRing && !outputNamed))
+    {
+        show_usage();
+    }
+
+// Read and split the input up front so nothing but the writes is paced
+    std::ifstream inputFile(inputFileName, std::ios::binary);
+    if (!inputFile.is_open())
+    {
+        throw std::runtime_error("Error: File not found");
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
+    std::vector<ReplayFrame> frames;
+    int frameRate = split_frames(data, frames);
+    if (frames.empty() || frameRate < 1 || frameRate > NUMFRAMERATES)
+    {
+        throw std::runtime_error("Error: No Dolby E frames found");
+    }
+    long long num = periodNumTab[frameRate - 1] * 1000000000;
+    long long den = periodDenTab[frameRate - 1];
+
+// Open the output, for a FIFO this waits for the reader
+    std::unique_ptr<ShmRing> ring;
+    std::function<void(const uint8_t *, size_t)> output;
+    int fd = -1;
+    if (toRing)
+    {
+        // The reader parses each frame where it lies, so the largest must fit
+        if (ringSz < FRAME_MAX_BYTES)
+        {
+            throw std::runtime_error("Error: A ring of " + std::to_string(ringSz) + " bytes cannot hold a Dolby E frame of up to " +
+                                     std::to_string(FRAME_MAX_BYTES) + " bytes");
+        }
+        ring.reset(new ShmRing(outputFileName, ringSz));
+        output = [&ring](const uint8_t *p, size_t len) { ring->Write(p, len); };
+    }
+    else
+    {
+        signal(SIGPIPE, SIG_IGN);
+        fd = strcmp(outputFileName, "-") ? open(outputFileName, O_WRONLY | O_CREAT | O_TRUNC, 0644) : STDOUT_FILENO;
+        if (fd < 0)
+        {
+            throw std::runtime_error(std::string("Error: Unable to open ") + outputFileName + ": " + strerror(errno));
+        }
+        output = [fd](const uint8_t *p, size_t len) { write_all(fd, p, len); };
+    }
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<long long> jitter(-jitterNs, jitterNs);
+    unsigned long long written = 0, dropped = 0, lateWrites = 0;
+    long long worstLateNs = 0;
+    std::vector<const ReplayFrame *> pending;
+
+// Frame n (from 0) is due n periods after the start; jitter moves single writes and does not accumulate
+    long long start = now_ns();
+    unsigned long long frameNo = 0;
+    try
+    {
+        for (unsigned int loop = 0 ; loops == 0 || loop < loops ; loop++)
+        {
+            for (const ReplayFrame &frame : frames)
+            {
+                frameNo++;
+                if (dropEvery && (frameNo % dropEvery) == 0)
+                {
+                    dropped++;
+                    continue;
+                }
+                pending.push_back(&frame);
+                if (pending.size() < burst)
+                {
+                    continue;
+                }
+
+                long long due = start + (long long)(((__int128)(frameNo - 1) * num) / den);
+                if (jitterNs)
+                {
+                    due += jitter(rng);
+                }
+                sleep_until_ns(due);
+                for (const ReplayFrame *p : pending)
+                {
+                    output(&data[p->offset], p->length);
+                    written++;
+                }
+                pending.clear();
+
+                // The reader holding us back shows up as writes finishing late
+                long long late = now_ns() - due;
+                if (late > num / den / 10)
+                {
+                    lateWrites++;
+                    worstLateNs = std::max(worstLateNs, late);
+                }
+            }
+        }
+        for (const ReplayFrame *p : pending)
+        {
+            output(&data[p->offset], p->length);
+            written++;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+    if (ring)
+    {
+        // The ring goes when this process exits, so wait for the reader to take everything
+        size_t space;
+        ring->Close();
+        ring->Reserve(ring->Capacity(), space, -1);
+    }
+    else if (fd != STDOUT_FILENO)
+    {
+        close(fd);
+    }
+
+    std::cerr << "Frames written " << written << ", dropped " << dropped << ", completed over a tenth of a period late "
+              << lateWrites << " (worst " << (double)worstLateNs / 1000.0 << " us)" << std::endl;
+    return((written + dropped == frameNo) ? 0 : 1);
+}
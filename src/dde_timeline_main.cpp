@@ -0,0 +1,199 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ddeinfo.h"
+#include "dolbye_parser.h"
+#include "metadata_timeline.h"
+
+#define TIMELINE_READ_SZ	(1024 * 1024)	/* bytes read per Feed() while building */
+
+void show_usage(void)
+{
+    std::cerr << "Usage: dde_timeline build infile.dde timeline.ddtl" << std::endl;
+    std::cerr << "       dde_timeline columns timeline.ddtl" << std::endl;
+    std::cerr << "       dde_timeline at timeline.ddtl field element pos" << std::endl;
+    std::cerr << "       dde_timeline spans timeline.ddtl field element op value" << std::endl;
+    std::cerr << "Builds a run-length encoded timeline of every frame's metadata and meters, and queries it without the .dde file." << std::endl;
+    std::cerr << "    field element  a field as in metadata_changes.cpp, or peak_meter or rms_meter, and its programme, channel" << std::endl;
+    std::cerr << "                   or subsegment (0 for per frame fields)" << std::endl;
+    std::cerr << "    pos            a frame number from 0, or a time code hh:mm:ss:ff" << std::endl;
+    std::cerr << "    op value       spans where the value compares with value, op one of == != < <= > >=" << std::endl;
+    exit(2);
+}
+
+static void build(const char *inputFileName, const char *timelineFileName)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<unsigned char> buf(TIMELINE_READ_SZ);
+    TimelineWriter writer;
+    DolbyEParser parser;
+
+    FILE *fp = fopen(inputFileName, "rb");
+    if (!fp)
+    {
+        throw std::runtime_error("Error: File not found");
+    }
+    // The whole frame is parsed, as the meters follow the audio
+    parser.SetFrameCallback([&](const FrameInfoStruct &frameInfo)
+    {
+        writer.Add(parser.FedFrameOffset(), frameInfo);
+    });
+    size_t len;
+    while ((len = fread(buf.data(), 1, buf.size(), fp)) > 0)
+    {
+        parser.Feed(buf.data(), len);
+    }
+    fclose(fp);
+    writer.Write(timelineFileName);
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "Built timeline of " << writer.FrameCount() << " frames in " << ms << " ms" << std::endl;
+}
+
+static int find_column(const TimelineFile &timeline, const char *field, const char *element)
+{
+    int column = timeline.FindColumn(field, atoi(element));
+    if (column < 0)
+    {
+        throw std::runtime_error(std::string("Error: No column ") + field + "[" + element + "]");
+    }
+    return(column);
+}
+
+static std::string frame_text(const TimelineFile &timeline, uint32_t frameNo)
+{
+    return("frame " + std::to_string(frameNo) + " " +
+           TimecodeIndex::TimecodeText(timeline.Timecodes().FrameTimecode(frameNo), timeline.FrameRate()));
+}
+
+static int query_at(const TimelineFile &timeline, char *args[])
+{
+    int column = find_column(timeline, args[0], args[1]);
+    uint32_t frameNo;
+    int32_t value;
+
+    if (!timeline.Timecodes().FindPosition(args[2], frameNo) || !timeline.ValueAt(column, frameNo, value))
+    {
+        throw std::runtime_error(std::string("Error: Frame ") + args[2] + " not found");
+    }
+    std::cout << frame_text(timeline, frameNo) << " " << args[0] << "[" << args[1] << "] " << value << std::endl;
+    return 0;
+}
+
+static int query_spans(const TimelineFile &timeline, char *args[])
+{
+    static const char *ops[] = { "==", "!=", "<", "<=", ">", ">=" };
+    int column = find_column(timeline, args[0], args[1]);
+    int32_t operand = (int32_t)atoi(args[3]);
+    int op = 0;
+
+    while (op < 6 && strcmp(args[2], ops[op]))
+    {
+        op++;
+    }
+    if (op == 6)
+    {
+        show_usage();
+    }
+    std::vector<TimelineSpan> spans = timeline.Spans(column, [op, operand](int32_t v)
+    {
+        switch (op)
+        {
+            case 0: return(v == operand);
+            case 1: return(v != operand);
+            case 2: return(v < operand);
+            case 3: return(v <= operand);
+            case 4: return(v > operand);
+            default: return(v >= operand);
+        }
+    });
+    for (const TimelineSpan &span : spans)
+    {
+        std::cout << frame_text(timeline, span.firstFrame) << " to " << frame_text(timeline, span.firstFrame + span.count - 1)
+                  << " (" << span.count << " frames) " << args[0] << "[" << args[1] << "] " << span.value << std::endl;
+    }
+    return spans.empty() ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        show_usage();
+    }
+    try
+    {
+        if (!strcmp(argv[1], "build") && argc == 4)
+        {
+            build(argv[2], argv[3]);
+            return 0;
+        }
+        TimelineFile timeline(argv[2]);
+        if (!strcmp(argv[1], "columns") && argc == 3)
+        {
+            std::cout << timeline.FrameCount() << " frames" << std::endl;
+            for (int c = 0 ; c < timeline.ColumnCount() ; c++)
+            {
+                std::cout << timeline.Column(c).name << " " << timeline.Column(c).element << " " << timeline.Column(c).nRuns << " runs" << std::endl;
+            }
+            return 0;
+        }
+        if (!strcmp(argv[1], "at") && argc == 6)
+        {
+            return query_at(timeline, argv + 3);
+        }
+        if (!strcmp(argv[1], "spans") && argc == 7)
+        {
+            return query_spans(timeline, argv + 3);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    show_usage();
+}
@@ -49,6 +49,15 @@
 #define DISP_META		0x0002
 #define DISP_METR		0x0004
 
+#define CRC_ERR_METADATA		0x0001	/* segments failing their CRC check, FrameInfoStruct crcErrors */
+#define CRC_ERR_AUDIO0			0x0002
+#define CRC_ERR_AUDIO1			0x0004
+#define CRC_ERR_METADATA_EXT	0x0008
+#define CRC_ERR_AUDIO_EXT0		0x0010
+#define CRC_ERR_AUDIO_EXT1		0x0020
+#define CRC_ERR_METER			0x0040
+#define CRC_NSEGMENTS			7
+
 #define NUMFRAMERATES	5
 
 #define DEC2BCD(in)		(((in/10) << 4) + (in % 10))
@@ -72,6 +81,8 @@ enum		/* group types */
 #define MAX_BITDEPTH	24
 #define	MAX_NCHANS		8
 #define	MAX_NBLKS		9
+#define MAX_NREGIONS	2
+#define MAX_NBANDS		50
 #define MAX_NPGRMS		8
 #define MAX_ADDBSIBYTES 64
 #define MAX_NUMSEGS		3
@@ -221,6 +232,7 @@ typedef struct {
 	int description_text[MAX_NPGRMS];  /* description text character */	
 	int metadata_crc;				/* metadata CRC value */
 	int metadata_extension_crc;		/* metadata extension CRC value */
+	int crcErrors;					/* CRC_ERR_ bits, where CRCs are checked */
 	int timecode[8];				/* time code */
 
 } FrameInfoStruct;
@@ -235,8 +247,26 @@ typedef struct {
 	int regionCount[MAX_NBLKS];		/* number of regions per block */
 	int bandCount[MAX_NBLKS];		/* number of bands per block */
 	int prevGroupTypeCode;			/* previous group type code */
+	int expStrategy[MAX_NBLKS];		/* exponent strategy, 1 if the block's exponents are sent */
+	int masterExp[MAX_NBLKS][MAX_NREGIONS];	/* master exponents */
+	int biasedExp[MAX_NBLKS][MAX_NBANDS];	/* biased exponents */
 } ChannelSubsegInfoStruct;
 
+typedef struct {
+	int valid;						/* subsegment parsed in this frame */
+	int blockCount;					/* number of blocks */
+	int bandCount[MAX_NBLKS];		/* number of bands per block */
+	int exponent[MAX_NBLKS][MAX_NBANDS];	/* biased exponent plus three per master exponent of its region, reused blocks filled in */
+} ChannelExponentStruct;
+
+typedef struct {
+	int valid;						/* subsegment parsed in this frame */
+	int groupTypeCode;				/* group type code, -1 for LFE */
+	int bandwidthCode;				/* bandwidth code, -1 for LFE */
+	int subsegBits;					/* # bits in the subsegment */
+	int unusedBits;					/* # bits left unused at its end */
+} ChannelUsageStruct;
+
 #endif	//	_DDEINFO_H_
 
 
@@ -35,6 +35,7 @@
  *
  ******************************************************************************/
 
+#include <stddef.h>
 #include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
@@ -49,6 +50,7 @@
 static int init_channel_subseg_info(ChannelSubsegInfoStruct *cip);
 static double GetComprDB(int value);
 static int check_time_code(int *current_tc, int *last_tc, int frame_rate);
+static int subsegment_words(const FrameInfoStruct *fip, int firstChan, int endChan);
 
 int DolbyEParser::compare_frameinfo(FrameInfoStruct *info1, FrameInfoStruct *info2)
 {
@@ -84,9 +86,9 @@ int DolbyEParser::compare_frameinfo(FrameInfoStruct *info1, FrameInfoStruct *inf
                 timeCodeText[(info1->timecode[7] >> 6) & 0x01]);
     }
 
-    for (i = 0; i < ((sizeof(FrameInfoStruct) / sizeof(int)) - MAX_NCHANS - 12 - MAX_NPGRMS - 16); i++)
-    {   /*compare everying but prevGroupTypeCode, frame_count, metadata_crc, 
-            metadata_extension_crc, metadata key, timecode and meter segment*/
+    for (i = 0; i < (offsetof(FrameInfoStruct, Meter) / sizeof(int)); i++)
+    {   /*compare everything up to the meter segment, so not prevGroupTypeCode, frame_count,
+            metadata_crc, metadata_extension_crc, metadata key, crcErrors or timecode either*/
         if ((*intptr1++) != (*intptr2++)) return(1);
     }    
 
@@ -94,25 +96,23 @@ int DolbyEParser::compare_frameinfo(FrameInfoStruct *info1, FrameInfoStruct *inf
 }
 
 /*****************************************************************************
-*    findPreambleSync: find frame preamble sync
+*    checkPreamble: test for a Dolby E frame preamble
 *
 *    inputs:
+*        preamble            PREAMBLE_SZ words unpacked at MAX_BITDEPTH
 *        fip                    pointer to frame info structure
 *
 *    outputs:
-*        return value        0 if no error, nonzero if error
-*        fip->frameLength    set based on preamble (only valid if no error)
-*        fip->wordSz            set based on preamble (only valid if no error)
+*        return value        1 if Dolby E preamble, 0 if not, -1 if error
+*        fip->frameLength    set based on preamble (only valid if 1 returned)
+*        fip->wordSz            set based on preamble (only valid if 1 returned)
 *****************************************************************************/
 
-int DolbyEParser::findPreambleSync(FrameInfoStruct *fip)
+int DolbyEParser::checkPreamble(const int preamble[], FrameInfoStruct *fip)
 {
-
     int payloadSz;                /* in words */
-    int bitdepth, err;
-    int preamble[PREAMBLE_SZ], i;
+    int bitdepth, i;
 
-/*    Search for preamble sync */
 /*    Preamble format is as follows:
         sync a            0xf872 (16) or 0x6f872 (20) or 0x96f872 (24)
         sync b            0x4e1f (16) or 0x54e1f (20) or 0xa54e1f (24)
@@ -120,56 +120,88 @@ int DolbyEParser::findPreambleSync(FrameInfoStruct *fip)
         length            payload length in bits
 */
 
-    if ((err = dolbyEFile.InitStream(MAX_BITDEPTH))) return(err);
-    if ((err = dolbyEFile.ReadFile(PREAMBLE_SZ))) return(err);
-    if ((err = dolbyEFile.BitUnp_rj(preamble, PREAMBLE_SZ, MAX_BITDEPTH))) return(err);
-
-    while (1)
-    {
-
 /*    Test for sync for each possible bit depth */
 
-        for (i = 0; i < MAX_BITDEPTH; i++)
+    for (i = 0; i < nBitDepths; i++)
+    {
+        if (((preamble[0] & maskSync[i]) == preambleSyncA[i])
+            && ((preamble[1] & maskSync[i]) == preambleSyncB[i]))
         {
-            if (((preamble[0] & maskSync[i]) == preambleSyncA[i])
-                && ((preamble[1] & maskSync[i]) == preambleSyncB[i]))
+            if ((preamble[2] & maskType) != preambleDolbyE)
             {
-                if ((preamble[2] & maskType) != preambleDolbyE)
-                {
-                    printf("Warning: Not Dolby E bitstream\n");
-                }
-                else if ((preamble[2] & maskMode) != preambleMode[i])
-                {
-                    printf("Warning: Inconsistent preamble data mode\n");
-                }
-                else if ((preamble[2] & maskErr) != preambleNoErr)
-                {
-                    printf("Warning: Error flag set\n");
-                }
-                else if ((preamble[2] & maskStrmNum) != preambleStrm0)
-                {
-                    printf("Warning: Only stream #0 supported\n");
-                }
-                else
+                fprintf(stderr, "Warning: Not Dolby E bitstream\n");
+            }
+            else if ((preamble[2] & maskMode) != preambleMode[i])
+            {
+                fprintf(stderr, "Warning: Inconsistent preamble data mode\n");
+            }
+            else if ((preamble[2] & maskErr) != preambleNoErr)
+            {
+                fprintf(stderr, "Warning: Error flag set\n");
+            }
+            else if ((preamble[2] & maskStrmNum) != preambleStrm0)
+            {
+                fprintf(stderr, "Warning: Only stream #0 supported\n");
+            }
+            else
+            {
+                bitdepth = bitDepthTab[i];
+                payloadSz = preamble[3] >> (MAX_BITDEPTH - bitdepth);
+                if (((payloadSz / bitdepth) * bitdepth) != payloadSz)
                 {
-                    bitdepth = bitDepthTab[i];
-                    payloadSz = preamble[3] >> (MAX_BITDEPTH - bitdepth);
-                    if (((payloadSz / bitdepth) * bitdepth) != payloadSz)
-                    {
-                        printf("Error: Inconsistent preamble payload size\n");
-                        return(-1);
-                    }
-                    else
-                    {
-                        fip->wordSz = bitdepth;
-                        fip->frameLength = payloadSz / bitdepth;
-                        if ((err = dolbyEFile.InitStream(bitdepth))) return(err);
-                        if ((err = dolbyEFile.ReadFile(payloadSz / bitdepth))) return(err);
-                        return(0);
-                    }
+                    fprintf(stderr, "Error: Inconsistent preamble payload size\n");
+                    return(-1);
                 }
+                fip->wordSz = bitdepth;
+                fip->frameLength = payloadSz / bitdepth;
+                return(1);
             }
         }
+    }
+
+    return(0);
+
+}    /* checkPreamble() */
+
+/*****************************************************************************
+*    findPreambleSync: find frame preamble sync. In resilient mode a
+*    preamble that is inconsistent or too long is searched past
+*
+*    inputs:
+*        fip                    pointer to frame info structure
+*
+*    outputs:
+*        return value        0 if no error, nonzero if error
+*        fip->frameLength    set based on preamble (only valid if no error)
+*        fip->wordSz            set based on preamble (only valid if no error)
+*****************************************************************************/
+
+int DolbyEParser::findPreambleSync(FrameInfoStruct *fip)
+{
+    int err, found;
+    int preamble[PREAMBLE_SZ], i;
+
+/*    Search for preamble sync */
+
+    if ((err = dolbyEFile.InitStream(MAX_BITDEPTH))) return(err);
+    if ((err = dolbyEFile.ReadFile(PREAMBLE_SZ))) return(err);
+    if ((err = dolbyEFile.BitUnp_rj(preamble, PREAMBLE_SZ, MAX_BITDEPTH))) return(err);
+
+    while (1)
+    {
+        found = checkPreamble(preamble, fip);
+        if (resilient && ((found < 0) || ((found > 0) && (fip->frameLength > DATA_BUF_SZ))))
+        {
+            /* a damaged preamble, search on past it */
+            found = 0;
+        }
+        if (found < 0) return(-1);
+        if (found)
+        {
+            if ((err = dolbyEFile.InitStream(fip->wordSz))) return(err);
+            if ((err = dolbyEFile.ReadFile(fip->frameLength))) return(err);
+            return(0);
+        }
 
         for (i = 0; i < (PREAMBLE_SZ - 1); i++)
         {
@@ -198,8 +230,72 @@ int DolbyEParser::Dolby_E_frame(FrameInfoStruct *fip)
 {
     int err;
 
+    if ((err = Dolby_E_frame_metadata(fip))) return(err);
+    return(Dolby_E_frame_remainder(fip));
+}
+
+/*****************************************************************************
+*    Dolby_E_frame_metadata: parse the start of the Dolby E frame, up to and
+*    including the metadata segment
+*
+*    inputs:
+*        fip                    pointer to frame info structure
+*
+*    outputs:
+*        return value        0 if no error, nonzero if error
+*        *fip                updated in sync and metadata segment parser
+*****************************************************************************/
+
+int DolbyEParser::Dolby_E_frame_metadata(FrameInfoStruct *fip)
+{
+    int err;
+
     if ((err = sync_segment(fip))) return(err);    
     if ((err = metadata_segment(fip))) return(err);
+
+    return(0);
+}
+
+/*****************************************************************************
+*    Dolby_E_frame_timecode: parse the start of the Dolby E frame, up to and
+*    including the SMPTE time code in the metadata segment, for indexing
+*
+*    inputs:
+*        fip                    pointer to frame info structure
+*
+*    outputs:
+*        return value        0 if no error, nonzero if error
+*        *fip                sync segment, frame rate, frame_count and time code
+*****************************************************************************/
+
+int DolbyEParser::Dolby_E_frame_timecode(FrameInfoStruct *fip)
+{
+    int err;
+
+    if ((err = sync_segment(fip))) return(err);
+    if ((err = metadata_segment_head(fip))) return(err);
+
+    return(0);
+}
+
+/*****************************************************************************
+*    Dolby_E_frame_remainder: parse the rest of the Dolby E frame, following
+*    Dolby_E_frame_metadata()
+*
+*    inputs:
+*        fip                    pointer to frame info structure
+*
+*    outputs:
+*        return value        0 if no error, nonzero if error
+*****************************************************************************/
+
+int DolbyEParser::Dolby_E_frame_remainder(FrameInfoStruct *fip)
+{
+    int err;
+
+    if (exponentCapture) memset(channelExponents, 0, sizeof(channelExponents));
+    memset(channelUsage, 0, sizeof(channelUsage));
+
     if ((err = audio_segment(fip))) return(err);
 
     if (fip->lowFrameRate)
@@ -320,20 +416,21 @@ int DolbyEParser::display_sync_segment(FILE *xmlfp, FrameInfoStruct *fip, int di
 }    /* sync_segment() */
 
 /*****************************************************************************
-*    metadata_segment: parse the metadata segment
+*    metadata_segment_head: parse the metadata segment up to and including
+*    SMPTE_time_code, unkeying the whole segment
 *
 *    inputs:
 *        fip                    pointer to frame info structure
 *
 *    outputs:
 *        return value        0 if no error, nonzero if error
-*        *fip                updates remaining elements (only valid if no error)
+*        *fip                program config, frame rates, frame_count and time
+*                            code (only valid if no error)
 *****************************************************************************/
 
-int DolbyEParser::metadata_segment(FrameInfoStruct *fip)
+int DolbyEParser::metadata_segment_head(FrameInfoStruct *fip)
 {
-    int    err, seg = 0;
-    int pgm, ch;
+    int    err;
 
     /* metadata key */
     if (fip->keyPresent)
@@ -358,7 +455,7 @@ int DolbyEParser::metadata_segment(FrameInfoStruct *fip)
     if ((err = dolbyEFile.BitUnp_rj(&fip->Metadata.program_config, 1, 6))) return(err);
     if (fip->Metadata.program_config >= NPGMCFG)
     {
-        printf("Error: invalid program config %d\n", fip->Metadata.program_config);
+        fprintf(stderr, "Error: invalid program config %d\n", fip->Metadata.program_config);
         return(-1);
     }
 
@@ -371,7 +468,7 @@ int DolbyEParser::metadata_segment(FrameInfoStruct *fip)
     if ((err = dolbyEFile.BitUnp_rj(&fip->Metadata.frame_rate_code, 1, 4))) return(err);
     if ((fip->Metadata.frame_rate_code == 0) || (fip->Metadata.frame_rate_code >= 9))
     {
-        printf("Error: invalid frame rate %d\n", fip->Metadata.frame_rate_code);
+        fprintf(stderr, "Error: invalid frame rate %d\n", fip->Metadata.frame_rate_code);
         return(-1);
     }
 
@@ -390,7 +487,7 @@ int DolbyEParser::metadata_segment(FrameInfoStruct *fip)
     if ((fip->Metadata.original_frame_rate_code == 0) 
         || (fip->Metadata.original_frame_rate_code >= 9))
     {
-        printf("Error: invalid original frame rate %d\n", fip->Metadata.original_frame_rate_code);
+        fprintf(stderr, "Error: invalid original frame rate %d\n", fip->Metadata.original_frame_rate_code);
         return(-1);
     }
 
@@ -400,6 +497,85 @@ int DolbyEParser::metadata_segment(FrameInfoStruct *fip)
     /* SMPTE_time_code */
     if ((err = dolbyEFile.BitUnp_rj(fip->timecode, 8, 8))) return(err);
 
+    return(0);
+}    /* metadata_segment_head() */
+
+/*****************************************************************************
+*    description_text_char: add the description_text character of a
+*    programme to the message being received. Characters go to a working
+*    buffer, and the message is published to description_text_buf only on
+*    ETX, and only if its STX was seen, so a message joined part way through
+*    or cut short by a lost frame is never published. The published text is
+*    left as it is until the next message is complete
+*
+*    inputs:
+*        fip                    pointer to frame info structure
+*        pgm                    programme number
+*
+*    outputs:
+*        return value        0 if no error, nonzero if the character is invalid
+*****************************************************************************/
+
+int DolbyEParser::description_text_char(FrameInfoStruct *fip, int pgm)
+{
+    switch (fip->description_text[pgm])
+    {
+        case 0x00:    
+            null_char_warning[pgm] = 1;
+            break;
+        case 0x02:
+            desc_text_ptr[pgm] = 0;
+            desc_text_started[pgm] = true;
+            break;
+        case 0x03:
+            /* only a message received from its start is complete */
+            if (desc_text_started[pgm] && (desc_text_ptr[pgm] > 0))
+            {
+                memcpy(description_text_buf[pgm], desc_text_work[pgm], desc_text_ptr[pgm]);
+                description_text_buf[pgm][desc_text_ptr[pgm]] = '\0';
+                desc_text_received[pgm] = true;
+                desc_text_updates++;
+            }
+            desc_text_started[pgm] = false;
+            break;
+        default:
+            if ((fip->description_text[pgm] < 0x20) || 
+                (fip->description_text[pgm] > 0x7e)) return(65535);        
+
+            /* text beyond the buffer is dropped, keeping the start of the message */
+            if (desc_text_ptr[pgm] < (MAX_DESCTEXTLEN - 1))
+            {
+                desc_text_work[pgm][desc_text_ptr[pgm]] = (char)fip->description_text[pgm];
+                desc_text_ptr[pgm]++;
+            }
+            else
+            {
+                desc_text_length_error[pgm] = 1;
+            }
+            break;
+    }
+
+    return(0);
+}    /* description_text_char() */
+
+/*****************************************************************************
+*    metadata_segment: parse the metadata segment
+*
+*    inputs:
+*        fip                    pointer to frame info structure
+*
+*    outputs:
+*        return value        0 if no error, nonzero if error
+*        *fip                updates remaining elements (only valid if no error)
+*****************************************************************************/
+
+int DolbyEParser::metadata_segment(FrameInfoStruct *fip)
+{
+    int    err, seg = 0;
+    int pgm, ch;
+
+    if ((err = metadata_segment_head(fip))) return(err);
+
     /* metadata_reserved_bits */
     if ((err = dolbyEFile.BitUnp_rj(&fip->Metadata.metadata_reserved_bits, 1, 8))) return(err);
 
@@ -421,32 +597,7 @@ int DolbyEParser::metadata_segment(FrameInfoStruct *fip)
     {
         /* description_text[pgm] */
         if ((err = dolbyEFile.BitUnp_rj(&fip->description_text[pgm], 1, 8))) return(err);
-        switch (fip->description_text[pgm])
-        {
-            case 0x00:    
-                null_char_warning[pgm] = 1;
-                break;
-            case 0x02:
-                desc_text_ptr[pgm] = 0;
-                break;
-            case 0x03:
-                description_text_buf[pgm][desc_text_ptr[pgm]] = '\0';
-                break;
-            default:
-                if ((fip->description_text[pgm] < 0x20) || 
-                    (fip->description_text[pgm] > 0x7e)) return(65535);        
-
-                description_text_buf[pgm][desc_text_ptr[pgm]] = fip->description_text[pgm];
-                desc_text_ptr[pgm]++;
-
-                if(desc_text_ptr[pgm] >= MAX_DESCTEXTLEN)
-                {
-                    desc_text_length_error[pgm] = 1;
-                    desc_text_ptr[pgm] = 0;
-                    description_text_buf[pgm][MAX_DESCTEXTLEN - 1] = '\0';
-                }
-                break;
-        }
+        if ((err = description_text_char(fip, pgm))) return(err);
 
         /* bandwidth_id[pgm] */
         if ((err = dolbyEFile.BitUnp_rj(&fip->Metadata.bandwidth_id[pgm], 1, 2))) return(err);
@@ -497,7 +648,15 @@ int DolbyEParser::metadata_segment(FrameInfoStruct *fip)
     if ((err = dolbyEFile.SkipBits(fip->Metadata.unused_metadata_bits))) return(err);                        
     
         /* metadata_crc */
+        if (crcCheck && (err = check_crc(fip, CRC_ERR_METADATA, fip->Metadata.metadata_segment_size + 1))) return(err);
         dolbyEFile.BitUnp_rj(&fip->metadata_crc, 1, fip->wordSz);
+
+        /* the stream's first intact metadata segment identifies it, see GenerateUUID() */
+        if (firstMetadata.empty() && !(fip->crcErrors & CRC_ERR_METADATA))
+        {
+            firstMetadata.assign((const char *)dolbyEFile.GetBuffer(),
+                                 (1 + fip->keyPresent + fip->Metadata.metadata_segment_size + 1) * sizeof(Int32));
+        }
     
         return(0);
     }    /* metadata_segment() */
@@ -1596,11 +1755,14 @@ int DolbyEParser::audio_segment(FrameInfoStruct *fip)
         if ((err = dolbyEFile.SetDnCntr(0, fip->chanSubsegSz[ch] * fip->wordSz))) return(err);
         if ((err = channel_subsegment(cip))) return(err);
         fip->prevGroupTypeCode[ch] = cip->groupTypeCode;
+        if (exponentCapture) capture_exponents(ch, cip);
         value = dolbyEFile.GetDnCntr(0);        
+        record_usage(ch, cip, fip->chanSubsegSz[ch] * fip->wordSz, value);
         if ((err = dolbyEFile.SkipBits(value))) return(err);                        
     }
 
     /* audio_subsegment0_crc */
+    if (crcCheck && (err = check_crc(fip, CRC_ERR_AUDIO0, subsegment_words(fip, 0, fip->nChans/2) + 1))) return(err);
     dolbyEFile.BitUnp_rj(&value, 1, fip->wordSz);
 
     /* audio_subsegment1_key */
@@ -1624,11 +1786,14 @@ int DolbyEParser::audio_segment(FrameInfoStruct *fip)
         if ((err = dolbyEFile.SetDnCntr(0, fip->chanSubsegSz[ch] * fip->wordSz))) return(err);
         if ((err = channel_subsegment(cip))) return(err);
         fip->prevGroupTypeCode[ch] = cip->groupTypeCode;
+        if (exponentCapture) capture_exponents(ch, cip);
         value = dolbyEFile.GetDnCntr(0);    
+        record_usage(ch, cip, fip->chanSubsegSz[ch] * fip->wordSz, value);
         if ((err = dolbyEFile.SkipBits(value))) return(err);                        
     }
 
     /* audio_subsegment1_crc */
+    if (crcCheck && (err = check_crc(fip, CRC_ERR_AUDIO1, subsegment_words(fip, fip->nChans/2, fip->nChans) + 1))) return(err);
     dolbyEFile.BitUnp_rj(&value, 1, fip->wordSz);
 
     return(0);
@@ -1688,6 +1853,7 @@ int DolbyEParser::metadata_extension_segment(FrameInfoStruct *fip)
     if ((err = dolbyEFile.SkipBits(fip->MetadataExt.unused_metadata_extension_bits))) return(err);                        
 
     /* metadata_extension_crc */
+    if (crcCheck && (err = check_crc(fip, CRC_ERR_METADATA_EXT, fip->metaExtSz + 1))) return(err);
     dolbyEFile.BitUnp_rj(&fip->metadata_extension_crc, 1, fip->wordSz);
 
     return(0);
@@ -1961,11 +2127,14 @@ int DolbyEParser::audio_extension_segment(FrameInfoStruct *fip)
         if ((err = dolbyEFile.SetDnCntr(0, fip->chanSubsegSz[ch] * fip->wordSz))) return(err);
         cip->prevGroupTypeCode = fip->prevGroupTypeCode[ch];
         if ((err = channel_subsegment(cip))) return(err);
+        if (exponentCapture) capture_exponents(ch, cip);
         value = dolbyEFile.GetDnCntr(0);        
+        record_usage(ch, cip, fip->chanSubsegSz[ch] * fip->wordSz, value);
         if ((err = dolbyEFile.SkipBits(value))) return(err);                        
     }
 
     /* audio_extension_subsegment0_crc */
+    if (crcCheck && (err = check_crc(fip, CRC_ERR_AUDIO_EXT0, subsegment_words(fip, 0, fip->nChans/2) + 1))) return(err);
     dolbyEFile.BitUnp_rj(&value, 1, fip->wordSz);
 
     /* audio_extension_subsegment1_key */
@@ -1989,11 +2158,14 @@ int DolbyEParser::audio_extension_segment(FrameInfoStruct *fip)
         if ((err = dolbyEFile.SetDnCntr(0, fip->chanSubsegSz[ch] * fip->wordSz))) return(err);
         cip->prevGroupTypeCode = fip->prevGroupTypeCode[ch];
         if ((err = channel_subsegment(cip))) return(err);
+        if (exponentCapture) capture_exponents(ch, cip);
         value = dolbyEFile.GetDnCntr(0);
+        record_usage(ch, cip, fip->chanSubsegSz[ch] * fip->wordSz, value);
         if ((err = dolbyEFile.SkipBits(value))) return(err);                        
     }
 
     /* audio_extension_subsegment1_crc */
+    if (crcCheck && (err = check_crc(fip, CRC_ERR_AUDIO_EXT1, subsegment_words(fip, fip->nChans/2, fip->nChans) + 1))) return(err);
     dolbyEFile.BitUnp_rj(&value, 1, fip->wordSz);
 
     return(0);
@@ -2042,6 +2214,7 @@ int DolbyEParser::meter_segment(FrameInfoStruct *fip)
     if ((err = dolbyEFile.SkipBits(value))) return(err);                        
 
     /* meter_crc */
+    if (crcCheck && (err = check_crc(fip, CRC_ERR_METER, fip->meterSz + 1))) return(err);
     dolbyEFile.BitUnp_rj(&value, 1, fip->wordSz);
 
     return(0);
@@ -2154,9 +2327,8 @@ int DolbyEParser::display_meter_segment(FILE *xmlfp, FrameInfoStruct *fip, int d
 
 int DolbyEParser::channel_subsegment(ChannelSubsegInfoStruct *cip)
 {
-    int expStrat[MAX_NBLKS];
     int value, err;
-    int blk, reg, bnd;
+    int blk, bnd;
 
 /*    group structure fields */
 
@@ -2188,7 +2360,7 @@ int DolbyEParser::channel_subsegment(ChannelSubsegInfoStruct *cip)
         if (((cip->prevGroupTypeCode == SHORT) && (cip->groupTypeCode != SHORT))
             || ((cip->prevGroupTypeCode != SHORT) && (cip->groupTypeCode == SHORT)))
         {
-            printf("Error: Illegal group type in extension subsegment\n");
+            fprintf(stderr, "Error: Illegal group type in extension subsegment\n");
             return(-1);
         }
     }
@@ -2214,21 +2386,15 @@ int DolbyEParser::channel_subsegment(ChannelSubsegInfoStruct *cip)
         {
             if ((err = dolbyEFile.BitUnp_rj(&value, 1, 1))) return(err);            
         }
-        expStrat[blk] = value;
+        cip->expStrategy[blk] = value;
 
         if (value)
         {
-            /* master_exponent[blk][reg] */            
-            for (reg = 0; reg < cip->regionCount[blk]; reg++)
-            {
-                if ((err = dolbyEFile.BitUnp_rj(&value, 1, 2))) return(err);                
-            }
+            /* master_exponent[blk][reg], unpacked together */
+            if ((err = dolbyEFile.BitUnp_rj(cip->masterExp[blk], cip->regionCount[blk], 2))) return(err);
 
-            /* biased_exponent[blk][bnd] */            
-            for (bnd = 0; bnd < cip->bandCount[blk]; bnd++)
-            {
-                if ((err = dolbyEFile.BitUnp_rj(&value, 1, 5))) return(err);                
-            }
+            /* biased_exponent[blk][bnd], unpacked together */
+            if ((err = dolbyEFile.BitUnp_rj(cip->biasedExp[blk], cip->bandCount[blk], 5))) return(err);
         }
     }
 
@@ -2304,6 +2470,95 @@ int DolbyEParser::channel_subsegment(ChannelSubsegInfoStruct *cip)
 
 
 
+/*****************************************************************************
+*    capture_exponents: keep a channel subsegment's exponents for GetChannelExponents()
+*
+*    inputs:
+*        ch                    channel
+*        cip                    pointer to the parsed channel subsegment info
+*
+*    outputs:
+*        channelExponents[ch][cip->priExtFlag]
+*****************************************************************************/
+
+void DolbyEParser::capture_exponents(int ch, const ChannelSubsegInfoStruct *cip)
+{
+    ChannelExponentStruct *cep = &channelExponents[ch][cip->priExtFlag];
+    int blk, bnd;
+
+    cep->valid = 1;
+    cep->blockCount = cip->blockCount;
+    for (blk = 0; blk < cip->blockCount; blk++)
+    {
+        cep->bandCount[blk] = cip->bandCount[blk];
+        if (!cip->expStrategy[blk])
+        {
+            /* exponents reused from the block before, which has the same band count */
+            memcpy(cep->exponent[blk], cep->exponent[blk - 1], sizeof(cep->exponent[blk]));
+            continue;
+        }
+        /* the region boundaries are not tabulated here, so the bands are taken as split evenly between
+           the regions and the exponents are approximate where a region's master exponent is not 0 */
+        for (bnd = 0; bnd < cip->bandCount[blk]; bnd++)
+        {
+            cep->exponent[blk][bnd] = cip->biasedExp[blk][bnd] + 3 * cip->masterExp[blk][(bnd * cip->regionCount[blk]) / cip->bandCount[blk]];
+        }
+    }
+}
+
+/*****************************************************************************
+*    record_usage: keep a channel subsegment's coding choices and unused bits for GetChannelUsage()
+*
+*    inputs:
+*        ch                    channel
+*        cip                    pointer to the parsed channel subsegment info
+*        subsegBits            # bits in the subsegment
+*        unusedBits            # bits left in the subsegment after parsing
+*
+*    outputs:
+*        channelUsage[ch][cip->priExtFlag]
+*****************************************************************************/
+
+void DolbyEParser::record_usage(int ch, const ChannelSubsegInfoStruct *cip, int subsegBits, int unusedBits)
+{
+    ChannelUsageStruct *cup = &channelUsage[ch][cip->priExtFlag];
+
+    cup->valid = 1;
+    cup->groupTypeCode = cip->groupTypeCode;
+    cup->bandwidthCode = cip->bandwidthCode;
+    cup->subsegBits = subsegBits;
+    cup->unusedBits = unusedBits;
+}
+
+/*****************************************************************************
+*    check_crc: check the CRC of a segment, whose CRC word is about to be
+*    unpacked
+*
+*    inputs:
+*        fip                    pointer to frame info structure
+*        segment                CRC_ERR_ bit of the segment
+*        nWords                # words the CRC covers, the CRC word included
+*
+*    outputs:
+*        fip->crcErrors        segment set if the check fails
+*
+*    returns:
+*        error code, if the segment does not end on a word boundary or
+*        is not all in the buffer, which is a parse error, not a CRC failure
+*****************************************************************************/
+
+int DolbyEParser::check_crc(FrameInfoStruct *fip, int segment, int nWords)
+{
+    int err, remainder;
+
+    if ((err = dolbyEFile.CrcRemainder(nWords, &remainder))) return(err);
+    if (remainder != 0)
+    {
+        fip->crcErrors |= segment;
+    }
+    return(0);
+}
+
 /********************************************************************
  * Helpers *
 ********************************************************************/
@@ -2442,6 +2697,17 @@ static int init_channel_subseg_info(ChannelSubsegInfoStruct *cip)
     return(0);
 }
 
+static int subsegment_words(const FrameInfoStruct *fip, int firstChan, int endChan)
+{
+    int ch, words = 0;
+
+    for (ch = firstChan; ch < endChan; ch++)
+    {
+        words += fip->chanSubsegSz[ch];
+    }
+    return(words);
+}
+
 static double GetComprDB(int value)
 {
     int mant, exp;
@@ -2510,3 +2776,16 @@ static int check_time_code(int *current_tc, int *last_tc, int frame_rate)
 
     return 0;
 }
+
+bool DolbyEParser::TimeCodeFollows(const int timecode[8], const int previous[8], int frameRate)
+{
+    if ((frameRate >= 1) && (frameRate <= NUMFRAMERATES))
+    {
+        return(check_time_code((int *)timecode, (int *)previous, frameRate) == 0);
+    }
+
+    /* high frame rates are beyond check_time_code()'s tables, so compare as frames since midnight */
+    int32_t current = TimecodeIndex::TimecodeFrames(timecode, frameRate);
+    int32_t last = TimecodeIndex::TimecodeFrames(previous, frameRate);
+    return((current < 0) || (last < 0) || (current == last + 1) || (current == 0));
+}
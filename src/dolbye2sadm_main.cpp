@@ -1,104 +1,839 @@
-/****************************************************************************
- *
- *
- * Copyright (c) 2024 Dolby International AB.
- * All rights reserved.
-
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions are
- * met:
- *
- * 1. Redistributions of source code must retain the above copyright
- *    notice, this list of conditions and the following disclaimer.
- *
- * 2. Redistributions in binary form must reproduce the above copyright
- *    notice, this list of conditions and the following disclaimer in
- *    the documentation and/or other materials provided with the
- *    distribution.
- *
- * 3. Neither the name of the copyright holder nor the names of its
- *    contributors may be used to endorse or promote products derived
- *    from this software without specific prior written permission.
- *
- * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
- * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
- * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
- * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
- * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
- * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
- * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
- * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
- * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
- * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
- * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
- * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
- *
- ******************************************************************************/
-
-#include <iostream>
-#include <fstream>
-#include <stdexcept>
-#include <string>
-
-#include "dolbye_parser.h"
-
-void show_usage(void)
-{
-    std::cout << std::endl << "Usage: dolbye2sadm infile.dde [outfile.xml]" << std::endl;
-    exit(2);
-}
-
-int main(int argc, char *argv[])
-{
-    std::ofstream outputXmlFile;
-    char *inputFileName;
-    char *outputFileName;
-
-// Print banner
-    std::cout << std::endl << "Dolby E to S-ADM Conversion tool " << REV_STR << std::endl;
-    std::cout << "(C) Copyright 2025 Dolby Laboratories, Inc.  All rights reserved." << std::endl;
-
-// Parse command line arguments
-    if ((argc == 1) || (argc > 3))
-    {
-        show_usage();
-    }
-
-    inputFileName = argv[1];
-
-    if (argc == 3)
-    {
-        outputFileName = argv[2];
-    }
-    else
-    {
-        outputFileName = nullptr;
-    }
-
-// Open file to write XML
-    if (outputFileName)
-    {
-        outputXmlFile.open(outputFileName);
-        if (!outputXmlFile.is_open())
-        {
-            throw std::runtime_error("Error: Unable to open file to write xml data");
-            exit(1);
-        }
-    }
-
-    DolbyEParser parser(inputFileName);
-    std::string s;
-
-    parser.GetNextFrame();
-    parser.GenerateSadmXML(s);
-    if (outputXmlFile.is_open())
-    {
-        outputXmlFile << s;
-        outputXmlFile.close();
-    }
-    else
-    {
-        std::cout << s;
-    }
-    return 0;
-}
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "dolbye_parser.h"
+#include "sadm_sink.h"
+#include "sadm_template.h"
+#include "realtime_stats.h"
+#include "continuity_scan.h"
+#include "metadata_changes.h"
+#include "meter_stats.h"
+#include "exponent_activity.h"
+#include "coding_stats.h"
+#ifndef _WIN32
+#include "shm_ring.h"
+#include "sadm_shm_sink.h"
+#include "follow_reader.h"
+#endif
+
+#define REALTIME_READ_SZ	(16 * 1024)		/* bytes read per Feed(), well under a frame so frames are parsed as they arrive */
+#define CHANGES_READ_SZ		(1024 * 1024)	/* bytes read per Feed() when logging metadata changes */
+#define RING_POLL_MS		200				/* longest wait for ring or followed file data before checking for signals */
+
+enum RealtimeInput
+{
+    RT_INPUT_STREAM,			/* file, FIFO or stdin, to end of file */
+    RT_INPUT_RING,				/* shared memory ring, until the writer closes it */
+    RT_INPUT_FOLLOW				/* file still being written, until interrupted */
+};
+
+static volatile sig_atomic_t dumpStatsRequested = 0;
+static volatile sig_atomic_t stopRequested = 0;
+
+#ifndef _WIN32
+static void on_dump_signal(int sig)
+{
+    (void)sig;
+    dumpStatsRequested = 1;
+}
+
+static void on_stop_signal(int sig)
+{
+    (void)sig;
+    stopRequested = 1;
+}
+#endif
+
+// Frames checked, segments that failed and what became of the failed frames
+static void print_crc_stats(DolbyEParser &parser, std::ostream &os)
+{
+    const DolbyECrcStats &crcStats = parser.GetCrcStats();
+    os << "CRC: " << crcStats.frames << " frames checked, " << crcStats.failedFrames << " failed";
+    for (int bit = 0 ; bit < CRC_NSEGMENTS ; bit++)
+    {
+        if (crcStats.segmentFailures[bit] > 0)
+        {
+            os << ", " << DolbyEParser::CrcSegmentName(bit) << " " << crcStats.segmentFailures[bit];
+        }
+    }
+    os << ", " << crcStats.dropped << " dropped, " << crcStats.held << " held";
+    if (crcStats.retracted > 0)
+    {
+        os << ", " << crcStats.retracted << " retracted";
+    }
+    os << std::endl;
+}
+
+// Frames held in place of damaged and missing ones, and the longest run of them
+static void print_resilience_stats(DolbyEParser &parser, std::ostream &os)
+{
+    const DolbyEResilienceStats &resilienceStats = parser.GetResilienceStats();
+    os << "Resilience: " << resilienceStats.held << " frames held, " << resilienceStats.parseErrors << " parse errors, "
+       << resilienceStats.missingFrames << " missing, " << resilienceStats.outages << " outages, longest "
+       << resilienceStats.longestOutage << " frames (" << resilienceStats.longestOutageNs / 1000000 << " ms)" << std::endl;
+}
+
+// Convert every frame of a live input as it arrives, keeping stage latency histograms
+static void run_realtime(const char *inputFileName, RealtimeInput input, DolbyEParser &parser, SadmSink &sink)
+{
+    RealtimeStats stats;
+    unsigned char buf[REALTIME_READ_SZ];
+    bool useStdin = !strcmp(inputFileName, "-");
+
+    parser.SetSadmSink(&sink);
+    parser.SetRealtimeStats(&stats);
+
+#ifndef _WIN32
+    // No SA_RESTART, so a blocked read() returns and the histograms are dumped straight away
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_dump_signal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGUSR1, &sa, NULL);
+
+    // Inputs without an end stop cleanly, with the histograms printed, when interrupted
+    if (input != RT_INPUT_STREAM)
+    {
+        sa.sa_handler = on_stop_signal;
+        sigaction(SIGINT, &sa, NULL);
+        sigaction(SIGTERM, &sa, NULL);
+    }
+
+    if (input == RT_INPUT_FOLLOW)
+    {
+        FollowReader reader(inputFileName);
+        while (!stopRequested)
+        {
+            bool restarted;
+            size_t n = reader.Read(buf, sizeof(buf), RING_POLL_MS, restarted);
+            if (restarted)
+            {
+                // A partial frame at the end of the old file will never be completed
+                parser.ResetFeed();
+            }
+            if (n > 0)
+            {
+                parser.Feed(buf, n);
+            }
+            if (dumpStatsRequested)
+            {
+                dumpStatsRequested = 0;
+                stats.Print(std::cerr);
+            }
+        }
+        sink.Flush();
+        stats.Print(std::cerr);
+        return;
+    }
+
+    if (input == RT_INPUT_RING)
+    {
+        // Frames are parsed where they lie in the ring, partial ones are left there until the rest arrives
+        ShmRing ring(inputFileName);
+        if (ring.Capacity() < FRAME_MAX_BYTES)
+        {
+            throw std::runtime_error("Error: Ring " + std::string(inputFileName) + " of " + std::to_string(ring.Capacity()) +
+                                     " bytes cannot hold a Dolby E frame of up to " + std::to_string(FRAME_MAX_BYTES) + " bytes");
+        }
+        size_t left = 0;
+        while (!stopRequested)
+        {
+            size_t len, consumed;
+            uint8_t *data = ring.Peek(left + 1, len, RING_POLL_MS);
+            if (data != NULL)
+            {
+                parser.ParseInPlace(data, len, consumed);
+                ring.Release(consumed);
+                left = len - consumed;
+            }
+            else if (ring.Closed())
+            {
+                break;
+            }
+            if (dumpStatsRequested)
+            {
+                dumpStatsRequested = 0;
+                stats.Print(std::cerr);
+            }
+        }
+        sink.Flush();
+        stats.Print(std::cerr);
+        return;
+    }
+
+    int fd = useStdin ? STDIN_FILENO : open(inputFileName, O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Error: Unable to open input file");
+    }
+    while (1)
+    {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n < 0 && errno != EINTR)
+        {
+            throw std::runtime_error("Error: Unable to read input file");
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        if (n > 0)
+        {
+            parser.Feed(buf, (size_t)n);
+        }
+        if (dumpStatsRequested)
+        {
+            dumpStatsRequested = 0;
+            stats.Print(std::cerr);
+        }
+    }
+    if (!useStdin)
+    {
+        close(fd);
+    }
+#else
+    FILE *fp = useStdin ? stdin : fopen(inputFileName, "rb");
+    if (fp == NULL)
+    {
+        throw std::runtime_error("Error: Unable to open input file");
+    }
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+    {
+        parser.Feed(buf, n);
+    }
+    if (!useStdin)
+    {
+        fclose(fp);
+    }
+#endif
+    sink.Flush();
+    stats.Print(std::cerr);
+}
+
+// Feed infile to parser in CHANGES_READ_SZ reads, onFrame being called with each frame parsed
+static void feed_file(const char *inputFileName, DolbyEParser &parser, DolbyEFrameCallback onFrame)
+{
+    std::vector<unsigned char> buf(CHANGES_READ_SZ);
+
+    FILE *fp = fopen(inputFileName, "rb");
+    if (!fp)
+    {
+        throw std::runtime_error("Error: File not found");
+    }
+    parser.SetFrameCallback(onFrame);
+    size_t len;
+    while ((len = fread(buf.data(), 1, buf.size(), fp)) > 0)
+    {
+        parser.Feed(buf.data(), len);
+    }
+    fclose(fp);
+}
+
+// Channel names of the widest program configuration seen, to label per channel statistics
+class ChannelLabels
+{
+    int progConfig = -1;
+    int nChans = 0;
+    const char *names[MAX_NCHANS];
+
+public:
+    void Add(const FrameInfoStruct &frameInfo)
+    {
+        if (frameInfo.nChans > nChans)
+        {
+            progConfig = frameInfo.progConfig;
+            nChans = frameInfo.nChans;
+        }
+    }
+
+    const char *const *Names(DolbyEParser &parser)
+    {
+        for (int ch = 0 ; ch < MAX_NCHANS ; ch++)
+        {
+            names[ch] = parser.GetChannelName(progConfig, ch);
+        }
+        return(names);
+    }
+};
+
+// Log each metadata change through infile, parsing only the sync and metadata segments of each frame
+static void run_changes(const char *inputFileName, const char *jsonFileName, const char *binaryFileName)
+{
+    std::ofstream jsonFile, binaryFile;
+    DolbyEParser parser;
+    uint32_t frameNo = 0;
+
+    if (jsonFileName)
+    {
+        jsonFile.open(jsonFileName);
+        if (!jsonFile)
+        {
+            throw std::runtime_error(std::string("Error: Unable to open ") + jsonFileName);
+        }
+    }
+    if (binaryFileName)
+    {
+        binaryFile.open(binaryFileName, std::ios::binary);
+        if (!binaryFile)
+        {
+            throw std::runtime_error(std::string("Error: Unable to open ") + binaryFileName);
+        }
+    }
+    MetadataChangeLog log(jsonFileName ? &jsonFile : nullptr, binaryFileName ? &binaryFile : nullptr);
+
+    parser.SetMetadataOnly(true);
+    feed_file(inputFileName, parser, [&](const FrameInfoStruct &frameInfo)
+    {
+        const char *text[MAX_NPGRMS];
+        for (int p = 0 ; p < MAX_NPGRMS ; p++)
+        {
+            text[p] = parser.GetProgrammeDescription(p);
+        }
+        log.Frame(frameNo++, frameInfo, text);
+    });
+    std::cout << frameNo << " frames, " << log.EventCount() << " metadata changes" << std::endl;
+}
+
+// Meter statistics of infile, parsing whole frames as the meter segment follows the audio
+static void run_meters(const char *inputFileName, double silenceDb, const char *rollup)
+{
+    MeterAnalyzer analyzer(silenceDb);
+    DolbyEParser parser;
+    ChannelLabels labels;
+
+    feed_file(inputFileName, parser, [&](const FrameInfoStruct &frameInfo)
+    {
+        labels.Add(frameInfo);
+        analyzer.Add(frameInfo);
+    });
+    analyzer.Finish();
+
+    std::cout << analyzer.FrameCount() << " frames" << std::endl;
+    analyzer.Print(std::cout, labels.Names(parser),
+                   !rollup ? nullptr : (!strcmp(rollup, "minute") ? &analyzer.Minutes() : &analyzer.Seconds()));
+}
+
+// Channel activity of infile from the exponents in its channel subsegments
+static void run_activity(const char *inputFileName)
+{
+    ExponentAnalyzer analyzer;
+    DolbyEParser parser;
+    ChannelLabels labels;
+
+    parser.SetExponentCapture(true);
+    feed_file(inputFileName, parser, [&](const FrameInfoStruct &frameInfo)
+    {
+        labels.Add(frameInfo);
+        analyzer.Add(parser, frameInfo);
+    });
+
+    std::cout << analyzer.FrameCount() << " frames" << std::endl;
+    analyzer.Print(std::cout, labels.Names(parser));
+}
+
+// Group types, bandwidth codes and unused bits of infile's channel subsegments
+static void run_coding(const char *inputFileName)
+{
+    CodingStats stats;
+    DolbyEParser parser;
+    ChannelLabels labels;
+
+    feed_file(inputFileName, parser, [&](const FrameInfoStruct &frameInfo)
+    {
+        labels.Add(frameInfo);
+        stats.Add(parser, frameInfo);
+    });
+
+    std::cout << stats.FrameCount() << " frames" << std::endl;
+    stats.Print(std::cout, labels.Names(parser));
+}
+
+void show_usage(void)
+{
+    std::cout << std::endl << "Usage: dolbye2sadm [options] infile.dde [outfile.xml]" << std::endl;
+    std::cout << "       dolbye2sadm --probe [--json] infile.dde..." << std::endl;
+    std::cout << "    --mmap             write the output file through a preallocated memory mapping" << std::endl;
+    std::cout << "    --flowid-ns uuid   derive flowID from namespace uuid and the input's first frame instead of at random" << std::endl;
+    std::cout << "    --template         fill the built-in templates where one matches the program configuration" << std::endl;
+    std::cout << "    --template-dir dir as --template, with templates in dir replacing built-in ones of the same name" << std::endl;
+    std::cout << "    --from pos         convert from frame pos (a frame number from 0, or a time code hh:mm:ss:ff) rather than" << std::endl;
+    std::cout << "                       only the first frame, to the end or to --to" << std::endl;
+    std::cout << "    --to pos           convert up to and including frame pos, from the start or from --from" << std::endl;
+    std::cout << "    --scan             check frame_count, time code and frame spacing across infile, reporting each" << std::endl;
+    std::cout << "                       discontinuity, without converting" << std::endl;
+    std::cout << "    --threads n        with --scan, threads scanning parts of the file (default one per CPU)" << std::endl;
+    std::cout << "    --changes file     log each metadata change through infile to file as JSON Lines, without converting" << std::endl;
+    std::cout << "    --changes-bin file as --changes, in the compact binary form described in metadata_changes.h" << std::endl;
+    std::cout << "    --meters           peak and RMS meter statistics of infile per channel, with silence and clipping, without" << std::endl;
+    std::cout << "                       converting" << std::endl;
+    std::cout << "    --silence dB       with --meters, the peak level at or below which a channel is silent (default -70)" << std::endl;
+    std::cout << "    --rollup period    with --meters, also print the levels each second or minute" << std::endl;
+    std::cout << "    --activity         estimate each channel's level and bandwidth from the exponents in infile, reporting silent" << std::endl;
+    std::cout << "                       channels, a silent LFE and identical channels, without converting" << std::endl;
+    std::cout << "    --coding           histograms of group types, bandwidth codes and unused bits per channel and programme" << std::endl;
+    std::cout << "                       of infile, without converting" << std::endl;
+    std::cout << "    --crc policy       check the CRC of every segment, writing a frame that fails with a comment naming the" << std::endl;
+    std::cout << "                       segments (flag), not at all (drop) or as the last intact frame (hold)" << std::endl;
+    std::cout << "    --resilient        keep converting through damaged and missing frames, writing the last intact frame in" << std::endl;
+    std::cout << "                       their place with a comment saying why; implies --crc hold unless --crc is given" << std::endl;
+    std::cout << "    --probe            summarise each file from its first frame, without converting; the cost does not depend" << std::endl;
+    std::cout << "                       on the file's size" << std::endl;
+    std::cout << "    --json             with --probe, one JSON object per line" << std::endl;
+    std::cout << "    --realtime         convert every frame as it arrives from infile (- for stdin), reporting stage latencies" << std::endl;
+    std::cout << "                       on stderr at the end and on SIGUSR1" << std::endl;
+#ifndef _WIN32
+    std::cout << "    --shm              with --realtime, infile names a shared memory ring written by a capture process" << std::endl;
+    std::cout << "    --follow           with --realtime, keep reading infile as it is written, following truncation and" << std::endl;
+    std::cout << "                       rotation, until interrupted" << std::endl;
+    std::cout << "    --shm-out name     write each frame to shared memory ring name instead of outfile, for an embedder" << std::endl;
+    std::cout << "    --shm-overwrite    with --shm-out, overwrite the oldest frames rather than wait for the embedder" << std::endl;
+#endif
+    exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+    char *inputFileName = nullptr;
+    char *outputFileName = nullptr;
+    char *flowIdNamespace = nullptr;
+    char *templateDir = nullptr;
+    bool useMmap = false;
+    bool useTemplates = false;
+    bool realtime = false;
+    bool fromRing = false;
+    bool follow = false;
+    char *ringOutName = nullptr;
+    bool ringOverwrite = false;
+    bool probe = false;
+    bool json = false;
+    char *fromPos = nullptr;
+    bool scan = false;
+    unsigned int scanThreads = std::max(1u, std::thread::hardware_concurrency());
+    char *toPos = nullptr;
+    char *changesFile = nullptr;
+    char *changesBinFile = nullptr;
+    bool meters = false;
+    bool activity = false;
+    bool coding = false;
+    double silenceDb = METER_SILENCE_DB;
+    char *rollup = nullptr;
+    CrcPolicy crcPolicy = CRC_IGNORE;
+    bool crcGiven = false;
+    bool resilient = false;
+    std::vector<char *> files;
+    std::unique_ptr<SadmSink> sink;
+
+// Parse command line arguments
+    for (int arg = 1 ; arg < argc ; arg++)
+    {
+        if (!strcmp(argv[arg], "--mmap"))
+        {
+            useMmap = true;
+        }
+        else if (!strcmp(argv[arg], "--flowid-ns") && (arg + 1 < argc))
+        {
+            flowIdNamespace = argv[++arg];
+        }
+        else if (!strcmp(argv[arg], "--template"))
+        {
+            useTemplates = true;
+        }
+        else if (!strcmp(argv[arg], "--template-dir") && (arg + 1 < argc))
+        {
+            useTemplates = true;
+            templateDir = argv[++arg];
+        }
+        else if (!strcmp(argv[arg], "--from") && (arg + 1 < argc))
+        {
+            fromPos = argv[++arg];
+        }
+        else if (!strcmp(argv[arg], "--to") && (arg + 1 < argc))
+        {
+            toPos = argv[++arg];
+        }
+        else if (!strcmp(argv[arg], "--scan"))
+        {
+            scan = true;
+        }
+        else if (!strcmp(argv[arg], "--threads") && (arg + 1 < argc))
+        {
+            scanThreads = (unsigned int)atoi(argv[++arg]);
+        }
+        else if (!strcmp(argv[arg], "--changes") && (arg + 1 < argc))
+        {
+            changesFile = argv[++arg];
+        }
+        else if (!strcmp(argv[arg], "--changes-bin") && (arg + 1 < argc))
+        {
+            changesBinFile = argv[++arg];
+        }
+        else if (!strcmp(argv[arg], "--meters"))
+        {
+            meters = true;
+        }
+        else if (!strcmp(argv[arg], "--coding"))
+        {
+            coding = true;
+        }
+        else if (!strcmp(argv[arg], "--activity"))
+        {
+            activity = true;
+        }
+        else if (!strcmp(argv[arg], "--silence") && (arg + 1 < argc))
+        {
+            silenceDb = atof(argv[++arg]);
+        }
+        else if (!strcmp(argv[arg], "--rollup") && (arg + 1 < argc))
+        {
+            rollup = argv[++arg];
+            if (strcmp(rollup, "second") && strcmp(rollup, "minute"))
+            {
+                show_usage();
+            }
+        }
+        else if (!strcmp(argv[arg], "--crc") && (arg + 1 < argc))
+        {
+            crcGiven = true;
+            arg++;
+            if (!strcmp(argv[arg], "flag"))
+            {
+                crcPolicy = CRC_FLAG;
+            }
+            else if (!strcmp(argv[arg], "drop"))
+            {
+                crcPolicy = CRC_DROP;
+            }
+            else if (!strcmp(argv[arg], "hold"))
+            {
+                crcPolicy = CRC_HOLD;
+            }
+            else
+            {
+                show_usage();
+            }
+        }
+        else if (!strcmp(argv[arg], "--resilient"))
+        {
+            resilient = true;
+        }
+        else if (!strcmp(argv[arg], "--probe"))
+        {
+            probe = true;
+        }
+        else if (!strcmp(argv[arg], "--json"))
+        {
+            json = true;
+        }
+        else if (!strcmp(argv[arg], "--realtime"))
+        {
+            realtime = true;
+        }
+#ifndef _WIN32
+        else if (!strcmp(argv[arg], "--shm"))
+        {
+            fromRing = true;
+        }
+        else if (!strcmp(argv[arg], "--follow"))
+        {
+            follow = true;
+        }
+        else if (!strcmp(argv[arg], "--shm-out") && (arg + 1 < argc))
+        {
+            ringOutName = argv[++arg];
+        }
+        else if (!strcmp(argv[arg], "--shm-overwrite"))
+        {
+            ringOverwrite = true;
+        }
+#endif
+        else if (argv[arg][0] == '-' && argv[arg][1] == '-')
+        {
+            show_usage();
+        }
+        else
+        {
+            files.push_back(argv[arg]);
+        }
+    }
+
+// Probe output is for other programs to read, so goes without the banner
+    if (probe)
+    {
+        if (files.empty())
+        {
+            show_usage();
+        }
+        int status = 0;
+        for (const char *file : files)
+        {
+            try
+            {
+                DolbyEProbe summary = DolbyEParser::Probe(file);
+                std::cout << (json ? DolbyEProbeJson(summary) : DolbyEProbeText(summary)) << std::endl;
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << file << ": " << e.what() << std::endl;
+                status = 1;
+            }
+        }
+        return status;
+    }
+
+    inputFileName = files.empty() ? nullptr : files[0];
+    outputFileName = (files.size() > 1) ? files[1] : nullptr;
+
+// Print banner, on stderr if the S-ADM is to go to stdout
+    std::ostream &banner = outputFileName ? std::cout : std::cerr;
+    banner << std::endl << "Dolby E to S-ADM Conversion tool " << REV_STR << std::endl;
+    banner << "(C) Copyright 2025 Dolby Laboratories, Inc.  All rights reserved." << std::endl;
+
+    if (files.size() > 2 || json)
+    {
+        show_usage();
+    }
+
+    if (scan)
+    {
+        if (!inputFileName || outputFileName || scanThreads == 0)
+        {
+            show_usage();
+        }
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        ContinuityScanner scanner(inputFileName, scanThreads);
+        scanner.Scan();
+        scanner.Print(std::cout);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Scanned " << scanner.FrameCount() << " frames in " << seconds << " s with " << scanThreads << " threads, "
+                  << scanner.Events().size() << " discontinuities" << std::endl;
+        return scanner.Events().empty() ? 0 : 1;
+    }
+
+    if (changesFile || changesBinFile)
+    {
+        if (!inputFileName || outputFileName || scan)
+        {
+            show_usage();
+        }
+        run_changes(inputFileName, changesFile, changesBinFile);
+        return 0;
+    }
+
+    if (coding)
+    {
+        if (!inputFileName || outputFileName || scan || changesFile || changesBinFile || meters || activity)
+        {
+            show_usage();
+        }
+        run_coding(inputFileName);
+        return 0;
+    }
+
+    if (activity)
+    {
+        if (!inputFileName || outputFileName || scan || changesFile || changesBinFile || meters)
+        {
+            show_usage();
+        }
+        run_activity(inputFileName);
+        return 0;
+    }
+
+    if (meters)
+    {
+        if (!inputFileName || outputFileName || scan || changesFile || changesBinFile)
+        {
+            show_usage();
+        }
+        run_meters(inputFileName, silenceDb, rollup);
+        return 0;
+    }
+
+    // Damaged frames are found by their CRCs as well as by failing to parse
+    if (resilient && !crcGiven)
+    {
+        crcPolicy = CRC_HOLD;
+    }
+
+    if (!inputFileName || (useMmap && !outputFileName) || ((fromRing || follow) && !realtime) || (fromRing && follow) || (ringOutName && outputFileName) || ((fromPos || toPos) && realtime))
+    {
+        show_usage();
+    }
+
+// Open sink to write XML
+#ifndef _WIN32
+    if (ringOutName)
+    {
+        sink.reset(new ShmFrameSink(ringOutName, SHM_RING_DEFAULT_SZ, ringOverwrite));
+    }
+    else if (outputFileName && useMmap)
+    {
+        sink.reset(new MmapFileSink(outputFileName));
+    }
+    else if (outputFileName)
+    {
+        int fd = open(outputFileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            throw std::runtime_error("Error: Unable to open file to write xml data");
+        }
+        sink.reset(new FdSink(fd, true));
+    }
+    else
+    {
+        sink.reset(new FdSink(STDOUT_FILENO));
+    }
+#else
+    std::ofstream outputXmlFile;
+    if (outputFileName)
+    {
+        outputXmlFile.open(outputFileName, std::ios::binary);
+        if (!outputXmlFile.is_open())
+        {
+            throw std::runtime_error("Error: Unable to open file to write xml data");
+        }
+    }
+    std::ostream &out = outputXmlFile.is_open() ? (std::ostream &)outputXmlFile : std::cout;
+    sink.reset(new CallbackSink([&out](const unsigned char *data, size_t len) { out.write((const char *)data, len); }));
+#endif
+
+    // Templates are all loaded up front so there is no file access per conversion
+    std::unique_ptr<SadmTemplateSet> templates;
+    if (useTemplates)
+    {
+        templates.reset(new SadmTemplateSet());
+        if (templateDir)
+        {
+            templates->LoadDirectory(templateDir);
+        }
+    }
+
+    if (realtime)
+    {
+        DolbyEParser parser;
+        parser.SetTemplates(templates.get());
+        parser.SetCrcPolicy(crcPolicy);
+        parser.SetResilient(resilient);
+        if (flowIdNamespace)
+        {
+            parser.SetDeterministicFlowID(flowIdNamespace);
+        }
+        run_realtime(inputFileName, fromRing ? RT_INPUT_RING : follow ? RT_INPUT_FOLLOW : RT_INPUT_STREAM, parser, *sink);
+        if (crcPolicy != CRC_IGNORE)
+        {
+            print_crc_stats(parser, std::cerr);
+        }
+        if (resilient)
+        {
+            print_resilience_stats(parser, std::cerr);
+        }
+        return 0;
+    }
+
+    DolbyEParser parser(inputFileName);
+    parser.SetTemplates(templates.get());
+    parser.SetCrcPolicy(crcPolicy);
+    parser.SetResilient(resilient);
+
+    if (flowIdNamespace)
+    {
+        // From the file's first frame, parsed for its description text, whatever range is converted
+        parser.SetDeterministicFlowID(flowIdNamespace);
+    }
+
+    // A range is found in the time code index and seeked to directly
+    uint32_t first = 0;
+    uint32_t last = 0;
+    const TimecodeIndex &index = parser.GetTimecodeIndex();
+    if (fromPos && !index.FindPosition(fromPos, first))
+    {
+        throw std::runtime_error(std::string("Error: ") + fromPos + " is not in the input file");
+    }
+    if (toPos && !index.FindPosition(toPos, last))
+    {
+        throw std::runtime_error(std::string("Error: ") + toPos + " is not in the input file");
+    }
+    if (fromPos && !toPos)
+    {
+        last = parser.GetFrameCount() - 1;
+    }
+    else if (!fromPos && !toPos)
+    {
+        last = first;
+    }
+    if (last < first)
+    {
+        throw std::runtime_error("Error: --to is before --from in the input file");
+    }
+
+    parser.SeekFrame(first);
+    for (uint32_t frame = first ; frame <= last ; frame++)
+    {
+        parser.GetNextFrame();
+        parser.GenerateSadmXML(*sink);
+    }
+    sink->Flush();
+    if (crcPolicy != CRC_IGNORE)
+    {
+        print_crc_stats(parser, std::cerr);
+    }
+    if (resilient)
+    {
+        print_resilience_stats(parser, std::cerr);
+    }
+    return 0;
+}
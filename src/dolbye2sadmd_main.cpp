@@ -0,0 +1,182 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include "ddeinfo.h"
+#include "sadm_daemon.h"
+#include "sadm_template.h"
+
+#define DEFAULT_SOCKET		"/tmp/dolbye2sadm.sock"
+#define DEFAULT_QUEUE_DEPTH	64
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    stopRequested = 1;
+}
+
+void show_usage(void)
+{
+    std::cout << std::endl << "Usage: dolbye2sadmd [options]" << std::endl;
+    std::cout << "    --socket path      UNIX domain socket to listen on (default " << DEFAULT_SOCKET << ")" << std::endl;
+    std::cout << "    --threads n        worker threads (default one per CPU)" << std::endl;
+    std::cout << "    --queue n          requests queued before clients are held back (default " << DEFAULT_QUEUE_DEPTH << ")" << std::endl;
+    std::cout << "    --template         fill the built-in templates where one matches the program configuration" << std::endl;
+    std::cout << "    --template-dir dir as --template, with templates in dir replacing built-in ones of the same name" << std::endl;
+    std::cout << "    --watch dir        convert .dde files arriving in dir to dir/name.xml, may be repeated" << std::endl;
+    std::cout << "    --out-dir dir      write the last --watch folder's outputs to dir instead" << std::endl;
+    std::cout << "    --max-active n     conversions the last --watch folder may have running at once (default --threads)" << std::endl;
+    std::cout << "    --settle ms        time a file's size must stay the same before it is converted (default " << HOT_FOLDER_SETTLE_MS << ")" << std::endl;
+    std::cout << "    --no-close-write   only use --settle to tell a file is complete, not its writer closing it" << std::endl;
+    std::cout << "    --status file      write hot folder throughput to file as JSON every second" << std::endl;
+    exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *socketPath = DEFAULT_SOCKET;
+    const char *templateDir = nullptr;
+    unsigned int nThreads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int queueDepth = DEFAULT_QUEUE_DEPTH;
+    bool useTemplates = false;
+    struct WatchArg { std::string dir, outDir; unsigned int maxActive; };
+    std::vector<WatchArg> watches;
+    unsigned int settleMs = HOT_FOLDER_SETTLE_MS;
+    bool closeWrite = true;
+    std::string statusFile;
+
+// Print banner
+    std::cout << std::endl << "Dolby E to S-ADM Conversion daemon " << REV_STR << std::endl;
+    std::cout << "(C) Copyright 2025 Dolby Laboratories, Inc.  All rights reserved." << std::endl;
+
+// Parse command line arguments
+    for (int arg = 1 ; arg < argc ; arg++)
+    {
+        if (!strcmp(argv[arg], "--socket") && (arg + 1 < argc))
+        {
+            socketPath = argv[++arg];
+        }
+        else if (!strcmp(argv[arg], "--threads") && (arg + 1 < argc))
+        {
+            nThreads = (unsigned int)atoi(argv[++arg]);
+        }
+        else if (!strcmp(argv[arg], "--queue") && (arg + 1 < argc))
+        {
+            queueDepth = (unsigned int)atoi(argv[++arg]);
+        }
+        else if (!strcmp(argv[arg], "--template"))
+        {
+            useTemplates = true;
+        }
+        else if (!strcmp(argv[arg], "--template-dir") && (arg + 1 < argc))
+        {
+            useTemplates = true;
+            templateDir = argv[++arg];
+        }
+        else if (!strcmp(argv[arg], "--watch") && (arg + 1 < argc))
+        {
+            watches.push_back({ argv[++arg], "", 0 });
+        }
+        else if (!strcmp(argv[arg], "--out-dir") && (arg + 1 < argc) && !watches.empty())
+        {
+            watches.back().outDir = argv[++arg];
+        }
+        else if (!strcmp(argv[arg], "--max-active") && (arg + 1 < argc) && !watches.empty())
+        {
+            watches.back().maxActive = (unsigned int)atoi(argv[++arg]);
+        }
+        else if (!strcmp(argv[arg], "--settle") && (arg + 1 < argc))
+        {
+            settleMs = (unsigned int)atoi(argv[++arg]);
+        }
+        else if (!strcmp(argv[arg], "--no-close-write"))
+        {
+            closeWrite = false;
+        }
+        else if (!strcmp(argv[arg], "--status") && (arg + 1 < argc))
+        {
+            statusFile = argv[++arg];
+        }
+        else
+        {
+            show_usage();
+        }
+    }
+    if (nThreads == 0 || queueDepth == 0)
+    {
+        show_usage();
+    }
+
+    std::unique_ptr<SadmTemplateSet> templates;
+    if (useTemplates)
+    {
+        templates.reset(new SadmTemplateSet());
+        if (templateDir)
+        {
+            templates->LoadDirectory(templateDir);
+        }
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    SadmDaemon daemon(socketPath, nThreads, queueDepth, templates.get());
+    std::cout << "Listening on " << socketPath << " with " << nThreads << " worker threads" << std::endl;
+    if (!watches.empty())
+    {
+        HotFolder &hotFolder = daemon.WatchFolders(settleMs, closeWrite, statusFile);
+        for (const WatchArg &watch : watches)
+        {
+            hotFolder.AddFolder(watch.dir, watch.outDir, watch.maxActive ? watch.maxActive : nThreads);
+            std::cout << "Watching " << watch.dir << std::endl;
+        }
+    }
+    daemon.Run(stopRequested);
+    return 0;
+}
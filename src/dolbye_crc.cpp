@@ -0,0 +1,292 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include "dolbye_crc.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define DOLBYE_CRC_CLMUL
+#include <immintrin.h>
+#endif
+
+/*	Both forms work on a 64 bit chunk u: as many whole words as fit, with the CRC so far added in at the top.
+	The CRC after the chunk is then u * x^16 mod P, where P is the generator */
+
+#define CRC_CHUNK_WORDS(wordSz)		(64 / (wordSz))
+
+/* Slice-by-8 tables: crcTab[j][b] = b * x^(16 + 8j) mod P, so that u * x^16 mod P is the XOR of one lookup per byte of u */
+struct CrcTables
+{
+	uint16_t crcTab[8][256];
+
+	CrcTables(void)
+	{
+		for (unsigned int b = 0; b < 256; b++)
+		{
+			unsigned int crc = b << 8;
+			for (int bit = 0; bit < 8; bit++)
+			{
+				crc = (crc & 0x8000) ? ((crc << 1) ^ DOLBYE_CRC_POLY) : (crc << 1);
+			}
+			crcTab[0][b] = (uint16_t)crc;
+		}
+		for (int j = 1; j < 8; j++)
+		{
+			for (unsigned int b = 0; b < 256; b++)
+			{
+				unsigned int prev = crcTab[j - 1][b];
+				crcTab[j][b] = (uint16_t)((prev << 8) ^ crcTab[0][prev >> 8]);
+			}
+		}
+	}
+};
+
+static const CrcTables crcTables;
+
+// Pack up to CRC_CHUNK_WORDS(wordSz) words into the low bits of a chunk, first word most significant
+template <int wordSz>
+static inline uint64_t PackWords(const int32_t *words, int nWords)
+{
+	uint64_t u = 0;
+
+	for (int j = 0; j < nWords; j++)
+	{
+		u = (u << wordSz) | ((uint32_t)words[j] >> (32 - wordSz));
+	}
+	return(u);
+}
+
+static inline unsigned int TableChunk(uint64_t u)
+{
+	const uint16_t (*t)[256] = crcTables.crcTab;
+
+	return(t[7][u >> 56] ^ t[6][(u >> 48) & 0xff] ^ t[5][(u >> 40) & 0xff] ^ t[4][(u >> 32) & 0xff] ^
+	       t[3][(u >> 24) & 0xff] ^ t[2][(u >> 16) & 0xff] ^ t[1][(u >> 8) & 0xff] ^ t[0][u & 0xff]);
+}
+
+template <int wordSz>
+static unsigned int TableWords(const int32_t *words, int nWords, unsigned int crc)
+{
+	const int chunkWords = CRC_CHUNK_WORDS(wordSz);
+	int i;
+
+	for (i = 0; i + chunkWords <= nWords; i += chunkWords)
+	{
+		crc = TableChunk(((uint64_t)crc << (chunkWords * wordSz - 16)) ^ PackWords<wordSz>(&words[i], chunkWords));
+	}
+	for (; i < nWords; i++)
+	{
+		crc = TableChunk(((uint64_t)crc << (wordSz - 16)) ^ PackWords<wordSz>(&words[i], 1));
+	}
+	return(crc);
+}
+
+#ifdef DOLBYE_CRC_CLMUL
+/* x^k mod P */
+static constexpr uint64_t XPowMod(int k)
+{
+	uint32_t rem = 1;
+
+	for (int i = 0; i < k; i++)
+	{
+		rem <<= 1;
+		if (rem & 0x10000)
+		{
+			rem ^= 0x10000 | DOLBYE_CRC_POLY;
+		}
+	}
+	return(rem);
+}
+
+/* Low 64 bits of floor(x^80 / P), for Barrett reduction of a chunk times x^16 */
+static constexpr uint64_t BarrettConstant(void)
+{
+	uint64_t quotient = 0;
+	uint32_t rem = 0;
+
+	for (int i = 80; i >= 0; i--)
+	{
+		rem = (rem << 1) | (i == 80);
+		if (rem & 0x10000)
+		{
+			rem ^= 0x10000 | DOLBYE_CRC_POLY;
+			if (i < 64)
+			{
+				quotient |= (uint64_t)1 << i;
+			}
+		}
+	}
+	return(quotient);
+}
+
+// The quotient q = floor(u * x^16 / P) is floor(u * mu / x^64), the remainder the low 16 bits of q * P
+__attribute__((target("pclmul")))
+static inline unsigned int ClmulChunk(uint64_t u)
+{
+	const __m128i constants = _mm_set_epi64x((long long)(0x10000 | DOLBYE_CRC_POLY), (long long)BarrettConstant());
+	__m128i prod = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long)u), constants, 0x00);
+	uint64_t q = (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(prod, prod)) ^ u;
+	__m128i rem = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long)q), constants, 0x10);
+
+	return((unsigned int)_mm_cvtsi128_si32(rem) & 0xffff);
+}
+
+// Four words as the 4 * wordSz bit polynomial w0 x^3n + w1 x^2n + w2 x^n + w3, n = wordSz. Pairs are packed in each
+// 64 bit lane, then the first pair is moved up past the second
+template <int wordSz>
+__attribute__((target("pclmul")))
+static inline __m128i ClmulBlock(const int32_t *words)
+{
+	const __m128i evenMask = _mm_set_epi32(0, (int)(~0u << (32 - wordSz)), 0, (int)(~0u << (32 - wordSz)));
+	__m128i w = _mm_loadu_si128((const __m128i *)words);
+	__m128i pairs = _mm_xor_si128(_mm_slli_epi64(_mm_and_si128(w, evenMask), 2 * wordSz - 32), _mm_srli_epi64(w, 64 - wordSz));
+
+	return(_mm_xor_si128(_mm_unpacklo_epi64(_mm_slli_epi64(pairs, 2 * wordSz), _mm_srli_epi64(pairs, 64 - 2 * wordSz)),
+	                     _mm_srli_si128(pairs, 8)));
+}
+
+// x * x^d mod P, as a polynomial of at most 80 bits, with constants x^(64 + d) mod P (high) and x^d mod P (low)
+__attribute__((target("pclmul")))
+static inline __m128i ClmulFold(__m128i x, __m128i constants)
+{
+	return(_mm_xor_si128(_mm_clmulepi64_si128(x, constants, 0x00), _mm_clmulepi64_si128(x, constants, 0x11)));
+}
+
+/*	Four word blocks are folded into two 128 bit accumulators, alternate blocks each, so the carry-less multiplies of
+	one overlap the other's. The remainder is only taken at the end */
+template <int wordSz>
+__attribute__((target("pclmul")))
+static unsigned int ClmulWords(const int32_t *words, int nWords, unsigned int crc)
+{
+	const int chunkWords = CRC_CHUNK_WORDS(wordSz);
+	int i = 0;
+
+	if (nWords >= 16)
+	{
+		const __m128i fold4 = _mm_set_epi64x((long long)XPowMod(64 + 4 * wordSz), (long long)XPowMod(4 * wordSz));
+		const __m128i fold8 = _mm_set_epi64x((long long)XPowMod(64 + 8 * wordSz), (long long)XPowMod(8 * wordSz));
+		const __m128i fold64 = _mm_cvtsi64_si128((long long)XPowMod(64));
+		const __m128i low64 = _mm_set_epi64x(0, -1);
+
+		// The CRC so far is (the polynomial before these words) * x^16, so it is carried in as crc * x^(distance - 16)
+		__m128i acc0 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_cvtsi32_si128((int)crc), _mm_cvtsi64_si128((long long)XPowMod(4 * wordSz - 16)), 0x00),
+		                             ClmulBlock<wordSz>(words));
+		__m128i acc1 = ClmulBlock<wordSz>(&words[4]);
+
+		for (i = 8; i + 8 <= nWords; i += 8)
+		{
+			acc0 = _mm_xor_si128(ClmulFold(acc0, fold8), ClmulBlock<wordSz>(&words[i]));
+			acc1 = _mm_xor_si128(ClmulFold(acc1, fold8), ClmulBlock<wordSz>(&words[i + 4]));
+		}
+		__m128i acc = _mm_xor_si128(ClmulFold(acc0, fold4), acc1);
+
+		// Down to 64 bits, then the remainder of that times x^16
+		acc = _mm_xor_si128(_mm_clmulepi64_si128(acc, fold64, 0x01), _mm_and_si128(acc, low64));
+		crc = ClmulChunk((uint64_t)_mm_cvtsi128_si64(acc));
+	}
+	for (; i + chunkWords <= nWords; i += chunkWords)
+	{
+		crc = ClmulChunk(((uint64_t)crc << (chunkWords * wordSz - 16)) ^ PackWords<wordSz>(&words[i], chunkWords));
+	}
+	if (i < nWords)
+	{
+		// The last few words make a short chunk
+		int left = nWords - i;
+		crc = ClmulChunk(((uint64_t)crc << (left * wordSz - 16)) ^ PackWords<wordSz>(&words[i], left));
+	}
+	return(crc);
+}
+#endif
+
+/**************************************************************************************************************************************************************/
+unsigned int DolbyECrc16Bitwise(const int32_t *words, int nWords, int wordSz, unsigned int crc)
+{
+	for (int i = 0; i < nWords; i++)
+	{
+		for (int bit = 31; bit >= 32 - wordSz; bit--)
+		{
+			unsigned int in = ((uint32_t)words[i] >> bit) & 1;
+			crc = (((crc >> 15) ^ in) & 1) ? (((crc << 1) ^ DOLBYE_CRC_POLY) & 0xffff) : ((crc << 1) & 0xffff);
+		}
+	}
+	return(crc);
+}
+
+// Word sizes other than the three of Dolby E go one bit at a time
+unsigned int DolbyECrc16Table(const int32_t *words, int nWords, int wordSz, unsigned int crc)
+{
+	switch (wordSz)
+	{
+		case 16:
+			return(TableWords<16>(words, nWords, crc));
+		case 20:
+			return(TableWords<20>(words, nWords, crc));
+		case 24:
+			return(TableWords<24>(words, nWords, crc));
+		default:
+			return(DolbyECrc16Bitwise(words, nWords, wordSz, crc));
+	}
+}
+
+unsigned int DolbyECrc16(const int32_t *words, int nWords, int wordSz, unsigned int crc)
+{
+#ifdef DOLBYE_CRC_CLMUL
+	if (DolbyECrcClmul())
+	{
+		switch (wordSz)
+		{
+			case 16:
+				return(ClmulWords<16>(words, nWords, crc));
+			case 20:
+				return(ClmulWords<20>(words, nWords, crc));
+			case 24:
+				return(ClmulWords<24>(words, nWords, crc));
+		}
+	}
+#endif
+	return(DolbyECrc16Table(words, nWords, wordSz, crc));
+}
+
+bool DolbyECrcClmul(void)
+{
+#ifdef DOLBYE_CRC_CLMUL
+	static const bool haveClmul = __builtin_cpu_supports("pclmul");
+	return(haveClmul);
+#else
+	return(false);
+#endif
+}
+/**************************************************************************************************************************************************************/
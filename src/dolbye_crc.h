@@ -0,0 +1,63 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_DOLBYE_CRC_H_
+#define		_DOLBYE_CRC_H_
+
+#include <stdint.h>
+
+/*	CRC of Dolby E segments: generator x^16 + x^15 + x^2 + 1, most significant bit first from zero.
+	Each segment's CRC word follows its last word, the CRC right justified, so the CRC of the segment's
+	words together with its CRC word is zero when they are intact. Words are bitstream words of 16, 20
+	or 24 bits, left justified in 32 bits as read from a .dde file */
+
+#define DOLBYE_CRC_POLY		0x8005
+
+// CRC of nWords words of wordSz bits, continuing from crc. Uses carry-less multiplication where the CPU has it,
+// otherwise DolbyECrc16Table()
+unsigned int DolbyECrc16(const int32_t *words, int nWords, int wordSz, unsigned int crc = 0);
+
+// As DolbyECrc16(), slice-by-8 table lookups on any CPU
+unsigned int DolbyECrc16Table(const int32_t *words, int nWords, int wordSz, unsigned int crc = 0);
+
+// As DolbyECrc16(), one bit at a time, for any word size. The reference the other two are checked against
+unsigned int DolbyECrc16Bitwise(const int32_t *words, int nWords, int wordSz, unsigned int crc = 0);
+
+// True if DolbyECrc16() uses carry-less multiplication
+bool DolbyECrcClmul(void);
+
+#endif	//	_DOLBYE_CRC_H_
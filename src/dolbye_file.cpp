@@ -37,6 +37,7 @@
 
 #include <stdio.h>
 #include "dolbye_file.h"
+#include "dolbye_crc.h"
 
 #define X -1
 
@@ -48,7 +49,9 @@ enum
 	BIT_ERR_NOINIT = 1000,
 	BIT_ERR_OVERWRITE,
 	BIT_ERR_FILEREAD,
-	BIT_ERR_UNDERFLOW
+	BIT_ERR_UNDERFLOW,
+	BIT_ERR_BUFSIZE,
+	BIT_ERR_ALIGN
 };
 
 DolbyEFile::DolbyEFile():
@@ -56,6 +59,7 @@ FilePtr(NULL),
 FileWrdSz(X),			/* file word size (bytes) */
 BSWrdSz(X),			/* bit stream / payload word size (bits) */
 BufPtr(nullptr),
+BufBase(nullptr),
 BitPtr(0),
 BitCnt(0)			/* number of bits in DataBuf */
 {}
@@ -128,6 +132,11 @@ int DolbyEFile::ReadFile(
 		return(BIT_ERR_OVERWRITE);		/* attempt to overwrite buffer */
 	}
 
+	if ((nWords < 0) || (nWords > DATA_BUF_SZ))
+	{
+		return(BIT_ERR_BUFSIZE);		/* e.g. a damaged preamble length */
+	}
+
 	if (fread((void *)DataBuf, FileWrdSz, nWords, FilePtr) != (size_t)nWords)
 	{
 		if (feof(FilePtr))
@@ -142,6 +151,7 @@ int DolbyEFile::ReadFile(
 
 	BitCnt = nWords * BSWrdSz;		/* set valid bit count */
 	BufPtr = DataBuf;				/* reset data buffer pointer */
+	BufBase = DataBuf;
 	BitPtr = 0;						/* reset current bit pointer */
 
 //	printf("Bit count = %d\n", BitCnt);
@@ -149,6 +159,49 @@ int DolbyEFile::ReadFile(
 	return(BIT_ERR_NONE);
 }	/* ReadFile() */
 
+/*******************************************************************************
+;
+; InitBuffer
+;	unpack from a caller supplied buffer instead of reading the file.
+;	The buffer is unkeyed in place and must stay valid while unpacking
+;
+*******************************************************************************/
+
+int DolbyEFile::InitBuffer(
+	Int32 *buf,					/* IN: packed data, one file word per item */
+	int nWords,					/* IN: # words in buf */
+	int wdSz)					/* IN: bit stream word size (bits) */
+{
+	if (buf == NULL) return(BIT_ERR_NOINIT);
+
+	FileWrdSz = sizeof(Int32);	/* words are held as read from a file */
+	BSWrdSz = wdSz;
+	BitCnt = nWords * BSWrdSz;
+	BufPtr = buf;
+	BufBase = buf;
+	BitPtr = 0;
+
+	return(BIT_ERR_NONE);
+}	/* InitBuffer() */
+
+/*******************************************************************************
+;
+; ExtendBuffer
+;	make words that have since been appended to the InitBuffer() buffer
+;	available, unpacking carries on from the current position
+;
+*******************************************************************************/
+
+int DolbyEFile::ExtendBuffer(
+	int nWords)					/* IN: # words appended to the InitBuffer() buffer */
+{
+	if (BSWrdSz == X) return(BIT_ERR_NOINIT);
+
+	BitCnt += nWords * BSWrdSz;
+
+	return(BIT_ERR_NONE);
+}	/* ExtendBuffer() */
+
 /*******************************************************************************
 ;
 ; GetBitsLeft
@@ -161,6 +214,18 @@ int DolbyEFile::GetBitsLeft(void)
 	return(BitCnt);
 }
 
+/*******************************************************************************
+;
+; GetBuffer
+;	get the first word of the buffer being unpacked, the frame payload
+;
+*******************************************************************************/
+
+const Int32 *DolbyEFile::GetBuffer(void)
+{
+	return(BufBase);
+}
+
 /*******************************************************************************
 ;
 ;	Function Name:	BitUnkey
@@ -263,6 +328,33 @@ int DolbyEFile::BitUnp_rj(					/* return error code.  0 = AOK */
 	return(BIT_ERR_NONE);
 }	/* BitUnp_rj() */
 
+/*******************************************************************************
+;
+;	Function Name:	CrcRemainder
+;	Contents:		CRC of the words of a segment and its CRC word, the last
+;					of which is about to be unpacked. Words are already unkeyed
+;
+*******************************************************************************/
+
+int DolbyEFile::CrcRemainder(			/* return error code.  0 = AOK */
+	int numitems,			/* IN: # words, ending with the one at the unpacking position */
+	int *remainder)			/* OUT: CRC remainder, 0 = intact */
+{
+	if (BSWrdSz == X) return(BIT_ERR_NOINIT);
+
+	if (BitPtr != 0)
+	{
+		return(BIT_ERR_ALIGN);			/* segment does not end on a word boundary */
+	}
+	if ((numitems < 1) || (BufPtr - BufBase < numitems - 1) || (BitCnt < BSWrdSz))
+	{
+		return(BIT_ERR_UNDERFLOW);		/* segment not all in the buffer */
+	}
+
+	*remainder = (int)DolbyECrc16(BufPtr - (numitems - 1), numitems, BSWrdSz);
+	return(BIT_ERR_NONE);
+}	/* CrcRemainder() */
+
 /*******************************************************************************
 ;
 ;	Function Name:	skipbits
@@ -62,6 +62,7 @@ private:
 	int BSWrdSz;			/* bit stream / payload word size (bits) */
 
 	Int32 DataBuf[DATA_BUF_SZ], *BufPtr;
+	Int32 *BufBase;			/* first word of the buffer being unpacked */
 	int BitPtr;
 	int BitCnt;				/* number of bits in DataBuf */
 	int DnCntr[N_DOWN_CNTRS];
@@ -80,8 +81,18 @@ public:
 	int ReadFile(					/* return error code.  0 = AOK */
 		int nWords);				/* IN: # items to be unpacked */
 
+	int InitBuffer(					/* return error code.  0 = AOK */
+		Int32 *buf,					/* IN: packed data, one file word per item */
+		int nWords,					/* IN: # words in buf */
+		int wdSz);					/* IN: bit stream word size (bits) */
+
+	int ExtendBuffer(				/* return error code.  0 = AOK */
+		int nWords);				/* IN: # words appended to the InitBuffer() buffer */
+
 	int GetBitsLeft(void);			/* return # of bits left in input buffer */
 
+	const Int32 *GetBuffer(void);	/* return first word of the buffer being unpacked, unkeyed as far as unpacked */
+
 	int BitUnkey(					/* return error code.  0 = AOK */
 		int keyvalue,				/* IN: key value */
 		int numitems); 				/* IN: # items to be unkeyed */
@@ -91,6 +102,10 @@ public:
 		int numitems, 				/* IN: # items to be unpacked  */
 		int numbits);				/* IN: # bits per item */
 
+	int CrcRemainder(				/* return error code.  0 = AOK */
+		int numitems,				/* IN: # words, ending with the one at the unpacking position */
+		int *remainder);			/* OUT: CRC remainder, 0 = intact */
+
 	int SkipBits(					/* return error code.  0 = AOK */
 		int numSkipBits);			/* IN: # bits to skip */
 
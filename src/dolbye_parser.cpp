@@ -39,16 +39,23 @@
 #include <iostream>
 #include <algorithm>
 #include <string>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <filesystem>
+#include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <xercesc/util/PlatformUtils.hpp>
 #include <xercesc/util/XMLString.hpp>
 #include <xercesc/dom/DOM.hpp>
 #include <xercesc/util/OutOfMemoryException.hpp>
-#include <xercesc/framework/MemBufFormatTarget.hpp>
+#include <xercesc/framework/XMLFormatter.hpp>
 
 #include "dolbye_parser.h"
 #include "dolbye_file.h"
+#include "json_text.h"
 
 constexpr short DolbyEParser::last_frame_tab[NUMFRAMERATES];
 constexpr short DolbyEParser::drop_frame_tab[NUMFRAMERATES];
@@ -63,36 +70,26 @@ constexpr int   DolbyEParser::lfeChanTab[NPGMCFG];
 
 /**************************************************************************************************************************************************************/
 // Helpers
-class XStr
+// Feature string for the DOM implementation lookup
+static const XMLCh coreFeature[] = { 'C', 'o', 'r', 'e', 0 };
+
+// Passes serializer output straight through to an S-ADM sink
+class SadmFormatTarget : public XMLFormatTarget
 {
     public :
-    XStr(const char* const toTranscode)
-    {
-        // Call the private transcoding method
-        fUnicodeForm = XMLString::transcode(toTranscode);
-    }
-    XStr(int i)
-    {
-        const std::string s = std::to_string(i);
-        fUnicodeForm = XMLString::transcode(s.c_str());
-    }
-
-    ~XStr()
+    SadmFormatTarget(SadmSink &s) : sink(s)
     {
-        XMLString::release(&fUnicodeForm);
     }
 
-    const XMLCh* unicodeForm() const
+    void writeChars(const XMLByte* const toWrite, const XMLSize_t count, XMLFormatter* const /*formatter*/) override
     {
-        return fUnicodeForm;
+        sink.Write(toWrite, count);
     }
 
     private :
-    XMLCh*   fUnicodeForm;
+    SadmSink &sink;
 };
 
-#define X(str) XStr(str).unicodeForm()
-
 static void timecode_to_string(char *s, int timecode[])
 {
     if ((timecode[1] & 0x3f) == 0x3f)
@@ -113,7 +110,8 @@ static void timecode_to_string(char *s, int timecode[])
 
 
 /**************************************************************************************************************************************************************/
-DolbyEParser::DolbyEParser(std::string dolbyeInputFileName)
+DolbyEParser::DolbyEParser(std::string dolbyeInputFileName, bool indexFrames) :
+    frameCount(0)
 {
 	if ((filePtr = fopen(dolbyeInputFileName.c_str(), "rb")) == NULL)
     {
@@ -124,93 +122,119 @@ DolbyEParser::DolbyEParser(std::string dolbyeInputFileName)
     {
         throw std::runtime_error("Error opening input file");
     }
-    // Determine number of frames in file
-    GetNumberFrames();
-    // Get Programme Descriptions
-    GetProgrammeDescriptionText();
+    // Determine number of frames in file and where each is
+    if (indexFrames)
+    {
+        BuildTimecodeIndex();
+    }
+    // Get Programme Descriptions, from as many frames as there are if that is known
+    GetProgrammeDescriptionText(indexFrames ? frameCount : DESC_TEXT_FRAMES);
+}
+
+DolbyEParser::DolbyEParser(void) :
+    filePtr(NULL),
+    frameCount(0),
+    doc(NULL)
+{
 }
 /**************************************************************************************************************************************************************/
 
 
 /**************************************************************************************************************************************************************/
 
-void DolbyEParser::GetNumberFrames(void)
+// One pass over the file recording where each frame is and its time code, which is near the start of the metadata
+// segment, so no more of each frame is parsed than that
+void DolbyEParser::BuildTimecodeIndex(void)
 {
     // save position
     long pos = ftell(filePtr);
     // rewind
     fseek(filePtr, 0, SEEK_SET);
-    frameCount = 0;
+    timecodeIndex.Clear();
     while (0 == findPreambleSync(&frameInfo))
     {
-        frameCount++;
+        long offset = ftell(filePtr) - (long)(PREAMBLE_SZ + frameInfo.frameLength) * FILE_WORD_SZ;
+        if (Dolby_E_frame_timecode(&frameInfo) == 0)
+        {
+            timecodeIndex.Add((uint64_t)offset, frameInfo.timecode, frameInfo.frameRate);
+        }
+        else
+        {
+            // Still a frame, but its time code is unknown
+            int invalid[8] = { 0, 0x3f };
+            timecodeIndex.Add((uint64_t)offset, invalid, frameInfo.frameRate);
+        }
     }
+    timecodeIndex.Finish();
+    frameCount = timecodeIndex.FrameCount();
     // Return to original position
     fseek(filePtr, pos, SEEK_SET);
 }
 
+void DolbyEParser::ResetDescriptionText(void)
+{
+    memset(desc_text_ptr, 0, sizeof(desc_text_ptr));
+    memset(null_char_warning, 0, sizeof(null_char_warning));
+    memset(desc_text_length_error, 0, sizeof(desc_text_length_error));
+    memset(desc_text_received, 0, sizeof(desc_text_received));
+    memset(desc_text_started, 0, sizeof(desc_text_started));
+    desc_text_updates = 0;
+}
+
+
+// A frame was lost or damaged, so no description text message in progress can be complete
+void DolbyEParser::FrameLost(void)
+{
+    memset(desc_text_started, 0, sizeof(desc_text_started));
+}
 
-void DolbyEParser::GetProgrammeDescriptionText(void)
+void DolbyEParser::GetProgrammeDescriptionText(unsigned int maxFrames)
 {
-    bool finished = false;
     // save position
     long pos = ftell(filePtr);
     // rewind
     fseek(filePtr, 0, SEEK_SET);
 
-    // Parse 70 frames
+    // Parse up to DESC_TEXT_FRAMES frames, metadata_segment() assembles the description text of each programme
     // This is guaranteed to find all messages irrespective of the start point in the sequence
-    unsigned int framesToCheck = std::min(frameCount, (unsigned int)70);
+    unsigned int framesToCheck = std::min(maxFrames, (unsigned int)DESC_TEXT_FRAMES);
     for (unsigned int frame = 0 ; frame < framesToCheck ; frame ++)
     {
-        GetNextFrame();
-        // Parse a Dolby E frame
+        try
+        {
+            if (GetNextFrame())
+            {
+                break;
+            }
+        }
+        catch (const std::runtime_error &)
+        {
+            // Without the index, the end of the file or a damaged preamble is only found here
+            break;
+        }
         if (Dolby_E_frame(&frameInfo))
         {
-            throw std::runtime_error("Error Parsing Dolby E frame");
+            // A damaged frame gives no description text
+            FrameLost();
+            continue;
         }
 
-        for (unsigned int pgm = 0 ; pgm < frameInfo.nProgs ; pgm++)
+        int pgm = 0;
+        while (pgm < frameInfo.nProgs && desc_text_received[pgm])
         {
-            if (desc_text_received[pgm])
-            {
-                continue;
-            }
-            int c = frameInfo.description_text[pgm];
-            switch (c)
-            {
-                case 0x00:    
-                    null_char_warning[pgm] = 1;
-                    break;
-                case 0x02:
-                    desc_text_ptr[pgm] = 0;
-                    break;
-                case 0x03:
-                    description_text_buf[pgm][desc_text_ptr[pgm]] = '\0';
-                    // Check to see if we have a valid string and signal
-                    if (strlen(description_text_buf[pgm]) > 0)
-                    {
-                        desc_text_received[pgm] = true; 
-                    }
-                    break;
-                default:
-                    if ((c < 0x20) || (c > 0x7e))
-                    {
-                        std::cerr << "Warning: Invalid Character in program description text" << std::endl;
-                        break;
-                    }    
-
-                    description_text_buf[pgm][desc_text_ptr[pgm]] = c;
-                    desc_text_ptr[pgm]++;
+            pgm++;
+        }
+        if (pgm == frameInfo.nProgs)
+        {
+            break;
+        }
+    }
 
-                    if(desc_text_ptr[pgm] >= MAX_DESCTEXTLEN)
-                    {
-                        std::cerr << "Warning: Program description text too long - Truncating" << std::endl;
-                        desc_text_length_error[pgm] = 1;
-                        desc_text_ptr[pgm] = 0;
-                        description_text_buf[pgm][MAX_DESCTEXTLEN - 1] = '\0';
-                    }
-            }
+    for (int pgm = 0 ; pgm < MAX_NPGRMS ; pgm++)
+    {
+        if (desc_text_length_error[pgm])
+        {
+            std::cerr << "Warning: Program description text too long - Truncating" << std::endl;
         }
     }
     // return to original position
@@ -222,10 +246,25 @@ int DolbyEParser::GetNextFrame(void)
 	// Initialize all frame info elements to zero
 	memset(&frameInfo, 0, sizeof(FrameInfoStruct));
 
+	pendingError = false;
 	int err = findPreambleSync(&frameInfo);
 	if (err)
     {
-        throw std::runtime_error("Couldn't find sync in input file");
+        if (!resilient)
+        {
+            throw std::runtime_error("Couldn't find sync in input file");
+        }
+        // GenerateSadmXML() holds the last intact frame in its place
+        pendingError = true;
+        resilienceStats.missingFrames++;
+        FrameLost();
+        return err;
+    }
+    if (resilient)
+    {
+        uint64_t offset = (uint64_t)ftell(filePtr) - (uint64_t)(PREAMBLE_SZ + frameInfo.frameLength) * FILE_WORD_SZ;
+        pendingMissing += MissedFrames(offset);
+        SyncFound(offset);
     }
     return err;
 }
@@ -245,34 +284,90 @@ int DolbyEParser::SkipNextFrame(void)
 
 int DolbyEParser::GetFrame(unsigned int frameNo)
 {
-	unsigned int offset = 0;
-	if (frameNo < frameCount)
-	{
-		fseek(filePtr, 0, SEEK_SET);
-		offset = frameNo;
-	}
-	if (frameNo > frameCount)
-	{
-		offset = frameNo - frameCount;
-	}
-	for (unsigned int i = 0 ; i < offset ; offset++)
+	SeekFrame(frameNo);
+	return(GetNextFrame());
+}
+
+void DolbyEParser::SeekFrame(unsigned int frameNo)
+{
+	uint64_t offset;
+
+	if (!timecodeIndex.FrameOffset(frameNo, offset))
 	{
-		int err = SkipNextFrame();
-		if (err)
-		{
-			return err;
-		}
+		throw std::runtime_error("Error: Frame outside file");
 	}
-	GetNextFrame();
-	return 0;
+	fseek(filePtr, (long)offset, SEEK_SET);
+	// Frames skipped are not missing
+	syncValid = false;
+	pendingMissing = 0;
+}/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+// One generator per thread, seeded from the OS entropy source on first use only
+static boost::uuids::random_generator_mt19937 &UUIDGenerator(void)
+{
+    thread_local boost::uuids::random_generator_mt19937 generator;
+    return generator;
+}
+
+// Format as lower case 8-4-4-4-12 hex without going through a stream
+static void UUIDToText(const boost::uuids::uuid &u, char *text)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    int pos = 0;
+
+    for (int i = 0 ; i < 16 ; i++)
+    {
+        if (i == 4 || i == 6 || i == 8 || i == 10)
+        {
+            text[pos++] = '-';
+        }
+        text[pos++] = hexDigits[(u.data[i] >> 4) & 0x0f];
+        text[pos++] = hexDigits[u.data[i] & 0x0f];
+    }
+    text[pos] = '\0';
+}
+
+void DolbyEParser::GenerateUUID(char *uuidText)
+{
+    if (!flowIDSet)
+    {
+        flowID = deterministicFlowID ?
+            boost::uuids::name_generator_sha1(flowIDNamespace)(firstMetadata.data(), firstMetadata.size()) : UUIDGenerator()();
+        flowIDSet = true;
+    }
+    UUIDToText(flowID, uuidText);
+}
+
+std::string DolbyEParser::GenerateUUID(void)
+{
+    char uuidText[UUID_TEXT_LEN + 1];
+
+    GenerateUUID(uuidText);
+    return std::string(uuidText);
+}
+
+void DolbyEParser::SetDeterministicFlowID(const std::string &nameSpace)
+{
+    try
+    {
+        flowIDNamespace = boost::uuids::string_generator()(nameSpace);
+    }
+    catch (const std::exception &)
+    {
+        throw std::runtime_error("Error: Invalid flowID namespace UUID");
+    }
+    deterministicFlowID = true;
+    flowIDSet = false;
 }
 /**************************************************************************************************************************************************************/
 
 
 /**************************************************************************************************************************************************************/
-DOMElement* DolbyEParser::AddDomNode(DOMElement *parent, std::string label)
+DOMElement* DolbyEParser::AddDomNode(DOMElement *parent, SadmName label)
 {
-    DOMElement* elem = doc->createElement(X(label.c_str()));
+    DOMElement* elem = doc->createElement(SadmXmlName(label));
     parent->appendChild(elem);
     return(elem);
 }
@@ -280,45 +375,42 @@ DOMElement* DolbyEParser::AddDomNode(DOMElement *parent, std::string label)
 
 
 /**************************************************************************************************************************************************************/
-DOMElement* DolbyEParser::AddDomNodeValue(DOMElement *parent, std::string label, std::string value)
+DOMElement* DolbyEParser::AddDomNodeValue(DOMElement *parent, SadmName label, const XMLCh *value)
 {
-    DOMElement* elem = doc->createElement(X(label.c_str()));
+    DOMElement* elem = doc->createElement(SadmXmlName(label));
     parent->appendChild(elem);
-    elem->appendChild(doc->createTextNode(X(value.c_str())));
+    elem->appendChild(doc->createTextNode(value));
     return(elem);
 }
 
-DOMElement* DolbyEParser::AddDomNodeValue(DOMElement *parent, std::string label, unsigned int value)
+DOMElement* DolbyEParser::AddDomNodeValue(DOMElement *parent, SadmName label, int value)
 {
-    DOMElement* elem = doc->createElement(X(label.c_str()));
-    parent->appendChild(elem);
-    elem->appendChild(doc->createTextNode(X(value)));
-    return(elem);
+    return AddDomNodeValue(parent, label, XmlText(value).xml());
 }
 /**************************************************************************************************************************************************************/
 
 
 /**************************************************************************************************************************************************************/
-DOMElement* DolbyEParser::AddDomNodeAttribute(DOMElement *parent, std::string label, std::string attribute, unsigned int value)
+DOMElement* DolbyEParser::AddDomNodeAttribute(DOMElement *parent, SadmName label, SadmName attribute, int value)
 {
-    return AddDomNodeAttribute(parent, label, attribute, std::to_string(value));
+    return AddDomNodeAttribute(parent, label, attribute, XmlText(value).xml());
 }
 
-DOMElement* DolbyEParser::AddDomNodeAttribute(DOMElement *parent, std::string label, std::string attribute, std::string value)
+DOMElement* DolbyEParser::AddDomNodeAttribute(DOMElement *parent, SadmName label, SadmName attribute, const XMLCh *value)
 {
-    DOMElement* elem = doc->createElement(X(label.c_str()));
+    DOMElement* elem = doc->createElement(SadmXmlName(label));
     parent->appendChild(elem);
-    elem->setAttribute(X(attribute.c_str()), X(value.c_str()));
+    elem->setAttribute(SadmXmlName(attribute), value);
     return(elem);
 }
 
-DOMElement* DolbyEParser::AddDomNodeAttributes(DOMElement *parent, std::string label, const std::map<std::string, std::string> &attributes)
+DOMElement* DolbyEParser::AddDomNodeAttributes(DOMElement *parent, SadmName label, std::initializer_list<SadmAttribute> attributes)
 {
-    DOMElement* elem = doc->createElement(X(label.c_str()));
+    DOMElement* elem = doc->createElement(SadmXmlName(label));
     parent->appendChild(elem);
-    for (auto i : attributes)
+    for (const SadmAttribute &i : attributes)
     {
-        elem->setAttribute(X(i.first.c_str()), X(i.second.c_str()));
+        elem->setAttribute(SadmXmlName(i.name), i.value);
     }
     return(elem);
 }
@@ -328,28 +420,23 @@ DOMElement* DolbyEParser::AddDomNodeAttributes(DOMElement *parent, std::string l
 
 
 /**************************************************************************************************************************************************************/
-DOMElement* DolbyEParser::AddDomNodeValueAttribute(DOMElement *parent, std::string label, unsigned int value, std::string attribute, unsigned int attribValue)
-{
-    return AddDomNodeValueAttribute(parent, label, value, attribute, std::to_string(attribValue));
-}
-
-DOMElement* DolbyEParser::AddDomNodeValueAttribute(DOMElement *parent, std::string label, unsigned int value, std::string attribute, std::string attribValue)
+DOMElement* DolbyEParser::AddDomNodeValueAttribute(DOMElement *parent, SadmName label, int value, SadmName attribute, int attribValue)
 {
-    DOMElement* elem = doc->createElement(X(label.c_str()));
+    DOMElement* elem = doc->createElement(SadmXmlName(label));
     parent->appendChild(elem);
-    elem->appendChild(doc->createTextNode(X(value)));
-    elem->setAttribute(X(attribute.c_str()), X(attribValue.c_str()));
+    elem->appendChild(doc->createTextNode(XmlText(value).xml()));
+    elem->setAttribute(SadmXmlName(attribute), XmlText(attribValue).xml());
     return(elem);
 }
 
-DOMElement* DolbyEParser::AddDomNodeValueAttributes(DOMElement *parent, std::string label, std::string value, const std::map<std::string, std::string> &attributes)
+DOMElement* DolbyEParser::AddDomNodeValueAttributes(DOMElement *parent, SadmName label, const XMLCh *value, std::initializer_list<SadmAttribute> attributes)
 {
-    DOMElement* elem = doc->createElement(X(label.c_str()));
+    DOMElement* elem = doc->createElement(SadmXmlName(label));
     parent->appendChild(elem);
-    elem->appendChild(doc->createTextNode(X(value.c_str())));
-    for (auto i : attributes)
+    elem->appendChild(doc->createTextNode(value));
+    for (const SadmAttribute &i : attributes)
     {
-        elem->setAttribute(X(i.first.c_str()), X(i.second.c_str()));
+        elem->setAttribute(SadmXmlName(i.name), i.value);
     }
     return(elem);
 }
@@ -359,23 +446,29 @@ DOMElement* DolbyEParser::AddDomNodeValueAttributes(DOMElement *parent, std::str
 /**************************************************************************************************************************************************************/
 void DolbyEParser::AddDolbyESegment(DOMElement *parent)
 {
-    DOMElement* deMdSegElem = AddDomNodeAttribute(parent, "metadataSegment", "ID", "1");
-    DOMElement* dolbyEElem = AddDomNodeAttribute(deMdSegElem, "dolbyE", "ID", "0");
-    AddDomNodeValue(dolbyEElem, "programConfig", frameInfo.progConfig);
-    AddDomNodeValue(dolbyEElem, "frameRateCode", frameInfo.frameRate);
+    DOMElement* deMdSegElem = AddDomNodeAttribute(parent, SADM_metadataSegment, SADM_ID, 1);
+    DOMElement* dolbyEElem = AddDomNodeAttribute(deMdSegElem, SADM_dolbyE, SADM_ID, 0);
+    AddDomNodeValue(dolbyEElem, SADM_programConfig, frameInfo.progConfig);
+    AddDomNodeValue(dolbyEElem, SADM_frameRateCode, frameInfo.frameRate);
 
     char tc[20];
     timecode_to_string(tc,frameInfo.timecode);
-    AddDomNodeValue(dolbyEElem, "smpteTimeCode", tc);
+    AddDomNodeValue(dolbyEElem, SADM_smpteTimeCode, XmlText(tc).xml());
 
     // Supported Dolby E programme configurations in the spec are 5.1+2 (0), 4x2 (6), 5.1 (11), 2+2 (19)
+    // Reported once per configuration, on stderr as the S-ADM may be going to stdout
+    if (progConfigReported & (1u << frameInfo.progConfig))
+    {
+        return;
+    }
+    progConfigReported |= (1u << frameInfo.progConfig);
     if (frameInfo.progConfig == 0 || frameInfo.progConfig == 6 || frameInfo.progConfig == 11 || frameInfo.progConfig == 19)
     {
-        std::cout << "Valid Dolby E programme configuration detected" << std::endl;
+        std::cerr << "Valid Dolby E programme configuration detected" << std::endl;
     }
     else
     {
-        std::cout << "*** Warning Unsupported Dolby E programme configuration detected ***" << std::endl;
+        std::cerr << "*** Warning Unsupported Dolby E programme configuration detected ***" << std::endl;
     }
 }
 /**************************************************************************************************************************************************************/
@@ -384,9 +477,7 @@ void DolbyEParser::AddDolbyESegment(DOMElement *parent)
 /**************************************************************************************************************************************************************/
 void DolbyEParser::AddAC3Segment(DOMElement *parent)
 {
-    DOMElement*  ac3MdSegElem = doc->createElement(X("metadataSegment"));
-    parent->appendChild(ac3MdSegElem);
-    ac3MdSegElem->setAttribute(X("ID"), X("3"));
+    DOMElement*  ac3MdSegElem = AddDomNodeAttribute(parent, SADM_metadataSegment, SADM_ID, 3);
     for (int progNo = 0 ; progNo < frameInfo.nProgs ; progNo++)
     {
         AddAC3Program(ac3MdSegElem, progNo);
@@ -398,9 +489,7 @@ void DolbyEParser::AddAC3Segment(DOMElement *parent)
 /**************************************************************************************************************************************************************/
 void DolbyEParser::AddAC3EncoderParametersSegment(DOMElement *parent)
 {
-    DOMElement*  ac3EncParamSegElem = doc->createElement(X("metadataSegment"));
-    parent->appendChild(ac3EncParamSegElem);
-    ac3EncParamSegElem->setAttribute(X("ID"), X("11"));
+    DOMElement*  ac3EncParamSegElem = AddDomNodeAttribute(parent, SADM_metadataSegment, SADM_ID, 11);
     for (int progNo = 0 ; progNo < frameInfo.nProgs ; progNo++)
     {
         AddAC3EncoderParameters(ac3EncParamSegElem, progNo);
@@ -412,73 +501,46 @@ void DolbyEParser::AddAC3EncoderParametersSegment(DOMElement *parent)
 /**************************************************************************************************************************************************************/
 void DolbyEParser::AddTransportTrackFormatElem(DOMElement *parent)
 {
-    std::string atu_id = "";
-    unsigned int trackCount = GetTotalNumberOfTracksRequired();
-    std::map<std::string,std::string> attributes;
-
-    attributes["transportID"] = "TP_0001";
-    attributes["transportName"] = "X";
-    attributes["numIDs"] = std::to_string(trackCount);
-    attributes["numTracks"] = std::to_string(trackCount);
-    DOMElement*  transportTrackFormatElem = AddDomNodeAttributes(parent, "transportTrackFormat", attributes);
+    XmlText trackCountText(admLayout.totalTracks);
 
-    attributes.clear();
-    attributes["formatLabel"] = "0001";
-    attributes["formatDefinition"] = "PCM";
+    DOMElement*  transportTrackFormatElem = AddDomNodeAttributes(parent, SADM_transportTrackFormat,
+        {{SADM_numIDs, trackCountText.xml()},
+         {SADM_numTracks, trackCountText.xml()},
+         {SADM_transportID, SadmXmlName(SADMV_transportID)},
+         {SADM_transportName, SadmXmlName(SADMV_transportName)}});
 
-    for (unsigned int atu_counter = 0 ; atu_counter < trackCount ; atu_counter++)
+    for (int trackNo = 1 ; trackNo <= admLayout.totalTracks ; trackNo++)
     {
-        attributes["trackID"] = std::to_string(atu_counter + 1);
-        DOMElement* audioTrackElem = AddDomNodeAttributes(transportTrackFormatElem, "audioTrack", attributes);
-        atu_id = audioTrackUID + std::to_string(atu_counter + 1);
-        // A cheap way to keep the number of hex digits correct for test files that contain more tracks (as counted by each programme acmod Vs. the max in Dolby E (8))
-        if (atu_id.length() > 12)
-        {
-            atu_id.erase(4,1);
-        }
-        AddDomNodeValue(audioTrackElem,"audioTrackUIDRef", atu_id);
+        DOMElement* audioTrackElem = AddDomNodeAttributes(transportTrackFormatElem, SADM_audioTrack,
+            {{SADM_formatDefinition, SadmXmlName(SADMV_PCM)},
+             {SADM_formatLabel, SadmXmlName(SADMV_formatLabel)},
+             {SADM_trackID, XmlText(trackNo).xml()}});
+        AddDomNodeValue(audioTrackElem, SADM_audioTrackUIDRef, XmlText(admTrackUIDTab[trackNo].text).xml());
     }
 }
 /**************************************************************************************************************************************************************/
 
 
 /**************************************************************************************************************************************************************/
-unsigned int DolbyEParser::GetTotalNumberOfTracksRequired()
+void DolbyEParser::BuildAdmLayout(void)
 {
-    unsigned int totalTracks = 0;
-    unsigned int ac3AcmodTracks = 0;
+    int trackNo = 1;
 
-    for (unsigned int progNo = 0 ; progNo < frameInfo.nProgs ; progNo++)
+    // Tracks are allocated to programmes in order, each programme taking the tracks of its AC-3 channel mode
+    admLayout.nProgs = frameInfo.nProgs;
+    for (int progNo = 0 ; progNo < admLayout.nProgs ; progNo++)
     {
-        switch(frameInfo.AC3Metadata.ac3_acmod[progNo])
+        const AcmodLayout *layout = &admAcmodLayoutTab[frameInfo.AC3Metadata.ac3_acmod[progNo] & (NACMODS - 1)];
+
+        if (layout->nTracks == 0)
         {
-            case 1:
-                ac3AcmodTracks = 1;
-                break;
-            case 2:
-                ac3AcmodTracks = 2;
-                break;
-            case 3:
-                ac3AcmodTracks = 3;
-                break;
-            case 4:
-                ac3AcmodTracks = 3;
-                break;
-            case 5:
-                ac3AcmodTracks = 4;
-                break;
-            case 6:
-                ac3AcmodTracks = 4;
-                break;
-            case 7:
-                ac3AcmodTracks = 6;
-                break;
-            default:
-                std::cout << "*** Error Invalid AC-3 channel configuration detected ***" << std::endl;
+            throw std::runtime_error("*** Error Invalid AC-3 channel configuration detected ***");
         }
-        totalTracks = totalTracks + ac3AcmodTracks;
+        admLayout.prog[progNo] = layout;
+        admLayout.firstTrack[progNo] = trackNo;
+        trackNo += layout->nTracks;
     }
-    return(totalTracks);
+    admLayout.totalTracks = trackNo - 1;
 }
 /**************************************************************************************************************************************************************/
 
@@ -487,14 +549,13 @@ unsigned int DolbyEParser::GetTotalNumberOfTracksRequired()
 void DolbyEParser::AddAudioFormatExtendedElem(DOMElement *parent)
 {
     // Top level of ADM
-    DOMElement*  audioFormatExtendedElem = AddDomNodeAttribute(parent, "audioFormatExtended", "version", "ITU-R_BS.2076-3");
+    DOMElement*  audioFormatExtendedElem = AddDomNodeAttribute(parent, SADM_audioFormatExtended, SADM_version, SadmXmlName(SADMV_admVersion));
     AddProfileElem(audioFormatExtendedElem);
 
     // Add audio programme(s) and references for each present AC-3 audio programme
-    int atuCount = 0;
-    for (int progNo = 0 ; progNo < frameInfo.nProgs ; progNo++)
+    for (int progNo = 0 ; progNo < admLayout.nProgs ; progNo++)
     {
-        atuCount = AddADMProgramme(audioFormatExtendedElem, progNo, atuCount);
+        AddADMProgramme(audioFormatExtendedElem, progNo);
     }
 }
 /**************************************************************************************************************************************************************/
@@ -503,154 +564,117 @@ void DolbyEParser::AddAudioFormatExtendedElem(DOMElement *parent)
 /**************************************************************************************************************************************************************/
 void DolbyEParser::AddProfileElem(DOMElement *parent)
 {
-    DOMElement*  profileListElem = doc->createElement(X("profileList"));
-    parent->appendChild(profileListElem);
+    DOMElement*  profileListElem = AddDomNode(parent, SADM_profileList);
+    XmlText one(1);
 
     // Include details about the AdvSS profile (Dolby E profile is a subset of it)
-    std::map<std::string,std::string> attributes1;
-    attributes1["profileName"] =  "Advanced sound system: ADM and S-ADM profile for emission";
-    attributes1["profileVersion"] = "1";
-    attributes1["profileLevel"] = "1";
-    AddDomNodeValueAttributes(profileListElem, "profile", "ITU-R BS.2168", attributes1);
+    AddDomNodeValueAttributes(profileListElem, SADM_profile, SadmXmlName(SADMV_advSSProfile),
+        {{SADM_profileLevel, one.xml()},
+         {SADM_profileName, SadmXmlName(SADMV_advSSProfileName)},
+         {SADM_profileVersion, one.xml()}});
 
     // Include details about the Dolby E profile
-    std::map<std::string,std::string> attributes;
-    attributes["profileName"] =  "Dolby E ADM and S-ADM Profile for emission";
-    attributes["profileVersion"] = "1";
-    attributes["profileLevel"] = "1";
-    AddDomNodeValueAttributes(profileListElem, "profile", "Dolby E ADM and S-ADM Profile for emission", attributes);
+    AddDomNodeValueAttributes(profileListElem, SADM_profile, SadmXmlName(SADMV_dolbyEProfile),
+        {{SADM_profileLevel, one.xml()},
+         {SADM_profileName, SadmXmlName(SADMV_dolbyEProfile)},
+         {SADM_profileVersion, one.xml()}});
 }
 /**************************************************************************************************************************************************************/
 
 
 /**************************************************************************************************************************************************************/
-unsigned int DolbyEParser::AddADMProgramme(DOMElement *parent, unsigned int progNo, unsigned int atuCount)
+void DolbyEParser::AddADMProgramme(DOMElement *parent, unsigned int progNo)
 {
-    std::string audioPackId;
-    std::string audioProgrammeName = "Programme " + std::to_string(progNo + 1);
-    std::string audioContentName = "Content " + std::to_string(progNo + 1);
-    std::string audioObjectName = "Object " + std::to_string(progNo + 1);
+    char audioProgrammeName[MAX_XML_TEXT_LEN];
+    char audioContentName[20];
+    char audioObjectName[20];
 
-    unsigned int countOfTracks = 0;
-    unsigned int atuStartOffset = atuCount;
-    unsigned int trackCount = 0;
+    const AcmodLayout *layout = admLayout.prog[progNo];
     int loudnessValue = frameInfo.AC3Metadata.ac3_dialnorm[progNo] * -1;
 
+    snprintf(audioContentName, sizeof(audioContentName), "Content %u", progNo + 1);
+    snprintf(audioObjectName, sizeof(audioObjectName), "Object %u", progNo + 1);
+
     // Add optional program description text
     if (desc_text_received[progNo])
     {
-        audioProgrammeName += std::string(" (") + std::string(description_text_buf[progNo]) + std::string(")");
+        snprintf(audioProgrammeName, sizeof(audioProgrammeName), "Programme %u (%s)", progNo + 1, description_text_buf[progNo]);
+    }
+    else
+    {
+        snprintf(audioProgrammeName, sizeof(audioProgrammeName), "Programme %u", progNo + 1);
     }
+    XmlText und(SadmNameText(SADMV_und));
+
     // audioProgramme structure is very simple, each audioProgramme references just one audioContent
-    std::map<std::string, std::string> attributes;
-    attributes["audioProgrammeID"] = audioProgrammeID + std::to_string(progNo + 1);
-    attributes["audioProgrammeName"] = audioProgrammeName;
-    attributes["audioProgrammeLanguage"] = "und";
+    DOMElement* audioProgrammeElement = AddDomNodeAttributes(parent, SADM_audioProgramme,
+        {{SADM_audioProgrammeID, XmlText(admProgrammeIDTab[progNo].text).xml()},
+         {SADM_audioProgrammeLanguage, und.xml()},
+         {SADM_audioProgrammeName, XmlText(audioProgrammeName).xml()}});
 
-    DOMElement* audioProgrammeElement = AddDomNodeAttributes(parent, "audioProgramme", attributes);
-    AddDomNodeValue(audioProgrammeElement, "audioContentIDRef", audioContentID + std::to_string(progNo + 1));
+    XmlText contentId(admContentIDTab[progNo].text);
+    AddDomNodeValue(audioProgrammeElement, SADM_audioContentIDRef, contentId.xml());
 
-    DOMElement* audioProgrammeloudnessElem = AddDomNode(audioProgrammeElement, "loudnessMetadata");
-    AddDomNodeValue(audioProgrammeloudnessElem, "dialogueLoudness", loudnessValue);
+    DOMElement* audioProgrammeloudnessElem = AddDomNode(audioProgrammeElement, SADM_loudnessMetadata);
+    AddDomNodeValue(audioProgrammeloudnessElem, SADM_dialogueLoudness, loudnessValue);
 
     // audioContent structure is very simple, each audioContent references one audio object
-    attributes.clear();
-    attributes["audioContentID"] = audioContentID + std::to_string(progNo + 1);
-    attributes["audioContentName"] = audioContentName;
-    attributes["audioContentLanguage"] = "und";
+    DOMElement* audioContentElement = AddDomNodeAttributes(parent, SADM_audioContent,
+        {{SADM_audioContentID, contentId.xml()},
+         {SADM_audioContentLanguage, und.xml()},
+         {SADM_audioContentName, XmlText(audioContentName).xml()}});
 
-    DOMElement* audioContentElement = AddDomNodeAttributes(parent, "audioContent", attributes);
-    AddDomNodeValue(audioContentElement, "audioObjectIDRef", audioObjectID + std::to_string(progNo + 1));
+    XmlText objectId(admObjectIDTab[progNo].text);
+    AddDomNodeValue(audioContentElement, SADM_audioObjectIDRef, objectId.xml());
 
-    DOMElement* audioContentloudnessElem = AddDomNode(audioContentElement, "loudnessMetadata");
-    AddDomNodeValue(audioContentloudnessElem, "dialogueLoudness", loudnessValue);
+    DOMElement* audioContentloudnessElem = AddDomNode(audioContentElement, SADM_loudnessMetadata);
+    AddDomNodeValue(audioContentloudnessElem, SADM_dialogueLoudness, loudnessValue);
     switch(frameInfo.AC3Metadata.ac3_bsmod[progNo])
     {
     // Complete Main
     case 0:
-        AddDomNodeValueAttribute(audioContentElement, "dialogue", 2, "mixedContentKind", "1");
+        AddDomNodeValueAttribute(audioContentElement, SADM_dialogue, 2, SADM_mixedContentKind, 1);
         break;
     // Music and Effects
     case 1:
-        AddDomNodeValueAttribute(audioContentElement, "dialogue", 0, "nonDialogueContentKind", "3");
+        AddDomNodeValueAttribute(audioContentElement, SADM_dialogue, 0, SADM_nonDialogueContentKind, 3);
         break;
     // Audio Description / Visually Impaired
     case 2:
-        AddDomNodeValueAttribute(audioContentElement, "dialogue", 2, "mixedContentKind", "4");
+        AddDomNodeValueAttribute(audioContentElement, SADM_dialogue, 2, SADM_mixedContentKind, 4);
         break;
     // Commentary
     case 4:
     case 5:
-        AddDomNodeValueAttribute(audioContentElement, "dialogue", 1, "dialogueContentKind", "5");
+        AddDomNodeValueAttribute(audioContentElement, SADM_dialogue, 1, SADM_dialogueContentKind, 5);
         break;
     // Emergency
     case 6:
-        AddDomNodeValueAttribute(audioContentElement, "dialogue", 1, "dialogueContentKind", "6");
+        AddDomNodeValueAttribute(audioContentElement, SADM_dialogue, 1, SADM_dialogueContentKind, 6);
         break;
     case 3:
     case 7:
     default:
-        AddDomNodeValueAttribute(audioContentElement, "dialogue", 2, "mixedContentKind", "0");
+        AddDomNodeValueAttribute(audioContentElement, SADM_dialogue, 2, SADM_mixedContentKind, 0);
     }
 
-    attributes.clear();
-    attributes["audioObjectID"] = audioObjectID + std::to_string(progNo + 1);
-    attributes["audioObjectName"] = audioObjectName;
-    attributes["interact"] = "0";
-    DOMElement* audioObjectElement = AddDomNodeAttributes(parent, "audioObject", attributes);
-
-    // The only supported channel modes in spec are 2.0 and 5.1, support for other acmod values is left in here for test purposes
-    // Channel modes that are not in common defs (2/1 and 2/2) will have the audioPackFormatID in the composition set to the nearest equivalent (3.0 and 3.1)
-    switch(frameInfo.AC3Metadata.ac3_acmod[progNo])
-    {
-        case 1:
-            countOfTracks = 1;
-            audioPackId = "1";
-            break;
-        case 2:
-            countOfTracks = 2;
-            audioPackId = "2";
-            break;
-        case 3:
-            countOfTracks = 3;
-            audioPackId = "a";
-            break;
-        case 4:
-            countOfTracks = 3;
-            audioPackId = "a";
-            break;
-        case 5:
-            countOfTracks = 4;
-            audioPackId = "b";
-            break;
-        case 6:
-            countOfTracks = 4;
-            audioPackId = "b";
-            break;
-        case 7:
-            countOfTracks = 6;
-            audioPackId = "3";
-            break;
-        default:
-            throw std::runtime_error("*** Error Invalid AC-3 channel configuration detected ***");
-    }
+    DOMElement* audioObjectElement = AddDomNodeAttributes(parent, SADM_audioObject,
+        {{SADM_audioObjectID, objectId.xml()},
+         {SADM_audioObjectName, XmlText(audioObjectName).xml()},
+         {SADM_interact, XmlText(0).xml()}});
 
-    AddDomNodeValue(audioObjectElement, "audioPackFormatIDRef", audioPackFormatID + audioPackId);
-    for (trackCount = 0 ; trackCount < countOfTracks ; trackCount++)
+    // Pack and channel formats come from the common definitions, see admAcmodLayoutTab
+    XmlText packIdText(layout->packFormatID.text);
+    AddDomNodeValue(audioObjectElement, SADM_audioPackFormatIDRef, packIdText.xml());
+    for (int trackCount = 0 ; trackCount < layout->nTracks ; trackCount++)
     {
-        std::string atuId = audioTrackUID + std::to_string(atuStartOffset + (trackCount + 1));
-        // A cheap way to keep the number of hex digits correct for test files that contain more tracks (as counted by each programme acmod Vs. the max in Dolby E (8))
-        if (atuId.length() > 12)
-        {
-            atuId.erase(4,1);
-        }
-        AddDomNodeValue(audioObjectElement, "audioTrackUIDRef", atuId);
+        XmlText atuIdText(admTrackUIDTab[admLayout.firstTrack[progNo] + trackCount].text);
+        AddDomNodeValue(audioObjectElement, SADM_audioTrackUIDRef, atuIdText.xml());
 
-        DOMElement* audioTrackUIDElem = AddDomNodeAttribute(parent, "audioTrackUID", "UID", atuId);
-        AddDomNodeValue(audioTrackUIDElem, "audioChannelFormatIDRef", audioChannelFormatID + std::to_string(trackCount + 1));
-        AddDomNodeValue(audioTrackUIDElem, "audioPackFormatIDRef", audioPackFormatID + audioPackId);
+        DOMElement* audioTrackUIDElem = AddDomNodeAttribute(parent, SADM_audioTrackUID, SADM_UID, atuIdText.xml());
+        AddDomNodeValue(audioTrackUIDElem, SADM_audioChannelFormatIDRef, XmlText(layout->channelFormatID[trackCount].text).xml());
+        AddDomNodeValue(audioTrackUIDElem, SADM_audioPackFormatIDRef, packIdText.xml());
     }
-    return(atuStartOffset + trackCount);
 }
 /**************************************************************************************************************************************************************/
 
@@ -658,13 +682,13 @@ unsigned int DolbyEParser::AddADMProgramme(DOMElement *parent, unsigned int prog
 /**************************************************************************************************************************************************************/
 void DolbyEParser::AddAC3EncoderParameters(DOMElement *parent, unsigned int progNo)
 {
-    DOMElement* ac3ProgEncodeParameters = AddDomNodeAttribute(parent, "encodeParameters", "ID", progNo);
-    AddDomNodeValue(ac3ProgEncodeParameters, "hpFOn", frameInfo.AC3Metadata.ac3_hpfon[progNo]);
-    AddDomNodeValue(ac3ProgEncodeParameters, "bwLpFOn", frameInfo.AC3Metadata.ac3_bwlpfon[progNo]);
-    AddDomNodeValue(ac3ProgEncodeParameters, "lfeLpFOn", frameInfo.AC3Metadata.ac3_lfelpfon[progNo]);
-    AddDomNodeValue(ac3ProgEncodeParameters, "sur90On", frameInfo.AC3Metadata.ac3_sur90on[progNo]);
-    AddDomNodeValue(ac3ProgEncodeParameters, "surAttOn", frameInfo.AC3Metadata.ac3_suratton[progNo]);
-    AddDomNodeValue(ac3ProgEncodeParameters, "rfPremphOn", frameInfo.AC3Metadata.ac3_rfpremphon[progNo]);
+    DOMElement* ac3ProgEncodeParameters = AddDomNodeAttribute(parent, SADM_encodeParameters, SADM_ID, progNo);
+    AddDomNodeValue(ac3ProgEncodeParameters, SADM_hpFOn, frameInfo.AC3Metadata.ac3_hpfon[progNo]);
+    AddDomNodeValue(ac3ProgEncodeParameters, SADM_bwLpFOn, frameInfo.AC3Metadata.ac3_bwlpfon[progNo]);
+    AddDomNodeValue(ac3ProgEncodeParameters, SADM_lfeLpFOn, frameInfo.AC3Metadata.ac3_lfelpfon[progNo]);
+    AddDomNodeValue(ac3ProgEncodeParameters, SADM_sur90On, frameInfo.AC3Metadata.ac3_sur90on[progNo]);
+    AddDomNodeValue(ac3ProgEncodeParameters, SADM_surAttOn, frameInfo.AC3Metadata.ac3_suratton[progNo]);
+    AddDomNodeValue(ac3ProgEncodeParameters, SADM_rfPremphOn, frameInfo.AC3Metadata.ac3_rfpremphon[progNo]);
 }
 /**************************************************************************************************************************************************************/
 
@@ -672,49 +696,56 @@ void DolbyEParser::AddAC3EncoderParameters(DOMElement *parent, unsigned int prog
 /**************************************************************************************************************************************************************/
 void DolbyEParser::AddAC3Program(DOMElement *parent, unsigned int progNo)
 {
-    DOMElement* ac3ProgElem = AddDomNodeAttribute(parent, "ac3Program", "ID", progNo);
-
-    DOMElement* ac3ProgInfoElem = AddDomNode(ac3ProgElem, "programInfo");
-    AddDomNodeValue(ac3ProgInfoElem, "acMod", frameInfo.AC3Metadata.ac3_acmod[progNo]);
-    AddDomNodeValue(ac3ProgInfoElem, "bsMod", frameInfo.AC3Metadata.ac3_bsmod[progNo]);
-    AddDomNodeValue(ac3ProgInfoElem, "lfeOn", frameInfo.AC3Metadata.ac3_lfeon[progNo]);
-    AddDomNodeValue(ac3ProgElem, "cMixLev", frameInfo.AC3Metadata.ac3_cmixlev[progNo]);
-    AddDomNodeValue(ac3ProgElem, "surMixLev", frameInfo.AC3Metadata.ac3_surmixlev[progNo]);
-    AddDomNodeValue(ac3ProgElem, "dSurMod", frameInfo.AC3Metadata.ac3_dsurmod[progNo]);
-    AddDomNodeValue(ac3ProgElem,"dialNorm", frameInfo.AC3Metadata.ac3_dialnorm[progNo]);
-    AddDomNodeValue(ac3ProgElem,"copyRightB", frameInfo.AC3Metadata.ac3_copyrightb[progNo]);
-    AddDomNodeValue(ac3ProgElem, "origBs", frameInfo.AC3Metadata.ac3_origbs[progNo]);
-
-    DOMElement* langCodeElem = AddDomNodeAttribute(ac3ProgElem, "langCode", "exists", frameInfo.AC3Metadata.ac3_langcode[progNo]);
-    AddDomNodeValue(langCodeElem, "langCod", frameInfo.AC3Metadata.ac3_langcod[progNo]);
-
-    DOMElement* audioProdInfoElem = AddDomNodeAttribute(ac3ProgElem, "audioProdInfo", "exists", frameInfo.AC3Metadata.ac3_audprodie[progNo]);
-    AddDomNodeValue(audioProdInfoElem, "mixLevel", frameInfo.AC3Metadata.ac3_mixlevel[progNo]);
-    AddDomNodeValue(audioProdInfoElem,"roomTyp", frameInfo.AC3Metadata.ac3_roomtyp[progNo]);
-
-    DOMElement* extBsi1eElem = AddDomNodeAttribute(ac3ProgElem, "extBsi1e", "exists", frameInfo.AC3Metadata.ac3_xbsi1e[progNo]);
-    AddDomNodeValue(extBsi1eElem, "loRoCMixLev", frameInfo.AC3Metadata.ac3_lorocmixlev[progNo]);
-    AddDomNodeValue(extBsi1eElem, "loRoSurMixLev", frameInfo.AC3Metadata.ac3_lorosurmixlev[progNo]);
-    AddDomNodeValue(extBsi1eElem, "ltRtCMixLev", frameInfo.AC3Metadata.ac3_ltrtcmixlev[progNo]);
-    AddDomNodeValue(extBsi1eElem, "ltRtSurMixLev", frameInfo.AC3Metadata.ac3_ltrtsurmixlev[progNo]);
-    AddDomNodeValue(extBsi1eElem, "dMixMod", frameInfo.AC3Metadata.ac3_dmixmod[progNo]);
-
-    DOMElement* extBsi2eElem = AddDomNodeAttribute(ac3ProgElem, "extBsi2e", "exists", frameInfo.AC3Metadata.ac3_xbsi2e[progNo]);
-    AddDomNodeValue(extBsi2eElem, "dSurExMod", frameInfo.AC3Metadata.ac3_dsurexmod[progNo]);
-    AddDomNodeValue(extBsi2eElem, "dHeadPhonMod", frameInfo.AC3Metadata.ac3_dheadphonmod[progNo]);
-    AddDomNodeValue(extBsi2eElem, "adConvTyp", frameInfo.AC3Metadata.ac3_adconvtyp[progNo]);
-
-    AddDomNodeValueAttribute(ac3ProgElem,"compr1", frameInfo.AC3Metadata.ac3_compr1[progNo], "exists", frameInfo.AC3Metadata.ac3_compre[progNo]);
-    AddDomNodeValueAttribute(ac3ProgElem,"dynRng1", frameInfo.AC3Metadata.ac3_dynrng1[progNo], "exists", frameInfo.AC3Metadata.ac3_dynrnge[progNo]);
+    DOMElement* ac3ProgElem = AddDomNodeAttribute(parent, SADM_ac3Program, SADM_ID, progNo);
+
+    DOMElement* ac3ProgInfoElem = AddDomNode(ac3ProgElem, SADM_programInfo);
+    AddDomNodeValue(ac3ProgInfoElem, SADM_acMod, frameInfo.AC3Metadata.ac3_acmod[progNo]);
+    AddDomNodeValue(ac3ProgInfoElem, SADM_bsMod, frameInfo.AC3Metadata.ac3_bsmod[progNo]);
+    AddDomNodeValue(ac3ProgInfoElem, SADM_lfeOn, frameInfo.AC3Metadata.ac3_lfeon[progNo]);
+    AddDomNodeValue(ac3ProgElem, SADM_cMixLev, frameInfo.AC3Metadata.ac3_cmixlev[progNo]);
+    AddDomNodeValue(ac3ProgElem, SADM_surMixLev, frameInfo.AC3Metadata.ac3_surmixlev[progNo]);
+    AddDomNodeValue(ac3ProgElem, SADM_dSurMod, frameInfo.AC3Metadata.ac3_dsurmod[progNo]);
+    AddDomNodeValue(ac3ProgElem, SADM_dialNorm, frameInfo.AC3Metadata.ac3_dialnorm[progNo]);
+    AddDomNodeValue(ac3ProgElem, SADM_copyRightB, frameInfo.AC3Metadata.ac3_copyrightb[progNo]);
+    AddDomNodeValue(ac3ProgElem, SADM_origBs, frameInfo.AC3Metadata.ac3_origbs[progNo]);
+
+    DOMElement* langCodeElem = AddDomNodeAttribute(ac3ProgElem, SADM_langCode, SADM_exists, frameInfo.AC3Metadata.ac3_langcode[progNo]);
+    AddDomNodeValue(langCodeElem, SADM_langCod, frameInfo.AC3Metadata.ac3_langcod[progNo]);
+
+    DOMElement* audioProdInfoElem = AddDomNodeAttribute(ac3ProgElem, SADM_audioProdInfo, SADM_exists, frameInfo.AC3Metadata.ac3_audprodie[progNo]);
+    AddDomNodeValue(audioProdInfoElem, SADM_mixLevel, frameInfo.AC3Metadata.ac3_mixlevel[progNo]);
+    AddDomNodeValue(audioProdInfoElem, SADM_roomTyp, frameInfo.AC3Metadata.ac3_roomtyp[progNo]);
+
+    DOMElement* extBsi1eElem = AddDomNodeAttribute(ac3ProgElem, SADM_extBsi1e, SADM_exists, frameInfo.AC3Metadata.ac3_xbsi1e[progNo]);
+    AddDomNodeValue(extBsi1eElem, SADM_loRoCMixLev, frameInfo.AC3Metadata.ac3_lorocmixlev[progNo]);
+    AddDomNodeValue(extBsi1eElem, SADM_loRoSurMixLev, frameInfo.AC3Metadata.ac3_lorosurmixlev[progNo]);
+    AddDomNodeValue(extBsi1eElem, SADM_ltRtCMixLev, frameInfo.AC3Metadata.ac3_ltrtcmixlev[progNo]);
+    AddDomNodeValue(extBsi1eElem, SADM_ltRtSurMixLev, frameInfo.AC3Metadata.ac3_ltrtsurmixlev[progNo]);
+    AddDomNodeValue(extBsi1eElem, SADM_dMixMod, frameInfo.AC3Metadata.ac3_dmixmod[progNo]);
+
+    DOMElement* extBsi2eElem = AddDomNodeAttribute(ac3ProgElem, SADM_extBsi2e, SADM_exists, frameInfo.AC3Metadata.ac3_xbsi2e[progNo]);
+    AddDomNodeValue(extBsi2eElem, SADM_dSurExMod, frameInfo.AC3Metadata.ac3_dsurexmod[progNo]);
+    AddDomNodeValue(extBsi2eElem, SADM_dHeadPhonMod, frameInfo.AC3Metadata.ac3_dheadphonmod[progNo]);
+    AddDomNodeValue(extBsi2eElem, SADM_adConvTyp, frameInfo.AC3Metadata.ac3_adconvtyp[progNo]);
+
+    AddDomNodeValueAttribute(ac3ProgElem, SADM_compr1, frameInfo.AC3Metadata.ac3_compr1[progNo], SADM_exists, frameInfo.AC3Metadata.ac3_compre[progNo]);
+    AddDomNodeValueAttribute(ac3ProgElem, SADM_dynRng1, frameInfo.AC3Metadata.ac3_dynrng1[progNo], SADM_exists, frameInfo.AC3Metadata.ac3_dynrnge[progNo]);
     if (desc_text_received[progNo])
     {
-            AddDomNodeValue(ac3ProgElem, "programDescriptionText", std::string(description_text_buf[progNo]));
+            AddDomNodeValue(ac3ProgElem, SADM_programDescriptionText, XmlText(description_text_buf[progNo]).xml());
     }
 
     // Supported ac3_acmod configurations are 2 and 7, others might not have an equivalent common def pack
-    if (frameInfo.AC3Metadata.ac3_acmod[progNo] == 2 || frameInfo.AC3Metadata.ac3_acmod[progNo] == 7)
+    // Reported once per programme and channel mode, as for the programme configuration
+    int acmod = frameInfo.AC3Metadata.ac3_acmod[progNo] & (NACMODS - 1);
+    if (acmodReported[progNo] & (1u << acmod))
     {
-        std::cout << "Valid AC-3 channel configuration detected" << std::endl;
+        return;
+    }
+    acmodReported[progNo] |= (1u << acmod);
+    if (acmod == 2 || acmod == 7)
+    {
+        std::cerr << "Valid AC-3 channel configuration detected" << std::endl;
     }
     else
     {
@@ -725,108 +756,1177 @@ void DolbyEParser::AddAC3Program(DOMElement *parent, unsigned int progNo)
 
 
 /**************************************************************************************************************************************************************/
-void DolbyEParser::GenerateSadmXML(std::string &s)
+void DolbyEParser::SerializeDocument(DOMImplementation *impl, SadmSink &sink)
+{
+    DOMLSSerializer   *theSerializer = ((DOMImplementationLS*)impl)->createLSSerializer();
+    DOMLSOutput       *theOutputDesc = ((DOMImplementationLS*)impl)->createLSOutput();
+    SadmFormatTarget  myFormTarget(sink);
+
+    theSerializer->getDomConfig()->setParameter(XMLUni::fgDOMWRTFormatPrettyPrint, true);
+    theSerializer->getDomConfig()->setParameter(XMLUni::fgDOMWRTXercesPrettyPrint, false);
+
+    theOutputDesc->setByteStream(&myFormTarget);
+    theSerializer->write(doc, theOutputDesc);
+
+    theOutputDesc->release();
+    theSerializer->release();
+
+    doc->release();
+    doc = NULL;
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void DolbyEParser::GenerateSadmFromTemplate(DOMImplementation *impl, SadmSink &sink, const SadmTemplate *frameTemplate, const SadmTemplate *admTemplate)
+{
+    SadmTemplateFill fill = {};
+    char duration[32];
+    char uuidText[UUID_TEXT_LEN + 1];
+
+    GenerateUUID(uuidText);
+    snprintf(duration, sizeof(duration), "00:00:00.0%dS48000", samples_per_frame[frameInfo.frameRate - 1]);
+    fill.flowID = uuidText;
+    fill.duration = duration;
+    for (int progNo = 0 ; progNo < frameInfo.nProgs ; progNo++)
+    {
+        fill.dialogueLoudness[progNo] = frameInfo.AC3Metadata.ac3_dialnorm[progNo] * -1;
+    }
+    fill.audioFormatExtended = admTemplate;
+
+    // DBMD carries most of the frame's metadata so is still built as a document, on its own
+    doc = impl->createDocument(0, SadmXmlName(SADM_dbmd), 0);
+    DOMElement* dbmdElem = doc->getDocumentElement();
+    AddSadmComment(dbmdElem);
+    AddDolbyESegment(dbmdElem);
+    AddAC3Segment(dbmdElem);
+    AddAC3EncoderParametersSegment(dbmdElem);
+
+    StringSink dbmdSink(fill.dbmd);
+    SerializeDocument(impl, dbmdSink);
+
+    // Drop the XML declaration, the element goes inside the template
+    size_t declEnd = fill.dbmd.find("?>");
+    if (declEnd != std::string::npos)
+    {
+        fill.dbmd.erase(0, fill.dbmd.find_first_not_of("\r\n", declEnd + 2));
+    }
+
+    frameTemplate->Write(sink, fill);
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void DolbyEParser::ParseFrame(void)
 {
 	// Parse a Dolby E frame
 	if (Dolby_E_frame(&frameInfo))
 	{
 		throw std::runtime_error("Error Parsing Dolby E frame");
 	}
+}
 
-	// Initialize the XML4C2 system
-    try
+void DolbyEParser::GenerateSadmXML(SadmSink &sink)
+{
+    if (resilient)
     {
-        XMLPlatformUtils::Initialize();
+        GenerateResilientSadm(sink);
+        return;
     }
-    catch(const XMLException& toCatch)
+    ParseFrame();
+    WriteCheckedSadm(sink);
+}
+
+// As GenerateSadmXML(), holding the last intact frame for any missing before this one, or for this one if it fails
+void DolbyEParser::GenerateResilientSadm(SadmSink &sink)
+{
+    for ( ; pendingMissing > 0 ; pendingMissing--)
     {
-        char *pMsg = XMLString::transcode(toCatch.getMessage());
-        std::cerr << "Error during Xerces-c Initialization.\n"
-        << "  Exception message:"
-        << pMsg;
-        XMLString::release(&pMsg);
+        WriteHeldSadm(sink, "no sync");
+    }
+    if (pendingError)
+    {
+        pendingError = false;
+        WriteHeldSadm(sink, "no sync");
         return;
     }
+    if (Dolby_E_frame(&frameInfo))
+    {
+        resilienceStats.parseErrors++;
+        FrameLost();
+        WriteHeldSadm(sink, "parse error");
+        return;
+    }
+    WriteCheckedSadm(sink);
+}
 
-    DOMImplementation* impl =  DOMImplementationRegistry::getDOMImplementation(X("Core"));
+// Write the S-ADM of the frame last parsed, or not, as the CRC policy has it
+void DolbyEParser::WriteCheckedSadm(SadmSink &sink)
+{
+    if (!crcCheck && !resilient)
+    {
+        WriteSadmXML(sink);
+        return;
+    }
 
-    if (impl == NULL)
+    if (crcCheck)
     {
-        throw std::runtime_error("Failed to create Implementation");
+        crcStats.frames++;
+    }
+    if (frameInfo.crcErrors == 0)
+    {
+        WriteIntactSadm(sink);
+        return;
     }
 
-    // Create top-level doc with root frame element of S-ADM
-    doc = impl->createDocument(0, X("frame"), 0);
+    crcStats.failedFrames++;
+    if (frameInfo.crcErrors & CRC_ERR_METADATA)
+    {
+        // Its description text character is suspect
+        FrameLost();
+    }
+    for (int bit = 0 ; bit < CRC_NSEGMENTS ; bit++)
+    {
+        if (frameInfo.crcErrors & (1 << bit))
+        {
+            crcStats.segmentFailures[bit]++;
+        }
+    }
 
-    DOMElement* rootElem = doc->getDocumentElement();
-    rootElem->setAttribute(X("version"), X("ITU-R_BS.2125-1"));
+    std::string reason = "CRC error: " + CrcSegmentList(frameInfo.crcErrors);
+    if (crcPolicy == CRC_FLAG)
+    {
+        sadmComment = " " + reason + " ";
+        WriteSadmXML(sink);
+        sadmComment.clear();
+    }
+    else if (crcPolicy == CRC_HOLD && WriteHeldSadm(sink, reason))
+    {
+        crcStats.held++;
+    }
+    else
+    {
+        // Dropped, as is a frame to be held before any has passed
+        crcStats.dropped++;
+    }
+}
 
-    DOMElement* frameHeaderElem = AddDomNode(rootElem, "frameHeader");
+// Write a frame that parsed intact, first holding the last one for any lost between them without trace in the input
+void DolbyEParser::WriteIntactSadm(SadmSink &sink)
+{
+    if (resilient && holdFrameValid)
+    {
+        int lost = (frameInfo.frame_count - holdFrame.frame_count - 1 - (int)outageFrames) & 0xffff;
+        if (lost > 0 && lost <= HOLD_MAX_GAP)
+        {
+            resilienceStats.missingFrames += lost;
+            FrameLost();
+            for ( ; lost > 0 ; lost--)
+            {
+                WriteHeldSadm(sink, "frame_count gap");
+            }
+        }
+    }
+    WriteSadmXML(sink);
+    FrameIntact();
+}
 
-    // Set S-ADM frame duration based upon Dolby E frame rate, if a fractional number then duration is set to first value of five frame sequence [1602, 1601, 1602, 1601, 1602]
-    // Here we create a unique flowID for each composition and include it (attribute is optional in AdvSS profile)
-    std::string duration = "00:00:00.0" + std::to_string(samples_per_frame[frameInfo.frameRate - 1]) + "S48000";
-    std::map<std::string,std::string> attributes;
-    attributes["frameFormatID"]="FF_00000001";
-    attributes["type"] = "full";
-    attributes["start"] = "00:00:00.00000S48000";
-    attributes["duration"] = duration;
-    attributes["timeReference"] = "local";
-    attributes["flowID"] = GenerateUUID();
-
-    AddDomNodeAttributes(frameHeaderElem, "frameFormat", attributes);
-
-    // Add the transportTrackFormat element
-    AddTransportTrackFormatElem(frameHeaderElem);
+// The frame parsed is intact, so is kept to hold in place of any lost after it, and any outage is over
+void DolbyEParser::FrameIntact(void)
+{
+    if (crcPolicy == CRC_HOLD || resilient)
+    {
+        memcpy(&holdFrame, &frameInfo, sizeof(FrameInfoStruct));
+        holdFrameValid = true;
+    }
+    outageFrames = 0;
+    outageNs = 0;
+}
 
-    // Add profileList element
-    AddProfileElem(frameHeaderElem);
-   
-    // Create ADM template based upon acmod for each program
-    AddAudioFormatExtendedElem(rootElem);
+// Write the last intact frame again in place of one lost, with why in a comment. False if there is none yet
+bool DolbyEParser::WriteHeldSadm(SadmSink &sink, const std::string &reason)
+{
+    FrameInfoStruct lost;
 
-    // Add DBMD custom metadata element
-    DOMElement* customElem = doc->createElement(X("audioFormatCustom"));
-    rootElem->appendChild(customElem);
-    attributes.clear();
-    attributes["audioFormatCustomSetID"] = "AFC_1001";
-    attributes["audioFormatCustomSetName"] = "DolbyE DBMD Chunk";
-    attributes["audioFormatCustomSetType"] = "CUSTOM_SET_TYPE_DOLBYE_DBMD_CHUNK";
-    attributes["audioFormatCustomSetVersion"] = "1";
-    DOMElement* customSetElem = AddDomNodeAttributes(customElem, "audioFormatCustomSet", attributes);
-    DOMElement* dbmdElem = doc->createElement(X("dbmd"));
-    customSetElem->appendChild(dbmdElem);
+    if (!holdFrameValid)
+    {
+        return(false);
+    }
+    sadmComment = " " + reason + ", held from frame_count " + std::to_string(holdFrame.frame_count) + " ";
+    memcpy(&lost, &frameInfo, sizeof(FrameInfoStruct));
+    memcpy(&frameInfo, &holdFrame, sizeof(FrameInfoStruct));
+
+    // Counted on from the frame held, so the output's frame_count and time code run on through the outage
+    frameInfo.frame_count = (holdFrame.frame_count + (int)outageFrames + 1) & 0xffff;
+    int32_t tc = TimecodeIndex::TimecodeFrames(holdFrame.timecode, holdFrame.frameRate);
+    if (tc >= 0)
+    {
+        TimecodeIndex::SetTimecode(tc + (int32_t)outageFrames + 1, holdFrame.frameRate, frameInfo.timecode);
+    }
+    WriteSadmXML(sink);
+    memcpy(&frameInfo, &lost, sizeof(FrameInfoStruct));
+    sadmComment.clear();
 
-    // Add Dolby E segment to DBMD
-    AddDolbyESegment(dbmdElem);
+    // An outage lasts from the first frame held to the next intact one
+    if (outageFrames++ == 0)
+    {
+        resilienceStats.outages++;
+    }
+    outageNs += (uint64_t)samples_per_frame[holdFrame.frameRate - 1] * 1000000000 / 48000;
+    resilienceStats.held++;
+    resilienceStats.longestOutage = std::max(resilienceStats.longestOutage, outageFrames);
+    resilienceStats.longestOutageNs = std::max(resilienceStats.longestOutageNs, outageNs);
+    return(true);
+}
 
-    // Add AC3 S=segment(s) to DBMD
-    AddAC3Segment(dbmdElem);
+// A comment at the start of the DBMD, where the frame written is flagged
+void DolbyEParser::AddSadmComment(DOMElement *parent)
+{
+    if (!sadmComment.empty())
+    {
+        parent->appendChild(doc->createComment(XmlText(sadmComment).xml()));
+    }
+}
 
-    // Add AC3 Encode parameter(s) segment to DBMD
-    AddAC3EncoderParametersSegment(dbmdElem);
+// Initialize the XML4C2 system
+static bool XmlPlatformInitialize(void)
+{
+    try
+    {
+        XMLPlatformUtils::Initialize();
+    }
+    catch(const XMLException& toCatch)
+    {
+        char *pMsg = XMLString::transcode(toCatch.getMessage());
+        std::cerr << "Error during Xerces-c Initialization.\n"
+        << "  Exception message:"
+        << pMsg;
+        XMLString::release(&pMsg);
+        return(false);
+    }
+    return(true);
+}
 
-    DOMLSSerializer   *theSerializer = ((DOMImplementationLS*)impl)->createLSSerializer();
-    DOMLSOutput       *theOutputDesc = ((DOMImplementationLS*)impl)->createLSOutput();
-    MemBufFormatTarget *myFormTarget;
+// # of XmlInitialize() calls not yet matched by XmlTerminate()
+static std::atomic<int> xmlHolds(0);
 
-    theSerializer->getDomConfig()->setParameter(XMLUni::fgDOMWRTFormatPrettyPrint, true);
-    theSerializer->getDomConfig()->setParameter(XMLUni::fgDOMWRTXercesPrettyPrint, false);
+bool DolbyEParser::XmlInitialize(void)
+{
+    if (!XmlPlatformInitialize())
+    {
+        return(false);
+    }
+    xmlHolds++;
+    return(true);
+}
 
-    myFormTarget = new MemBufFormatTarget();
-    theOutputDesc->setByteStream(myFormTarget);
-    theSerializer->write(doc, theOutputDesc);
+void DolbyEParser::XmlTerminate(void)
+{
+    xmlHolds--;
+    XMLPlatformUtils::Terminate();
+}
 
-    unsigned int xmlLen = myFormTarget->getLen();
-    const unsigned char *xmlBuffer = myFormTarget->getRawBuffer();
+void DolbyEParser::WriteSadmXML(SadmSink &sink)
+{
+    // Initialize Xerces for this frame only, unless it is held for the whole process
+    bool frameInit = (xmlHolds == 0);
+    if (frameInit && !XmlPlatformInitialize())
+    {
+        return;
+    }
 
-    s = std::string(xmlBuffer, xmlBuffer + xmlLen);
-    theOutputDesc->release();
-    theSerializer->release();
-    delete myFormTarget;
+    DOMImplementation* impl =  DOMImplementationRegistry::getDOMImplementation(coreFeature);
 
-    doc->release();
+    if (impl == NULL)
+    {
+        throw std::runtime_error("Failed to create Implementation");
+    }
 
-    XMLPlatformUtils::Terminate();
+    char tc[20];
+    timecode_to_string(tc, frameInfo.timecode);
+    sink.BeginFrame((unsigned int)frameInfo.frame_count, tc);
+
+    // Use templates when there are ones for this program configuration, channel modes and frame rate
+    const SadmTemplate *frameTemplate = NULL;
+    const SadmTemplate *admTemplate = NULL;
+    if (templateSet != NULL)
+    {
+        frameTemplate = templateSet->SelectFrame(frameInfo.progConfig, frameInfo.frameRate);
+        admTemplate = templateSet->SelectAudioFormatExtended(frameInfo.progConfig, frameInfo.AC3Metadata.ac3_acmod, frameInfo.AC3Metadata.ac3_bsmod);
+    }
+    if (frameTemplate != NULL && admTemplate != NULL)
+    {
+        GenerateSadmFromTemplate(impl, sink, frameTemplate, admTemplate);
+        sink.EndFrame();
+        if (frameInit)
+        {
+            XMLPlatformUtils::Terminate();
+        }
+        return;
+    }
+
+    // Create top-level doc with root frame element of S-ADM
+    doc = impl->createDocument(0, SadmXmlName(SADM_frame), 0);
+
+    DOMElement* rootElem = doc->getDocumentElement();
+    rootElem->setAttribute(SadmXmlName(SADM_version), SadmXmlName(SADMV_frameVersion));
+
+    DOMElement* frameHeaderElem = AddDomNode(rootElem, SADM_frameHeader);
+
+    // Set S-ADM frame duration based upon Dolby E frame rate, if a fractional number then duration is set to first value of five frame sequence [1602, 1601, 1602, 1601, 1602]
+    // Here we create a unique flowID for each composition and include it (attribute is optional in AdvSS profile)
+    char duration[32];
+    char uuidText[UUID_TEXT_LEN + 1];
+    GenerateUUID(uuidText);
+    snprintf(duration, sizeof(duration), "00:00:00.0%dS48000", samples_per_frame[frameInfo.frameRate - 1]);
+    AddDomNodeAttributes(frameHeaderElem, SADM_frameFormat,
+        {{SADM_duration, XmlText(duration).xml()},
+         {SADM_flowID, XmlText(uuidText).xml()},
+         {SADM_frameFormatID, SadmXmlName(SADMV_frameFormatID)},
+         {SADM_start, SadmXmlName(SADMV_startTime)},
+         {SADM_timeReference, SadmXmlName(SADMV_local)},
+         {SADM_type, SadmXmlName(SADMV_full)}});
+
+    // Allocate tracks to programmes, then add the transportTrackFormat element
+    BuildAdmLayout();
+    AddTransportTrackFormatElem(frameHeaderElem);
+
+    // Add profileList element
+    AddProfileElem(frameHeaderElem);
+   
+    // Create ADM template based upon acmod for each program
+    AddAudioFormatExtendedElem(rootElem);
+
+    // Add DBMD custom metadata element
+    DOMElement* customElem = AddDomNode(rootElem, SADM_audioFormatCustom);
+    DOMElement* customSetElem = AddDomNodeAttributes(customElem, SADM_audioFormatCustomSet,
+        {{SADM_audioFormatCustomSetID, SadmXmlName(SADMV_customSetID)},
+         {SADM_audioFormatCustomSetName, SadmXmlName(SADMV_customSetName)},
+         {SADM_audioFormatCustomSetType, SadmXmlName(SADMV_customSetType)},
+         {SADM_audioFormatCustomSetVersion, XmlText(1).xml()}});
+    DOMElement* dbmdElem = AddDomNode(customSetElem, SADM_dbmd);
+    AddSadmComment(dbmdElem);
+
+    // Add Dolby E segment to DBMD
+    AddDolbyESegment(dbmdElem);
+
+    // Add AC3 S=segment(s) to DBMD
+    AddAC3Segment(dbmdElem);
+
+    // Add AC3 Encode parameter(s) segment to DBMD
+    AddAC3EncoderParametersSegment(dbmdElem);
+
+    SerializeDocument(impl, sink);
+    sink.EndFrame();
+
+    if (frameInit)
+    {
+        XMLPlatformUtils::Terminate();
+    }
+}
+
+unsigned int DolbyEParser::GetFrameCount(void)
+{
+    return(frameCount);
+}
+
+const FrameInfoStruct &DolbyEParser::GetFrameInfo(void)
+{
+    return(frameInfo);
+}
+
+const TimecodeIndex &DolbyEParser::GetTimecodeIndex(void)
+{
+    return(timecodeIndex);
+}
+
+const char *DolbyEParser::GetProgrammeDescription(int progNo)
+{
+    return((progNo >= 0 && progNo < MAX_NPGRMS && desc_text_received[progNo]) ? description_text_buf[progNo] : NULL);
+}
+
+const char *DolbyEParser::GetChannelName(int progConfig, int ch)
+{
+    return((progConfig >= 0 && progConfig < NPGMCFG && ch >= 0 && ch < MAX_NCHANS) ? chanIDText[progConfig][ch] : "?");
+}
+
+int DolbyEParser::GetChannelProgramme(int progConfig, int ch)
+{
+    // Channel labels start with their programme number
+    const char *name = GetChannelName(progConfig, ch);
+    return((name[0] >= '0' && name[0] <= '9') ? name[0] - '0' : -1);
+}
+
+void DolbyEParser::SetTemplates(const SadmTemplateSet *templates)
+{
+    templateSet = templates;
+}
+
+void DolbyEParser::GenerateSadmXML(std::string &s)
+{
+    StringSink sink(s);
+
+    s.clear();
+    GenerateSadmXML(sink);
 }
-/**************************************************************************************************************************************************************/
\ No newline at end of file
+
+
+/**************************************************************************************************************************************************************/
+void DolbyEParser::SetFrameCallback(DolbyEFrameCallback callback)
+{
+    frameCallback = callback;
+}
+
+void DolbyEParser::SetSadmSink(SadmSink *sink)
+{
+    feedSink = sink;
+}
+
+void DolbyEParser::SetEarlyMetadata(bool enable)
+{
+    earlyMetadata = enable;
+}
+
+void DolbyEParser::SetRetractCallback(DolbyERetractCallback callback)
+{
+    retractCallback = callback;
+}
+
+void DolbyEParser::SetMetadataOnly(bool enable)
+{
+    metadataOnly = enable;
+}
+
+void DolbyEParser::SetExponentCapture(bool enable)
+{
+    exponentCapture = enable;
+    memset(channelExponents, 0, sizeof(channelExponents));
+}
+
+const ChannelExponentStruct &DolbyEParser::GetChannelExponents(int ch, int half)
+{
+    return(channelExponents[ch & (MAX_NCHANS - 1)][half & 1]);
+}
+
+const ChannelUsageStruct &DolbyEParser::GetChannelUsage(int ch, int half)
+{
+    return(channelUsage[ch & (MAX_NCHANS - 1)][half & 1]);
+}
+
+void DolbyEParser::SetCrcPolicy(CrcPolicy policy)
+{
+    crcPolicy = policy;
+    crcCheck = (policy != CRC_IGNORE);
+    holdFrameValid = false;
+}
+
+const DolbyECrcStats &DolbyEParser::GetCrcStats(void)
+{
+    return(crcStats);
+}
+
+void DolbyEParser::SetResilient(bool enable)
+{
+    bool reindex = (enable && !resilient && filePtr != NULL);
+
+    resilient = enable;
+    holdFrameValid = false;
+    if (reindex)
+    {
+        // The index stopped at the first damaged preamble, and description text at the frames it found
+        BuildTimecodeIndex();
+        ResetDescriptionText();
+        GetProgrammeDescriptionText(frameCount);
+        resilienceStats = {};
+    }
+    syncValid = false;
+    pendingMissing = 0;
+    pendingError = false;
+}
+
+const DolbyEResilienceStats &DolbyEParser::GetResilienceStats(void)
+{
+    return(resilienceStats);
+}
+
+const char *DolbyEParser::CrcSegmentName(int bit)
+{
+    static const char *const segmentText[CRC_NSEGMENTS] =
+    {   "metadata", "audio subsegment 0", "audio subsegment 1", "metadata extension",
+        "audio extension subsegment 0", "audio extension subsegment 1", "meter" };
+
+    return(((bit >= 0) && (bit < CRC_NSEGMENTS)) ? segmentText[bit] : "");
+}
+
+std::string DolbyEParser::CrcSegmentList(int crcErrors)
+{
+    std::string list;
+
+    for (int bit = 0 ; bit < CRC_NSEGMENTS ; bit++)
+    {
+        if (crcErrors & (1 << bit))
+        {
+            list += (list.empty() ? "" : ", ");
+            list += CrcSegmentName(bit);
+        }
+    }
+    return(list);
+}
+
+uint64_t DolbyEParser::FedFrameOffset(void)
+{
+    return(feedFrameOffset);
+}
+
+void DolbyEParser::SetRealtimeStats(RealtimeStats *stats)
+{
+    rtStats = stats;
+    rtBehind = false;
+    rtLastValid = false;
+}
+
+static inline uint64_t ElapsedNs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+    return((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+int DolbyEParser::Feed(const uint8_t *data, size_t len)
+{
+    int err = 0;
+
+    if (rtStats != NULL)
+    {
+        feedCallTime = std::chrono::steady_clock::now();
+        syncSearchTime = feedCallTime;
+    }
+
+    while (len > 0)
+    {
+        if (feedState == FEED_SEARCH)
+        {
+            // Assemble a word, which may be split across calls
+            size_t n = std::min(len, (size_t)(FILE_WORD_SZ - feedWordBytes));
+            memcpy(&feedWord[feedWordBytes], data, n);
+            feedWordBytes += (int)n;
+            feedPosition += n;
+            data += n;
+            len -= n;
+            if (feedWordBytes < FILE_WORD_SZ)
+            {
+                break;
+            }
+            feedWordBytes = 0;
+
+            // Slide it into the preamble window, unpacked as findPreambleSync() does
+            Int32 word;
+            memcpy(&word, feedWord, FILE_WORD_SZ);
+            if (feedPreambleWords == PREAMBLE_SZ)
+            {
+                memmove(&feedPreamble[0], &feedPreamble[1], (PREAMBLE_SZ - 1) * sizeof(feedPreamble[0]));
+                feedPreambleWords--;
+            }
+            feedPreamble[feedPreambleWords++] = (int)((unsigned int)word >> (FILE_WORD_SZ * 8 - MAX_BITDEPTH));
+            if (feedPreambleWords < PREAMBLE_SZ)
+            {
+                continue;
+            }
+
+            memset(&frameInfo, 0, sizeof(FrameInfoStruct));
+            if (checkPreamble(feedPreamble, &frameInfo) == 1 && frameInfo.frameLength > 0 && frameInfo.frameLength <= DATA_BUF_SZ)
+            {
+                feedState = FEED_PAYLOAD;
+                feedPreambleWords = 0;
+                feedBytes = 0;
+                feedMetadataWords = 0;
+                feedFrameOffset = feedPosition - PREAMBLE_SZ * FILE_WORD_SZ;
+                if (resilient)
+                {
+                    FedSync(feedFrameOffset);
+                }
+                if (rtStats != NULL)
+                {
+                    rtStats->stage[RT_STAGE_SYNC].Record(ElapsedNs(syncSearchTime, std::chrono::steady_clock::now()));
+                }
+            }
+            else if (resilient)
+            {
+                FedSearched(feedPosition);
+            }
+        }
+        else
+        {
+            // Payload goes straight into the reassembly buffer
+            size_t frameBytes = (size_t)frameInfo.frameLength * FILE_WORD_SZ;
+            size_t n = std::min(len, frameBytes - feedBytes);
+            if (!metadataOnly || feedMetadataWords == 0)
+            {
+                memcpy((uint8_t *)feedBuf + feedBytes, data, n);
+            }
+            feedBytes += n;
+            feedPosition += n;
+            data += n;
+            len -= n;
+
+            int frameErr = 0;
+            if ((earlyMetadata || metadataOnly) && feedMetadataWords == 0)
+            {
+                int metadataWords = FedMetadataWords(feedBuf, (int)(feedBytes / FILE_WORD_SZ));
+                if (metadataWords < 0)
+                {
+                    // Not a frame that can be parsed, look for the next one
+                    frameErr = FedParseError(-1);
+                    feedState = FEED_SEARCH;
+                }
+                else if (metadataWords > 0)
+                {
+                    frameErr = ParseFedMetadata(feedBuf, metadataWords);
+                    if (frameErr)
+                    {
+                        feedState = FEED_SEARCH;
+                    }
+                }
+                if (feedState == FEED_SEARCH)
+                {
+                    // Searching from part way through the payload, so carry on from its last word boundary
+                    feedWordBytes = (int)(feedBytes % FILE_WORD_SZ);
+                    memcpy(feedWord, (uint8_t *)feedBuf + feedBytes - feedWordBytes, feedWordBytes);
+                }
+            }
+            if (feedState == FEED_PAYLOAD && feedBytes == frameBytes)
+            {
+                frameErr = ParseFedFrame(feedBuf);
+                feedState = FEED_SEARCH;
+            }
+            if (frameErr)
+            {
+                err = frameErr;
+            }
+            if (rtStats != NULL && feedState == FEED_SEARCH)
+            {
+                syncSearchTime = std::chrono::steady_clock::now();
+            }
+        }
+    }
+    return(err);
+}
+
+int DolbyEParser::ParseInPlace(uint8_t *data, size_t len, size_t &consumed)
+{
+    Int32 *words = (Int32 *)data;
+    size_t nWords = len / FILE_WORD_SZ;
+    size_t pos = 0;
+    int err = 0;
+
+    if (rtStats != NULL)
+    {
+        feedCallTime = std::chrono::steady_clock::now();
+        syncSearchTime = feedCallTime;
+    }
+
+    while (1)
+    {
+        if (!inPlacePending)
+        {
+            // Look for a preamble, unpacked as findPreambleSync() does
+            bool found = false;
+            for ( ; pos + PREAMBLE_SZ <= nWords ; pos++)
+            {
+                int preamble[PREAMBLE_SZ];
+                for (int i = 0 ; i < PREAMBLE_SZ ; i++)
+                {
+                    preamble[i] = (int)((unsigned int)words[pos + i] >> (FILE_WORD_SZ * 8 - MAX_BITDEPTH));
+                }
+                memset(&frameInfo, 0, sizeof(FrameInfoStruct));
+                if (checkPreamble(preamble, &frameInfo) == 1 && frameInfo.frameLength > 0 && frameInfo.frameLength <= DATA_BUF_SZ)
+                {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+            {
+                // The last PREAMBLE_SZ - 1 words may start a preamble
+                consumed = pos * FILE_WORD_SZ;
+                if (resilient)
+                {
+                    FedSearched(feedPosition + consumed);
+                }
+                feedPosition += consumed;
+                return(err);
+            }
+            if (resilient)
+            {
+                FedSync(feedPosition + pos * FILE_WORD_SZ);
+            }
+            inPlacePending = true;
+            feedMetadataWords = 0;
+            if (rtStats != NULL)
+            {
+                rtStats->stage[RT_STAGE_SYNC].Record(ElapsedNs(syncSearchTime, std::chrono::steady_clock::now()));
+            }
+        }
+
+        // The frame is parsed where it lies, from the word after its preamble
+        Int32 *payload = &words[pos + PREAMBLE_SZ];
+        int received = (int)(nWords - pos - PREAMBLE_SZ);
+        int frameErr = 0;
+        if (received < frameInfo.frameLength)
+        {
+            if (earlyMetadata && feedMetadataWords == 0)
+            {
+                int metadataWords = FedMetadataWords(payload, received);
+                if (metadataWords < 0)
+                {
+                    frameErr = FedParseError(-1);
+                }
+                else if (metadataWords > 0)
+                {
+                    frameErr = ParseFedMetadata(payload, metadataWords);
+                }
+            }
+            if (!frameErr)
+            {
+                // Wait for the rest, keeping the preamble
+                consumed = pos * FILE_WORD_SZ;
+                feedPosition += consumed;
+                return(err);
+            }
+            pos += PREAMBLE_SZ;
+        }
+        else
+        {
+            frameErr = ParseFedFrame(payload);
+            pos += PREAMBLE_SZ + frameInfo.frameLength;
+        }
+        inPlacePending = false;
+        if (frameErr)
+        {
+            err = frameErr;
+        }
+        if (rtStats != NULL)
+        {
+            syncSearchTime = std::chrono::steady_clock::now();
+        }
+    }
+}
+
+void DolbyEParser::ResetFeed(void)
+{
+    syncValid = false;
+    feedState = FEED_SEARCH;
+    feedWordBytes = 0;
+    feedPreambleWords = 0;
+    feedBytes = 0;
+    feedMetadataWords = 0;
+    feedPosition = 0;
+    inPlacePending = false;
+}
+
+// Frame periods newly passed without a preamble by input position, judged by the frame spacing seen so far
+int DolbyEParser::MissedFrames(uint64_t position)
+{
+    int missed = 0;
+
+    if (!syncValid || syncSpacing == 0)
+    {
+        return(0);
+    }
+    // A preamble is missing once the input is half a frame period past where it was due, which allows for
+    // the spacing alternating at fractional frame rates
+    while (position - syncOffset > (syncMissing + 1) * syncSpacing + syncSpacing / 2)
+    {
+        syncMissing++;
+        missed++;
+    }
+    if (missed > 0)
+    {
+        resilienceStats.missingFrames += missed;
+        FrameLost();
+    }
+    return(missed);
+}
+
+// A preamble at input position offset, the frame spacing is learnt from the last one if none was missing between
+void DolbyEParser::SyncFound(uint64_t offset)
+{
+    if (syncValid && syncMissing == 0 && offset > syncOffset)
+    {
+        syncSpacing = offset - syncOffset;
+    }
+    syncValid = true;
+    syncOffset = offset;
+    syncMissing = 0;
+}
+
+// A pushed preamble at offset, after holding frames missing before it
+void DolbyEParser::FedSync(uint64_t offset)
+{
+    FedSearched(offset);
+    SyncFound(offset);
+}
+
+// Pushed input searched to position without sync, the last intact frame is held for each frame period passed
+void DolbyEParser::FedSearched(uint64_t position)
+{
+    for (int missed = MissedFrames(position) ; missed > 0 ; missed--)
+    {
+        HoldFedSadm("no sync");
+    }
+}
+
+// A pushed frame failed to parse, returns err
+int DolbyEParser::FedParseError(int err)
+{
+    if (resilient)
+    {
+        resilienceStats.parseErrors++;
+        FrameLost();
+        HoldFedSadm("parse error");
+    }
+    return(err);
+}
+
+// The rest of a frame failed after its metadata was written in early mode, too late for the CRC policy or holding, so
+// count it as though it had failed before and have the S-ADM withdrawn downstream
+void DolbyEParser::FedRemainderFailed(int crcErrors, const std::string &reason)
+{
+    if (crcErrors == 0)
+    {
+        if (resilient)
+        {
+            resilienceStats.parseErrors++;
+        }
+    }
+    else
+    {
+        if (frameInfo.crcErrors == crcErrors)
+        {
+            // Counted as passing when written
+            crcStats.failedFrames++;
+        }
+        for (int bit = 0 ; bit < CRC_NSEGMENTS ; bit++)
+        {
+            if (crcErrors & (1 << bit))
+            {
+                crcStats.segmentFailures[bit]++;
+            }
+        }
+    }
+    crcStats.retracted++;
+    if (retractCallback)
+    {
+        retractCallback(frameInfo, reason);
+    }
+}
+
+// Hold the last intact frame on the Feed() sink, flushed as WriteFedSadm() does with real-time accounting
+void DolbyEParser::HoldFedSadm(const char *reason)
+{
+    if (feedSink != NULL && WriteHeldSadm(*feedSink, reason) && rtStats != NULL)
+    {
+        feedSink->Flush();
+    }
+}
+
+// Words from the start of the payload to the end of the metadata segment, 0 if not yet known, -1 if invalid
+int DolbyEParser::FedMetadataWords(const Int32 *payload, int wordsReceived)
+{
+    int shift = FILE_WORD_SZ * 8 - frameInfo.wordSz;
+    int keyPresent;
+    unsigned int header;
+
+    // sync word (with key_present as its lsb), optional metadata key, then metadata_revision_id:4 and metadata_segment_size:10
+    if (wordsReceived < 1)
+    {
+        return(0);
+    }
+    keyPresent = ((unsigned int)payload[0] >> shift) & 1;
+    if (wordsReceived < 2 + keyPresent)
+    {
+        return(0);
+    }
+    header = (unsigned int)payload[1 + keyPresent];
+    if (keyPresent)
+    {
+        header ^= (unsigned int)payload[1] & ((~0u >> shift) << shift);
+    }
+
+    // The segment words are followed by metadata_crc
+    int metadataWords = 1 + keyPresent + (int)((header >> (FILE_WORD_SZ * 8 - 14)) & 0x3ff) + 1;
+    if (metadataWords > frameInfo.frameLength)
+    {
+        return(-1);
+    }
+    return((wordsReceived < metadataWords) ? 0 : metadataWords);
+}
+
+int DolbyEParser::ParseFedMetadata(Int32 *payload, int nWords)
+{
+    int err;
+
+    if ((err = dolbyEFile.InitBuffer(payload, nWords, frameInfo.wordSz)))
+    {
+        return(FedParseError(err));
+    }
+    frameCompleteTime = feedCallTime;
+    if ((err = Dolby_E_frame_metadata(&frameInfo)))
+    {
+        return(FedParseError(err));
+    }
+    if (rtStats != NULL)
+    {
+        rtStats->stage[RT_STAGE_PARSE].Record(ElapsedNs(frameCompleteTime, std::chrono::steady_clock::now()));
+    }
+    feedMetadataWords = nWords;
+
+    // Everything the S-ADM is made from is in the metadata segment
+    WriteFedSadm();
+    return(0);
+}
+
+int DolbyEParser::ParseFedFrame(Int32 *payload)
+{
+    int err;
+
+    if (feedMetadataWords > 0)
+    {
+        // Carry on from the end of the metadata segment, which is already unkeyed, parsed and written
+        if (!metadataOnly)
+        {
+            int written = frameInfo.crcErrors;
+            if ((err = dolbyEFile.ExtendBuffer(frameInfo.frameLength - feedMetadataWords)) == 0)
+            {
+                err = Dolby_E_frame_remainder(&frameInfo);
+            }
+            if (err)
+            {
+                FedRemainderFailed(0, "parse error");
+                return(err);
+            }
+            if (frameInfo.crcErrors != written)
+            {
+                FedRemainderFailed(frameInfo.crcErrors & ~written, "CRC error: " + CrcSegmentList(frameInfo.crcErrors & ~written));
+            }
+        }
+        if (rtStats != NULL)
+        {
+            rtStats->frames++;
+        }
+        if (frameCallback)
+        {
+            frameCallback(frameInfo);
+        }
+        return(0);
+    }
+
+    if ((err = dolbyEFile.InitBuffer(payload, frameInfo.frameLength, frameInfo.wordSz)))
+    {
+        return(FedParseError(err));
+    }
+    frameCompleteTime = feedCallTime;
+    if ((err = Dolby_E_frame(&frameInfo)))
+    {
+        return(FedParseError(err));
+    }
+    if (rtStats != NULL)
+    {
+        rtStats->stage[RT_STAGE_PARSE].Record(ElapsedNs(frameCompleteTime, std::chrono::steady_clock::now()));
+        rtStats->frames++;
+    }
+    if (frameCallback)
+    {
+        frameCallback(frameInfo);
+    }
+    WriteFedSadm();
+    return(0);
+}
+
+// Write the S-ADM of a pushed frame to the sink, with real-time accounting where enabled
+void DolbyEParser::WriteFedSadm(void)
+{
+    if (feedSink == NULL)
+    {
+        return;
+    }
+    if (rtStats == NULL)
+    {
+        WriteCheckedSadm(*feedSink);
+        return;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool skip = rtBehind && rtLastValid && FedMetadataUnchanged();
+    if (skip)
+    {
+        rtStats->skippedFrames++;
+        if (frameInfo.crcErrors == 0)
+        {
+            FrameIntact();
+        }
+    }
+    else
+    {
+        WriteCheckedSadm(*feedSink);
+        std::chrono::steady_clock::time_point serialized = std::chrono::steady_clock::now();
+        feedSink->Flush();
+        std::chrono::steady_clock::time_point written = std::chrono::steady_clock::now();
+        rtStats->stage[RT_STAGE_SERIALIZE].Record(ElapsedNs(start, serialized));
+        rtStats->stage[RT_STAGE_WRITE].Record(ElapsedNs(serialized, written));
+        memcpy(&rtLastFrame, &frameInfo, sizeof(FrameInfoStruct));
+        rtLastDescTextUpdates = desc_text_updates;
+        rtLastValid = true;
+    }
+
+    // The deadline is one frame period after the frame, or its metadata in early mode, was complete
+    uint64_t latency = ElapsedNs(frameCompleteTime, std::chrono::steady_clock::now());
+    uint64_t period = (uint64_t)samples_per_frame[frameInfo.frameRate - 1] * 1000000000 / 48000;
+    rtStats->stage[RT_STAGE_LATENCY].Record(latency);
+    rtBehind = (latency > period);
+    if (rtBehind)
+    {
+        rtStats->deadlineMisses++;
+        rtStats->worstOverrun = std::max(rtStats->worstOverrun, latency - period);
+    }
+}
+
+// True if the frame parsed would give the same S-ADM as the last one written, apart from its time code
+bool DolbyEParser::FedMetadataUnchanged(void)
+{
+    // As compare_frameinfo(), everything up to the meter segment
+    return((memcmp(&frameInfo, &rtLastFrame, offsetof(FrameInfoStruct, Meter)) == 0) &&
+           (desc_text_updates == rtLastDescTextUpdates));
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+DolbyEProbe DolbyEParser::Probe(const std::string &fileName, uint64_t offset)
+{
+    static const float fpsTab[NFRMRATE] = {(float)23.98, 24, 25, (float)29.97, 30, 50, (float)59.94, 60};
+    std::unique_ptr<DolbyEParser> parser(new DolbyEParser());
+    DolbyEProbe probe;
+    std::error_code ec;
+    uint8_t buf[65536];
+    uint64_t start = offset;
+    bool found = false;
+
+    FILE *fp = fopen(fileName.c_str(), "rb");
+    if (fp == NULL)
+    {
+        throw std::runtime_error("Error: File not found");
+    }
+    probe.fileName = fileName;
+    probe.fileSize = std::filesystem::file_size(fileName, ec);
+    probe.sizeKnown = !ec;
+    if (ec)
+    {
+        probe.fileSize = 0;
+    }
+    if (offset > 0 && fseek(fp, (long)offset, SEEK_SET) != 0)
+    {
+        fclose(fp);
+        throw std::runtime_error("Error: Unable to seek in input file");
+    }
+
+    // Pushed a word at a time, so the first frame's metadata is parsed before any more of the file is looked at
+    parser->SetEarlyMetadata(true);
+    while (!found && offset - start < PROBE_MAX_BYTES)
+    {
+        size_t len = fread(buf, 1, std::min(sizeof(buf), (size_t)(PROBE_MAX_BYTES - (offset - start))), fp);
+        if (len < FILE_WORD_SZ)
+        {
+            break;
+        }
+        len -= len % FILE_WORD_SZ;
+        for (size_t pos = 0 ; pos < len && !found ; pos += FILE_WORD_SZ, offset += FILE_WORD_SZ)
+        {
+            FeedState state = parser->feedState;
+            parser->Feed(&buf[pos], FILE_WORD_SZ);
+            if (state == FEED_SEARCH && parser->feedState == FEED_PAYLOAD)
+            {
+                probe.syncOffset = offset + FILE_WORD_SZ - PREAMBLE_SZ * FILE_WORD_SZ;
+            }
+            found = (parser->feedState == FEED_PAYLOAD && parser->feedMetadataWords > 0);
+        }
+    }
+    fclose(fp);
+    if (!found)
+    {
+        throw std::runtime_error("Couldn't find sync in input file");
+    }
+
+    const FrameInfoStruct &info = parser->frameInfo;
+    if (info.frameRate < 1 || info.frameRate > NFRMRATE)
+    {
+        throw std::runtime_error("Error: Invalid frame rate");
+    }
+    probe.frameBytes = (unsigned int)(PREAMBLE_SZ + info.frameLength) * FILE_WORD_SZ;
+    probe.estimatedFrames = (probe.sizeKnown && probe.fileSize > probe.syncOffset) ? (unsigned int)((probe.fileSize - probe.syncOffset) / probe.frameBytes) : 0;
+    probe.progConfig = info.progConfig;
+    probe.programConfig = parser->progConfigText[info.progConfig];
+    probe.frameRate = info.frameRate;
+    probe.frameRateText = parser->frameRateText[info.frameRate - 1];
+    probe.fps = fpsTab[info.frameRate - 1];
+    probe.bitDepth = info.wordSz;
+    probe.keyed = (info.keyPresent != 0);
+    probe.nProgs = info.nProgs;
+    probe.nChans = info.nChans;
+    timecode_to_string(probe.timecode, (int *)info.timecode);
+    probe.timecodeFrames = TimecodeIndex::TimecodeFrames(info.timecode, info.frameRate);
+    probe.frameCount = (unsigned int)info.frame_count;
+    for (int progNo = 0 ; progNo < MAX_NPGRMS ; progNo++)
+    {
+        probe.programmes[progNo].acMod = info.AC3Metadata.ac3_acmod[progNo];
+        probe.programmes[progNo].bsMod = info.AC3Metadata.ac3_bsmod[progNo];
+        probe.programmes[progNo].dialnorm = info.AC3Metadata.ac3_dialnorm[progNo];
+    }
+    return(probe);
+}
+
+std::string DolbyEProbeText(const DolbyEProbe &probe)
+{
+    char text[256];
+    char frames[32] = "";
+
+    // The frame count is left out where the input has no size to estimate it from
+    if (probe.sizeKnown)
+    {
+        snprintf(frames, sizeof(frames), ", %u frame%s", probe.estimatedFrames, (probe.estimatedFrames == 1) ? "" : "s");
+    }
+    snprintf(text, sizeof(text), "%s: %s, %s, %d bit, %s, %d programme%s%s, first time code %s",
+             probe.fileName.c_str(), probe.programConfig.c_str(), probe.frameRateText.c_str(), probe.bitDepth,
+             probe.keyed ? "keyed" : "not keyed", probe.nProgs, (probe.nProgs == 1) ? "" : "s", frames, probe.timecode);
+    return(text);
+}
+
+std::string DolbyEProbeJson(const DolbyEProbe &probe)
+{
+    char text[64];
+
+    std::string json = "{\"file\":" + JsonString(probe.fileName);
+    if (probe.sizeKnown)
+    {
+        json += ",\"size\":" + std::to_string(probe.fileSize);
+        json += ",\"frames\":" + std::to_string(probe.estimatedFrames);
+    }
+    json += ",\"programConfig\":" + JsonString(probe.programConfig);
+    snprintf(text, sizeof(text), "%g", probe.fps);
+    json += ",\"frameRate\":" + std::string(text);
+    json += ",\"bitDepth\":" + std::to_string(probe.bitDepth);
+    json += ",\"keyed\":" + std::string(probe.keyed ? "true" : "false");
+    json += ",\"channels\":" + std::to_string(probe.nChans);
+    json += ",\"timecode\":" + JsonString(probe.timecode);
+    json += ",\"programmes\":[";
+    for (int progNo = 0 ; progNo < probe.nProgs ; progNo++)
+    {
+        json += (progNo > 0) ? ",{" : "{";
+        json += "\"acMod\":" + std::to_string(probe.programmes[progNo].acMod);
+        json += ",\"bsMod\":" + std::to_string(probe.programmes[progNo].bsMod);
+        json += ",\"dialogueLoudness\":" + std::to_string(-probe.programmes[progNo].dialnorm);
+        json += "}";
+    }
+    json += "]}";
+    return(json);
+}
+/**************************************************************************************************************************************************************/
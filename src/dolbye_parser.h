@@ -1,303 +1,600 @@
-/****************************************************************************
- *
- *
- * Copyright (c) 2024 Dolby International AB.
- * All rights reserved.
-
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions are
- * met:
- *
- * 1. Redistributions of source code must retain the above copyright
- *    notice, this list of conditions and the following disclaimer.
- *
- * 2. Redistributions in binary form must reproduce the above copyright
- *    notice, this list of conditions and the following disclaimer in
- *    the documentation and/or other materials provided with the
- *    distribution.
- *
- * 3. Neither the name of the copyright holder nor the names of its
- *    contributors may be used to endorse or promote products derived
- *    from this software without specific prior written permission.
- *
- * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
- * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
- * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
- * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
- * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
- * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
- * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
- * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
- * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
- * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
- * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
- * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
- *
- ******************************************************************************/
-
-
-#ifndef		_DOLBYE_PARSER_H_
-#define		_DOLBYE_PARSER_H_
-
-#include <string>
-#include <map>
-
-#include "ddeinfo.h"
-#include "dolbye_file.h"
-
-#include <xercesc/dom/DOM.hpp>
-
-using namespace XERCES_CPP_NAMESPACE;
-
-
-#include <boost/uuid/uuid.hpp>
-#include <boost/uuid/uuid_generators.hpp>
-#include <boost/uuid/uuid_io.hpp>
-#include <boost/lexical_cast.hpp>
-
-
-
-
-class DolbyEParser
-{
-private:
-	FILE *filePtr;
-	unsigned int frameCount;
-	FrameInfoStruct frameInfo;
-	DolbyEFile dolbyEFile;
-	DOMDocument* doc;
-
-	char description_text_buf[MAX_NPGRMS][MAX_DESCTEXTLEN];    /* description text buffer */
-	int desc_text_ptr[MAX_NPGRMS] = {0};
-	int null_char_warning[MAX_NPGRMS] = {0};
-	int desc_text_length_error[MAX_NPGRMS] = {0};
-	bool desc_text_received[MAX_NPGRMS] = {false};
-
-	// Old Stuff
-
-	int compare_frameinfo(FrameInfoStruct *info1, FrameInfoStruct *info2);
-	int findPreambleSync(FrameInfoStruct *fip);
-	int Dolby_E_frame(FrameInfoStruct *fip);
-	int sync_segment(FrameInfoStruct *fip);
-	int display_sync_segment(FILE *xmlfp, FrameInfoStruct *fip, int display_flag);
-	int metadata_segment(FrameInfoStruct *fip);
-	int display_metadata_segment(FILE *xmlfp, FrameInfoStruct *fip, int display_flag);
-	int ac3_metadata_subsegment(FrameInfoStruct *fip, int subseg_id);
-	int display_ac3_metadata_subsegment(FILE *xmlfp, FrameInfoStruct *fip, int display_flag, int subseg_id);
-	int audio_segment(FrameInfoStruct *fip);
-	int channel_subsegment(ChannelSubsegInfoStruct *cip);
-	int metadata_extension_segment(FrameInfoStruct *fip);
-	int display_metadata_extension_segment(FILE *xmlfp, FrameInfoStruct *fip, int display_flag);
-	int ac3_metadata_extension_subsegment(FrameInfoStruct *fip);
-	int display_ac3_metadata_extension_subsegment(FILE *xmlfp, FrameInfoStruct *fip, int display_flag);
-	int audio_extension_segment(FrameInfoStruct *fip);
-	int meter_segment(FrameInfoStruct *fip);
-	int display_meter_segment(FILE *xmlfp, FrameInfoStruct *fip, int display_flag);
-
-	// New Stuff
-
-	DOMElement* AddDomNode(DOMElement *parent, std::string label);
-	DOMElement* AddDomNodeValue(DOMElement *parent, std::string label, std::string value);
-	DOMElement* AddDomNodeValue(DOMElement *parent, std::string label, unsigned int value);
-	DOMElement* AddDomNodeAttribute(DOMElement *parent, std::string label, std::string attribute, unsigned int value);
-	DOMElement* AddDomNodeAttribute(DOMElement *parent, std::string label, std::string attribute, std::string value);
-	DOMElement* AddDomNodeValueAttribute(DOMElement *parent, std::string label, unsigned int value, std::string attribute, unsigned int attribValue);
-	DOMElement* AddDomNodeValueAttribute(DOMElement *parent, std::string label, unsigned int value, std::string attribute, std::string attribValue);
-	DOMElement* AddDomNodeValueAttributes(DOMElement *parent, std::string label, std::string value, const std::map<std::string, std::string> &attributes);
-	DOMElement* AddDomNodeAttributes(DOMElement *parent, std::string label, const std::map<std::string, std::string> &attributes);
-	
-	void AddProfileElem(DOMElement *parent);
-	void AddDolbyESegment(DOMElement *parent);
-	void AddAC3Segment(DOMElement *parent);
-	void AddAC3Program(DOMElement *parent, unsigned int progNo);
-	void AddAC3EncoderParametersSegment(DOMElement *parent);	
-	void AddAC3EncoderParameters(DOMElement *parent, unsigned int progNo);
-	void AddTransportTrackFormatElem(DOMElement *parent);
-	void AddAudioFormatExtendedElem(DOMElement *parent);
-	
-	unsigned int AddADMProgramme(DOMElement *parent, unsigned int progNo, unsigned int atuCount);
-	unsigned int GetTotalNumberOfTracksRequired();
-	void GetProgrammeDescriptionText(void);
-	void GetNumberFrames(void);
-
-
-public:
-	DolbyEParser(std::string dolbyeInputFileName);
-
-	int GetNextFrame(void);
-	int SkipNextFrame(void);
-	int GetFrame(unsigned int frameNo);
-
-	void GenerateSadmXML(std::string &s);
-
-	std::string GenerateUUID(void)
-	{
-		const std::string uuid_str = boost::lexical_cast<std::string>(boost::uuids::random_generator()());
-    	return uuid_str;
-	}
-
-	// ADM ID names
-	const std::string audioTrackUID = "ATU_0000000";
-	const std::string audioPackFormatID = "AP_0001000";
-	const std::string audioChannelFormatID = "AC_0001000";
-	const std::string audioObjectID = "AO_100";
-	const std::string audioContentID = "ACO_100";
-	const std::string audioProgrammeID = "APR_100";
-
-	const float frame_rates[NUMFRAMERATES] = {(float)23.98, 24, 25, (float)29.97, 30};
-	const int samples_per_frame[NUMFRAMERATES] = {2002, 2000, 1920, 1602, 1600};
-
-	/* table giving the number of frames before turning over to zero in the SMPTE time code for each frame rate */
-	static constexpr short last_frame_tab[NUMFRAMERATES] = {24, 24, 25, 30, 30};
-
-	/* table giving the drop frame flag for each frame rate */
-	static constexpr short drop_frame_tab[NUMFRAMERATES] = {1, 0, 0, 1, 0};
-
-	const char *frame_rts[NUMFRAMERATES] = {"23.98 fps", "24 fps", "25 fps", "29.97 fps", "30 fps"};
-
-	static constexpr int maskSync[nBitDepths] =
-	{   0x0ffff00, 0x0fffff0, 0x0ffffff };
-
-	static constexpr int preambleSyncA[nBitDepths] =
-	{   0x0f87200, 0x06f8720, 0x096f872 };
-
-	static constexpr int preambleSyncB[nBitDepths] =
-	{   0x04e1f00, 0x054e1f0, 0x0a54e1f };
-
-	static constexpr int preambleMode[nBitDepths] =
-	{   0x0000000, 0x0002000, 0x0004000 };
-
-	static constexpr int bitDepthTab[nBitDepths] =
-	{   16, 20, 24 };
-
-	static constexpr int nProgsTab[NPGMCFG] =
-	{   2, 3, 2, 3, 4, 5, 4, 5, 6, 7, 8, 1, 2, 3, 3, 4, 5, 6, 1, 2, 3, 4, 1, 1 };
-
-	static constexpr int nChansTab[NPGMCFG] =
-	{   8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 6, 6, 6, 6, 6, 6, 6, 4, 4, 4, 4, 8, 8 };
-
-	static constexpr int lfeChanTab[NPGMCFG] =
-	{   5, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 5, 5 };
-
-	const char *yesNoText[2] =
-	{   "no", "yes" };
-
-	const char *progConfigText[NPGMCFG] =
-	{   "5.1+2", "5.1+1+1", "4+4", "4+2+2", "4+2+1+1", "4+1+1+1+1", "2+2+2+2",
-	    "2+2+2+1+1", "2+2+1+1+1+1", "2+1+1+1+1+1+1", "1+1+1+1+1+1+1+1",
-	    "5.1", "4+2", "4+1+1", "2+2+2", "2+2+1+1", "2+1+1+1+1", "1+1+1+1+1+1",
-	    "4", "2+2", "2+1+1", "1+1+1+1", "7.1", "7.1 Screen" };
-
-	const char *chanIDText[NPGMCFG][MAX_NCHANS] =
-	{   { "0L", "0C", "0Ls", "1L", "0R", "0LFE", "0Rs", "1R" },
-	    { "0L", "0C", "0Ls", "1C", "0R", "0LFE", "0Rs", "2C" },
-	    { "0L", "0C", "1L", "1C", "0R", "0S", "1R", "1S" },
-	    { "0L", "0C", "1L", "2L", "0R", "0S", "1R", "2R" },
-	    { "0L", "0C", "1L", "2C", "0R", "0S", "1R", "3C" },
-	    { "0L", "0C", "1C", "3C", "0R", "0S", "2C", "4C" },
-	    { "0L", "1L", "2L", "3L", "0R", "1R", "2R", "3R" },
-	    { "0L", "1L", "2L", "3C", "0R", "1R", "2R", "4C" },
-	    { "0L", "1L", "2C", "4C", "0R", "1R", "3C", "5C" },
-	    { "0L", "1C", "3C", "5C", "0R", "2C", "4C", "6C" },
-	    { "0C", "2C", "4C", "6C", "1C", "3C", "5C", "7C" },
-	    { "0L", "0C", "0Ls", "0R", "0LFE", "0Rs", "", "" },
-	    { "0L", "0C", "1L", "0R", "0S", "1R", "", "" },
-	    { "0L", "0C", "1C", "0R", "0S", "2C", "", "" },
-	    { "0L", "1L", "2L", "0R", "1R", "2R", "", "" },
-	    { "0L", "1L", "2C", "0R", "1R", "3C", "", "" },
-	    { "0L", "1C", "3C", "0R", "2C", "4C", "", "" },
-	    { "0C", "2C", "4C", "1C", "3C", "5C", "", "" },
-	    { "0L", "0C", "0R", "0S", "", "", "", "" },
-	    { "0L", "1L", "0R", "1R", "", "", "", "" },
-	    { "0L", "1C", "0R", "2C", "", "", "", "" },
-	    { "0C", "2C", "1C", "3C", "", "", "", "" }, 
-	    { "0L", "0C", "0Ls", "0BLs", "0R", "0LFE", "0Rs", "0BRs" },
-	    { "0L", "0C", "0Ls", "0Le", "0R", "0LFE", "0Rs", "0Re" }};
-
-	const char *frameRateText[NFRMRATE] =
-	{   "23.98 fps", "24 fps", "25 fps", "29.97 fps", "30 fps",
-	    "50 fps", "59.94 fps", "60 fps" };
-
-	const char *timeCodeText[2] =
-	{   "nondrop", "drop" };
-
-	const char *bandwidthIDText[4] =
-	{   "full bandwidth", "half bandwidth", "voice grade", "reserved" };
-
-	const char *bitpoolTypeText[2] =
-	{   "independent", "common" };
-
-	const char *metaSubSegText[16] =
-	{   "none", "AC-3 metadata subsegment xbsi support", 
-	    "AC-3 metadata subsegment no xbsi support", "reserved",
-	    "reserved", "reserved", "reserved", "reserved",
-	    "reserved", "reserved", "reserved", "reserved",
-	    "reserved", "reserved", "reserved", "reserved" };
-
-	const char *groupTypeCodeText[4] =
-	{   "long", "short", "bridge", "reserved" };
-
-	const char *newReuseText[4] =
-	{   "reuse", "new", "stop", "reserved" };
-
-	const char *onOffText[2] =
-	{   "off", "on" };
-
-	const char *AC3datarateText[32] =
-	{   "32 kbps", "40 kbps", "48 kbps", "56 kbps", "64 kbps", "80 kbps",
-	    "96 kbps", "112 kbps", "128 kbps", "160 kbps", "192 kbps", "224 kbps",
-	    "256 kbps", "320 kbps", "384 kbps", "448 kbps", "512 kbps", "576 kbps",
-	    "640 kbps", "reserved", "reserved", "reserved", "reserved", "reserved",
-	    "reserved", "reserved", "reserved", "reserved", "reserved", "reserved",
-	    "reserved", "not specified" };
-
-	const char *AC3bsmodText[9] =
-	{   "complete main", "music and effects", "visually impaired",
-	    "hearing impaired", "dialogue", "commentary", "emergency",
-	    "voice over", "karaoke" };
-
-	const char *AC3acmodText[8] =
-	{   "1+1", "1/0", "2/0", "3/0", "2/1", "3/1", "2/2", "3/2" };
-
-	const char *AC3cmixlevText[4] =
-	{   "-3 dB", "-4.5 dB", "-6 dB", "reserved" };
-
-	const char *AC3surmixlevText[4] =
-	{   "-3 dB", "-6 dB", "-inf dB", "reserved" };
-
-	const char *AC3dsurmodText[4] =
-	{   "not indicated", "NOT Dolby Surround encoded", "Dolby Surround encoded",
-	    "reserved" };
-
-	const char *AC3roomtypText[4] =
-	{   "not indicated", "large room, X curve monitor", "small room, flat monitor",
-	    "reserved" };
-
-	#define NCOMPPRESETS 6
-
-	const char *AC3compPresetText[NCOMPPRESETS] =
-	{       "none", "Film Standard", "Film Light", "Music Standard", "Music Light",
-	    "Speech" };
-
-	const char *AC3dmixmodText[4] = 
-	{      "not indicated", "Lt/Rt downmix preferred", "Lo/Ro downmix preferred",
-	       "reserved" };
-
-	const char *AC3newmixlevText[8] =
-	{      "1.414 (+3.0 dB)", "1.189 (+1.5 dB)", "1.000 ( 0.0 dB)", "0.841 (-1.5 dB)",
-	       "0.707 (-3.0 dB)", "0.595 (-4.5 dB)", "0.500 (-6.0 dB)", "0.000 (-inf dB)"};
-
-	const char *AC3dsurexmodText[4] =
-	{      "not indicated", "NOT Dolby Surround EX encoded", 
-	       "Dolby Surround EX encoded", "reserved"};
-
-	const char *AC3dheadphonmodText[4] =
-	{     "not indicated", "NOT Dolby Headphone encoded",
-	      "Dolby Headphone encoded", "reserved"};
-
-	const char *AC3adconvtyp[2] = 
-	{     "Standard", "HDCD"};
-};
-
-#endif //		_DOLBYE_PARSER_H_
-
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+
+#ifndef		_DOLBYE_PARSER_H_
+#define		_DOLBYE_PARSER_H_
+
+#include <string>
+#include <initializer_list>
+#include <functional>
+#include <chrono>
+#include <stdint.h>
+
+#include "ddeinfo.h"
+#include "dolbye_file.h"
+#include "adm_layout.h"
+#include "sadm_names.h"
+#include "sadm_sink.h"
+#include "sadm_template.h"
+#include "realtime_stats.h"
+#include "timecode_index.h"
+
+#include <xercesc/dom/DOM.hpp>
+
+using namespace XERCES_CPP_NAMESPACE;
+
+
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+#include <boost/uuid/uuid_io.hpp>
+
+#define UUID_TEXT_LEN	36		/* canonical 8-4-4-4-12 form, excluding terminator */
+
+#define PROBE_MAX_BYTES		(1024 * 1024)	/* input searched for the first frame by DolbyEParser::Probe() */
+#define HOLD_MAX_GAP		64				/* frame_count jumps up to this are frames lost, larger ones a new stream */
+#define DESC_TEXT_FRAMES	70				/* frames parsed for programme description text by the file constructor */
+#define FRAME_MAX_BYTES		((PREAMBLE_SZ + DATA_BUF_SZ) * FILE_WORD_SZ)	/* largest frame parsed, preamble included */
+
+/* Summary of a .dde file from its first frame, or the first at or after an offset, see DolbyEParser::Probe() */
+struct DolbyEProbe
+{
+	std::string fileName;
+	bool sizeKnown;						/* false for pipes and other inputs without a size, whose fileSize and estimatedFrames are 0 */
+	uint64_t fileSize;
+	uint64_t syncOffset;				/* bytes before the frame's preamble */
+	unsigned int frameBytes;			/* first frame, preamble included */
+	unsigned int estimatedFrames;		/* frames after syncOffset, if all are the size of the first */
+	int progConfig;
+	std::string programConfig;
+	int frameRate;						/* frame_rate_code */
+	std::string frameRateText;
+	float fps;
+	int bitDepth;
+	bool keyed;
+	int nProgs;
+	int nChans;
+	char timecode[12];
+	int32_t timecodeFrames;				/* the time code as frames since midnight, -1 if invalid */
+	unsigned int frameCount;			/* frame_count */
+	struct
+	{
+		int acMod;
+		int bsMod;
+		int dialnorm;
+	} programmes[MAX_NPGRMS];
+};
+
+// A probe as one line of text, and as a JSON object
+std::string DolbyEProbeText(const DolbyEProbe &probe);
+std::string DolbyEProbeJson(const DolbyEProbe &probe);
+
+/* What is written for a frame failing a CRC check, see DolbyEParser::SetCrcPolicy() */
+enum CrcPolicy
+{
+	CRC_IGNORE,						/* CRCs are not checked */
+	CRC_FLAG,						/* written as usual, with a comment in the DBMD naming the segments that failed */
+	CRC_DROP,						/* not written */
+	CRC_HOLD						/* the last intact frame is written again in its place, with a comment as CRC_FLAG */
+};
+
+/* Frames written under a CRC policy, see DolbyEParser::GetCrcStats() */
+struct DolbyECrcStats
+{
+	uint64_t frames;
+	uint64_t failedFrames;						/* at least one segment failed */
+	uint64_t segmentFailures[CRC_NSEGMENTS];	/* per CRC_ERR_ bit, lowest first */
+	uint64_t dropped;
+	uint64_t held;
+	uint64_t retracted;							/* early metadata: the rest of the frame failed after its S-ADM was written */
+};
+
+/* Frames held in resilient mode, see DolbyEParser::SetResilient() */
+struct DolbyEResilienceStats
+{
+	uint64_t parseErrors;			/* frames found that failed to parse */
+	uint64_t missingFrames;			/* frame periods of input passing without sync, and frame_count gaps */
+	uint64_t held;					/* frames written from the last intact one, for CRC failures under CRC_HOLD too */
+	uint64_t outages;				/* runs of held frames between intact ones */
+	uint64_t longestOutage;			/* frames held in the longest run */
+	uint64_t longestOutageNs;		/* and its duration in the stream */
+};
+
+/* Called by DolbyEParser::Feed() with each frame parsed */
+typedef std::function<void(const FrameInfoStruct &frameInfo)> DolbyEFrameCallback;
+
+/* Early metadata mode: the rest of a frame whose S-ADM has been written failed, see DolbyEParser::SetRetractCallback() */
+typedef std::function<void(const FrameInfoStruct &frameInfo, const std::string &reason)> DolbyERetractCallback;
+
+
+
+
+class DolbyEParser
+{
+private:
+	FILE *filePtr;
+	unsigned int frameCount;
+	TimecodeIndex timecodeIndex;
+	FrameInfoStruct frameInfo;
+	DolbyEFile dolbyEFile;
+	DOMDocument* doc;
+
+	char description_text_buf[MAX_NPGRMS][MAX_DESCTEXTLEN];    /* description text buffer */
+	int desc_text_ptr[MAX_NPGRMS] = {0};
+	int null_char_warning[MAX_NPGRMS] = {0};
+	int desc_text_length_error[MAX_NPGRMS] = {0};
+	bool desc_text_received[MAX_NPGRMS] = {false};
+	char desc_text_work[MAX_NPGRMS][MAX_DESCTEXTLEN];          /* message being received */
+	bool desc_text_started[MAX_NPGRMS] = {false};
+	unsigned int desc_text_updates = 0;                        /* # messages completed, in any programme */
+
+	// Push mode, see Feed()
+	enum FeedState
+	{
+		FEED_SEARCH,						/* sliding the preamble window one word at a time */
+		FEED_PAYLOAD						/* accumulating frameInfo.frameLength words */
+	};
+	FeedState feedState = FEED_SEARCH;
+	unsigned char feedWord[FILE_WORD_SZ];	/* partial word while searching */
+	int feedWordBytes = 0;
+	int feedPreamble[PREAMBLE_SZ];
+	int feedPreambleWords = 0;
+	Int32 feedBuf[DATA_BUF_SZ + 1];		/* reassembly buffer for one payload, + 1 as unpacking looks a word ahead */
+	size_t feedBytes = 0;
+	bool earlyMetadata = false;
+	bool metadataOnly = false;
+	uint64_t feedPosition = 0;			/* bytes fed since construction or ResetFeed() */
+	uint64_t feedFrameOffset = 0;		/* feedPosition of the current frame's preamble */
+	int feedMetadataWords = 0;			/* words parsed ahead of the payload completing, 0 if none */
+	bool inPlacePending = false;		/* ParseInPlace() found sync and left the frame's preamble unconsumed */
+	DolbyEFrameCallback frameCallback;
+	DolbyERetractCallback retractCallback;
+	SadmSink *feedSink = NULL;
+
+	// Exponents of the frame last parsed, see SetExponentCapture()
+	bool exponentCapture = false;
+	ChannelExponentStruct channelExponents[MAX_NCHANS][2] = {};
+	ChannelUsageStruct channelUsage[MAX_NCHANS][2] = {};		/* of the frame last parsed, see GetChannelUsage() */
+
+	// CRC checking, see SetCrcPolicy()
+	bool crcCheck = false;
+	CrcPolicy crcPolicy = CRC_IGNORE;
+	DolbyECrcStats crcStats = {};
+	std::string sadmComment;				/* added to the DBMD of the frame being written, if not empty */
+
+	// Holding the last intact frame in place of damaged or missing ones, see SetResilient()
+	bool resilient = false;
+	DolbyEResilienceStats resilienceStats = {};
+	bool holdFrameValid = false;
+	FrameInfoStruct holdFrame;				/* last frame written intact, for CRC_HOLD and resilient mode */
+	uint64_t outageFrames = 0;				/* held since holdFrame */
+	uint64_t outageNs = 0;
+	bool syncValid = false;					/* a preamble has been found since the input was positioned */
+	uint64_t syncOffset = 0;				/* input position of that preamble */
+	uint64_t syncSpacing = 0;				/* between the last two preambles with none missing between, 0 if unknown */
+	int syncMissing = 0;					/* frame periods since syncOffset found without a preamble */
+	int pendingMissing = 0;					/* found by GetNextFrame(), held by GenerateSadmXML() */
+	bool pendingError = false;				/* GetNextFrame() found no frame */
+
+	// Real-time accounting of pushed frames, see SetRealtimeStats()
+	RealtimeStats *rtStats = NULL;
+	std::chrono::steady_clock::time_point feedCallTime;		/* entry to the current Feed() call */
+	std::chrono::steady_clock::time_point syncSearchTime;		/* start of the search for the current sync */
+	std::chrono::steady_clock::time_point frameCompleteTime;	/* Feed() call delivering the last word parsed */
+	bool rtBehind = false;					/* the last frame missed its deadline */
+	bool rtLastValid = false;
+	FrameInfoStruct rtLastFrame;			/* frame last serialized */
+	unsigned int rtLastDescTextUpdates = 0;
+
+	const SadmTemplateSet *templateSet = NULL;
+
+	uint32_t progConfigReported = 0;			/* bit per program_config already reported on stderr */
+	uint32_t acmodReported[MAX_NPGRMS] = {0};	/* bit per ac3_acmod already reported, per programme */
+
+	AdmFrameLayout admLayout;		/* track layout of the current frame, see BuildAdmLayout() */
+
+	bool deterministicFlowID = false;
+	boost::uuids::uuid flowIDNamespace;
+	bool flowIDSet = false;
+	boost::uuids::uuid flowID;					/* one per stream, chosen when its first frame is written */
+	std::string firstMetadata;					/* words of the first intact metadata segment parsed, sync word on */
+
+	// Old Stuff
+
+	int compare_frameinfo(FrameInfoStruct *info1, FrameInfoStruct *info2);
+	int checkPreamble(const int preamble[], FrameInfoStruct *fip);
+	int findPreambleSync(FrameInfoStruct *fip);
+	int Dolby_E_frame(FrameInfoStruct *fip);
+	int Dolby_E_frame_metadata(FrameInfoStruct *fip);
+	int Dolby_E_frame_timecode(FrameInfoStruct *fip);
+	int Dolby_E_frame_remainder(FrameInfoStruct *fip);
+	int sync_segment(FrameInfoStruct *fip);
+	int display_sync_segment(FILE *xmlfp, FrameInfoStruct *fip, int display_flag);
+	int metadata_segment(FrameInfoStruct *fip);
+	int metadata_segment_head(FrameInfoStruct *fip);
+	int description_text_char(FrameInfoStruct *fip, int pgm);
+	int display_metadata_segment(FILE *xmlfp, FrameInfoStruct *fip, int display_flag);
+	int ac3_metadata_subsegment(FrameInfoStruct *fip, int subseg_id);
+	int display_ac3_metadata_subsegment(FILE *xmlfp, FrameInfoStruct *fip, int display_flag, int subseg_id);
+	int audio_segment(FrameInfoStruct *fip);
+	int channel_subsegment(ChannelSubsegInfoStruct *cip);
+	void capture_exponents(int ch, const ChannelSubsegInfoStruct *cip);
+	void record_usage(int ch, const ChannelSubsegInfoStruct *cip, int subsegBits, int unusedBits);
+	int check_crc(FrameInfoStruct *fip, int segment, int nWords);
+	int metadata_extension_segment(FrameInfoStruct *fip);
+	int display_metadata_extension_segment(FILE *xmlfp, FrameInfoStruct *fip, int display_flag);
+	int ac3_metadata_extension_subsegment(FrameInfoStruct *fip);
+	int display_ac3_metadata_extension_subsegment(FILE *xmlfp, FrameInfoStruct *fip, int display_flag);
+	int audio_extension_segment(FrameInfoStruct *fip);
+	int meter_segment(FrameInfoStruct *fip);
+	int display_meter_segment(FILE *xmlfp, FrameInfoStruct *fip, int display_flag);
+
+	// New Stuff
+
+	DOMElement* AddDomNode(DOMElement *parent, SadmName label);
+	DOMElement* AddDomNodeValue(DOMElement *parent, SadmName label, const XMLCh *value);
+	DOMElement* AddDomNodeValue(DOMElement *parent, SadmName label, int value);
+	DOMElement* AddDomNodeAttribute(DOMElement *parent, SadmName label, SadmName attribute, int value);
+	DOMElement* AddDomNodeAttribute(DOMElement *parent, SadmName label, SadmName attribute, const XMLCh *value);
+	DOMElement* AddDomNodeValueAttribute(DOMElement *parent, SadmName label, int value, SadmName attribute, int attribValue);
+	DOMElement* AddDomNodeValueAttributes(DOMElement *parent, SadmName label, const XMLCh *value, std::initializer_list<SadmAttribute> attributes);
+	DOMElement* AddDomNodeAttributes(DOMElement *parent, SadmName label, std::initializer_list<SadmAttribute> attributes);
+	
+	void AddProfileElem(DOMElement *parent);
+	void AddDolbyESegment(DOMElement *parent);
+	void AddAC3Segment(DOMElement *parent);
+	void AddAC3Program(DOMElement *parent, unsigned int progNo);
+	void AddAC3EncoderParametersSegment(DOMElement *parent);	
+	void AddAC3EncoderParameters(DOMElement *parent, unsigned int progNo);
+	void AddTransportTrackFormatElem(DOMElement *parent);
+	void AddAudioFormatExtendedElem(DOMElement *parent);
+	
+	void AddADMProgramme(DOMElement *parent, unsigned int progNo);
+	void BuildAdmLayout(void);
+	void SerializeDocument(DOMImplementation *impl, SadmSink &sink);
+	void GenerateSadmFromTemplate(DOMImplementation *impl, SadmSink &sink, const SadmTemplate *frameTemplate, const SadmTemplate *admTemplate);
+	void GetProgrammeDescriptionText(unsigned int maxFrames);
+	void FrameLost(void);
+	void BuildTimecodeIndex(void);
+	void ResetDescriptionText(void);
+	int FedMetadataWords(const Int32 *payload, int wordsReceived);
+	int ParseFedMetadata(Int32 *payload, int nWords);
+	int ParseFedFrame(Int32 *payload);
+	void WriteFedSadm(void);
+	void WriteCheckedSadm(SadmSink &sink);
+	void WriteIntactSadm(SadmSink &sink);
+	void FrameIntact(void);
+	bool WriteHeldSadm(SadmSink &sink, const std::string &reason);
+	void GenerateResilientSadm(SadmSink &sink);
+	int MissedFrames(uint64_t position);
+	void SyncFound(uint64_t offset);
+	void FedSync(uint64_t offset);
+	void FedSearched(uint64_t position);
+	int FedParseError(int err);
+	void FedRemainderFailed(int crcErrors, const std::string &reason);
+	void HoldFedSadm(const char *reason);
+	void AddSadmComment(DOMElement *parent);
+	bool FedMetadataUnchanged(void);
+
+
+public:
+	// Parser reading a .dde file. indexFrames false skips the pass over the whole file that builds the time code
+	// index, for callers that only read frames in order: GetFrameCount() is then 0 and SeekFrame() fails
+	DolbyEParser(std::string dolbyeInputFileName, bool indexFrames = true);
+
+	// Parser for input pushed with Feed() instead of read from a file
+	DolbyEParser(void);
+
+	int GetNextFrame(void);
+	int SkipNextFrame(void);
+	int GetFrame(unsigned int frameNo);
+
+	// Position the input so that GetNextFrame() reads frame frameNo (from 0), using the time code index
+	void SeekFrame(unsigned int frameNo);
+
+	// Parse the frame read by GetNextFrame() or GetFrame()
+	void ParseFrame(void);
+
+	// # frames in the input file, the frame last parsed, the file's time code index and a programme's description
+	// text (NULL if none received)
+	unsigned int GetFrameCount(void);
+	const FrameInfoStruct &GetFrameInfo(void);
+	const TimecodeIndex &GetTimecodeIndex(void);
+	const char *GetProgrammeDescription(int progNo);
+
+	// Label of channel ch in program configuration progConfig, e.g. "0LFE"
+	const char *GetChannelName(int progConfig, int ch);
+
+	// Write S-ADM for the frame last parsed
+	void WriteSadmXML(SadmSink &sink);
+
+	// Parse the next frame and write its S-ADM
+	void GenerateSadmXML(SadmSink &sink);
+	void GenerateSadmXML(std::string &s);
+
+	// Push input in .dde file layout (FILE_WORD_SZ byte words) in chunks of any size.
+	// Each frame is parsed as soon as its last word arrives and handed to the frame callback,
+	// then written as S-ADM to the sink, where set. At most one frame payload is buffered.
+	// Returns 0, or the error of a frame that failed to parse; the search for sync carries on after it
+	int Feed(const uint8_t *data, size_t len);
+
+	// Discard any partial frame, so that the next data fed is searched for sync afresh
+	void ResetFeed(void);
+	void SetFrameCallback(DolbyEFrameCallback callback);
+	void SetSadmSink(SadmSink *sink);
+
+	// As Feed(), but frames are parsed where they lie in data rather than copied, e.g. in a shared memory ring.
+	// data holds .dde words, FILE_WORD_SZ aligned, and frames are unkeyed in place, so it must be writable;
+	// it may be read one word beyond len. consumed is set to the bytes finished with. The rest, a partial frame or a
+	// possible preamble, must be presented again at the start of the next call, at the same address in early metadata
+	// mode. Returns as Feed(). Do not mix with Feed()
+	int ParseInPlace(uint8_t *data, size_t len, size_t &consumed);
+
+	// Low latency push mode: parse the sync and metadata segments, and write the S-ADM, as soon as
+	// their words have been fed. The rest of the frame is parsed once it arrives, then the frame callback is called
+	void SetEarlyMetadata(bool enable);
+
+	// Early metadata mode: called when the rest of a frame fails a CRC check or to parse after its S-ADM was written,
+	// with the reason, so that the document can be withdrawn downstream. Failures are counted in the CRC and
+	// resilience stats as for any frame, and a parse error is still returned by Feed()
+	void SetRetractCallback(DolbyERetractCallback callback);
+
+	// Parse only the sync and metadata segments of pushed frames, skipping the rest of each payload. The frame
+	// callback is still called once the whole frame has arrived
+	void SetMetadataOnly(bool enable);
+
+	// Keep each channel subsegment's exponents, for GetChannelExponents() in the frame callback
+	void SetExponentCapture(bool enable);
+
+	// Exponents of channel ch in the frame last parsed; half 0 is the audio segment, 1 the audio extension
+	// segment (low frame rates only). valid is 0 where the subsegment was not in the frame
+	const ChannelExponentStruct &GetChannelExponents(int ch, int half);
+
+	// Group type, bandwidth code and unused bits of channel ch's subsegments in the frame last parsed, halves as
+	// GetChannelExponents()
+	const ChannelUsageStruct &GetChannelUsage(int ch, int half);
+
+	// Check the CRC of every segment parsed. Frames written by GenerateSadmXML() or to the Feed() sink follow policy
+	// when a check fails, and whatever the policy FrameInfoStruct crcErrors says which segments failed
+	void SetCrcPolicy(CrcPolicy policy);
+	const DolbyECrcStats &GetCrcStats(void);
+
+	// Keep converting through damage: a frame failing to parse, each frame period of input without sync and each
+	// frame of a frame_count gap up to HOLD_MAX_GAP is written as the last intact frame, with frame_count and time
+	// code counted on and a comment saying why, as CRC_HOLD (which it is used with) does for CRC failures. The search
+	// for sync carries on throughout, so output resumes with the first intact frame after the damage. Enabling it
+	// with a file open indexes the file again, to take in frames after damaged preambles
+	void SetResilient(bool enable);
+	const DolbyEResilienceStats &GetResilienceStats(void);
+
+	// Segment named by CRC_ERR_ bit number bit, e.g. "metadata", and the names of those in a crcErrors mask
+	static const char *CrcSegmentName(int bit);
+	static std::string CrcSegmentList(int crcErrors);
+
+	// Programme channel ch belongs to in program configuration progConfig, -1 if none
+	int GetChannelProgramme(int progConfig, int ch);
+
+	// Position in the data fed, since construction or ResetFeed(), of the preamble of the frame handed to the frame callback
+	uint64_t FedFrameOffset(void);
+
+	// Time each pushed frame's stages into stats, flush the sink after every frame and count frames
+	// written later than a frame period after their last word arrived. While behind, frames whose
+	// metadata is unchanged since the last one written are not serialized. NULL stops accounting
+	void SetRealtimeStats(RealtimeStats *stats);
+
+	// Fill templates from templateSet rather than building the whole document, where
+	// the program configuration has a template. NULL returns to building every frame
+	void SetTemplates(const SadmTemplateSet *templates);
+
+	// Summarise a file from its first frame, parsing only the sync and metadata segments. At most PROBE_MAX_BYTES
+	// are read, whatever the size of the file. Throws if no frame is found. With an offset, the search for
+	// the frame starts there
+	static DolbyEProbe Probe(const std::string &fileName, uint64_t offset = 0);
+
+	// True if timecode is the one after previous at frameRate (a frame_rate_code), or is invalid, as check_time_code()
+	static bool TimeCodeFollows(const int timecode[8], const int previous[8], int frameRate);
+
+	// Hold Xerces initialized until the matching XmlTerminate(), rather than initializing it per frame.
+	// Required before converting from more than one thread
+	static bool XmlInitialize(void);
+	static void XmlTerminate(void);
+
+	std::string GenerateUUID(void);
+	void GenerateUUID(char *uuidText);
+
+	// flowID of the stream, the same for all its frames: random, or with SetDeterministicFlowID() a name based (v5)
+	// UUID of the given namespace and the stream's first metadata segment (which holds its program_config), so that
+	// identical inputs produce identical output whatever they are called, and different inputs do not collide
+	void SetDeterministicFlowID(const std::string &nameSpace);
+
+	const float frame_rates[NUMFRAMERATES] = {(float)23.98, 24, 25, (float)29.97, 30};
+	const int samples_per_frame[NUMFRAMERATES] = {2002, 2000, 1920, 1602, 1600};
+
+	/* table giving the number of frames before turning over to zero in the SMPTE time code for each frame rate */
+	static constexpr short last_frame_tab[NUMFRAMERATES] = {24, 24, 25, 30, 30};
+
+	/* table giving the drop frame flag for each frame rate */
+	static constexpr short drop_frame_tab[NUMFRAMERATES] = {1, 0, 0, 1, 0};
+
+	const char *frame_rts[NUMFRAMERATES] = {"23.98 fps", "24 fps", "25 fps", "29.97 fps", "30 fps"};
+
+	static constexpr int maskSync[nBitDepths] =
+	{   0x0ffff00, 0x0fffff0, 0x0ffffff };
+
+	static constexpr int preambleSyncA[nBitDepths] =
+	{   0x0f87200, 0x06f8720, 0x096f872 };
+
+	static constexpr int preambleSyncB[nBitDepths] =
+	{   0x04e1f00, 0x054e1f0, 0x0a54e1f };
+
+	static constexpr int preambleMode[nBitDepths] =
+	{   0x0000000, 0x0002000, 0x0004000 };
+
+	static constexpr int bitDepthTab[nBitDepths] =
+	{   16, 20, 24 };
+
+	static constexpr int nProgsTab[NPGMCFG] =
+	{   2, 3, 2, 3, 4, 5, 4, 5, 6, 7, 8, 1, 2, 3, 3, 4, 5, 6, 1, 2, 3, 4, 1, 1 };
+
+	static constexpr int nChansTab[NPGMCFG] =
+	{   8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 6, 6, 6, 6, 6, 6, 6, 4, 4, 4, 4, 8, 8 };
+
+	static constexpr int lfeChanTab[NPGMCFG] =
+	{   5, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 5, 5 };
+
+	const char *yesNoText[2] =
+	{   "no", "yes" };
+
+	const char *progConfigText[NPGMCFG] =
+	{   "5.1+2", "5.1+1+1", "4+4", "4+2+2", "4+2+1+1", "4+1+1+1+1", "2+2+2+2",
+	    "2+2+2+1+1", "2+2+1+1+1+1", "2+1+1+1+1+1+1", "1+1+1+1+1+1+1+1",
+	    "5.1", "4+2", "4+1+1", "2+2+2", "2+2+1+1", "2+1+1+1+1", "1+1+1+1+1+1",
+	    "4", "2+2", "2+1+1", "1+1+1+1", "7.1", "7.1 Screen" };
+
+	const char *chanIDText[NPGMCFG][MAX_NCHANS] =
+	{   { "0L", "0C", "0Ls", "1L", "0R", "0LFE", "0Rs", "1R" },
+	    { "0L", "0C", "0Ls", "1C", "0R", "0LFE", "0Rs", "2C" },
+	    { "0L", "0C", "1L", "1C", "0R", "0S", "1R", "1S" },
+	    { "0L", "0C", "1L", "2L", "0R", "0S", "1R", "2R" },
+	    { "0L", "0C", "1L", "2C", "0R", "0S", "1R", "3C" },
+	    { "0L", "0C", "1C", "3C", "0R", "0S", "2C", "4C" },
+	    { "0L", "1L", "2L", "3L", "0R", "1R", "2R", "3R" },
+	    { "0L", "1L", "2L", "3C", "0R", "1R", "2R", "4C" },
+	    { "0L", "1L", "2C", "4C", "0R", "1R", "3C", "5C" },
+	    { "0L", "1C", "3C", "5C", "0R", "2C", "4C", "6C" },
+	    { "0C", "2C", "4C", "6C", "1C", "3C", "5C", "7C" },
+	    { "0L", "0C", "0Ls", "0R", "0LFE", "0Rs", "", "" },
+	    { "0L", "0C", "1L", "0R", "0S", "1R", "", "" },
+	    { "0L", "0C", "1C", "0R", "0S", "2C", "", "" },
+	    { "0L", "1L", "2L", "0R", "1R", "2R", "", "" },
+	    { "0L", "1L", "2C", "0R", "1R", "3C", "", "" },
+	    { "0L", "1C", "3C", "0R", "2C", "4C", "", "" },
+	    { "0C", "2C", "4C", "1C", "3C", "5C", "", "" },
+	    { "0L", "0C", "0R", "0S", "", "", "", "" },
+	    { "0L", "1L", "0R", "1R", "", "", "", "" },
+	    { "0L", "1C", "0R", "2C", "", "", "", "" },
+	    { "0C", "2C", "1C", "3C", "", "", "", "" }, 
+	    { "0L", "0C", "0Ls", "0BLs", "0R", "0LFE", "0Rs", "0BRs" },
+	    { "0L", "0C", "0Ls", "0Le", "0R", "0LFE", "0Rs", "0Re" }};
+
+	const char *frameRateText[NFRMRATE] =
+	{   "23.98 fps", "24 fps", "25 fps", "29.97 fps", "30 fps",
+	    "50 fps", "59.94 fps", "60 fps" };
+
+	const char *timeCodeText[2] =
+	{   "nondrop", "drop" };
+
+	const char *bandwidthIDText[4] =
+	{   "full bandwidth", "half bandwidth", "voice grade", "reserved" };
+
+	const char *bitpoolTypeText[2] =
+	{   "independent", "common" };
+
+	const char *metaSubSegText[16] =
+	{   "none", "AC-3 metadata subsegment xbsi support", 
+	    "AC-3 metadata subsegment no xbsi support", "reserved",
+	    "reserved", "reserved", "reserved", "reserved",
+	    "reserved", "reserved", "reserved", "reserved",
+	    "reserved", "reserved", "reserved", "reserved" };
+
+	const char *groupTypeCodeText[4] =
+	{   "long", "short", "bridge", "reserved" };
+
+	const char *newReuseText[4] =
+	{   "reuse", "new", "stop", "reserved" };
+
+	const char *onOffText[2] =
+	{   "off", "on" };
+
+	const char *AC3datarateText[32] =
+	{   "32 kbps", "40 kbps", "48 kbps", "56 kbps", "64 kbps", "80 kbps",
+	    "96 kbps", "112 kbps", "128 kbps", "160 kbps", "192 kbps", "224 kbps",
+	    "256 kbps", "320 kbps", "384 kbps", "448 kbps", "512 kbps", "576 kbps",
+	    "640 kbps", "reserved", "reserved", "reserved", "reserved", "reserved",
+	    "reserved", "reserved", "reserved", "reserved", "reserved", "reserved",
+	    "reserved", "not specified" };
+
+	const char *AC3bsmodText[9] =
+	{   "complete main", "music and effects", "visually impaired",
+	    "hearing impaired", "dialogue", "commentary", "emergency",
+	    "voice over", "karaoke" };
+
+	const char *AC3acmodText[8] =
+	{   "1+1", "1/0", "2/0", "3/0", "2/1", "3/1", "2/2", "3/2" };
+
+	const char *AC3cmixlevText[4] =
+	{   "-3 dB", "-4.5 dB", "-6 dB", "reserved" };
+
+	const char *AC3surmixlevText[4] =
+	{   "-3 dB", "-6 dB", "-inf dB", "reserved" };
+
+	const char *AC3dsurmodText[4] =
+	{   "not indicated", "NOT Dolby Surround encoded", "Dolby Surround encoded",
+	    "reserved" };
+
+	const char *AC3roomtypText[4] =
+	{   "not indicated", "large room, X curve monitor", "small room, flat monitor",
+	    "reserved" };
+
+	#define NCOMPPRESETS 6
+
+	const char *AC3compPresetText[NCOMPPRESETS] =
+	{       "none", "Film Standard", "Film Light", "Music Standard", "Music Light",
+	    "Speech" };
+
+	const char *AC3dmixmodText[4] = 
+	{      "not indicated", "Lt/Rt downmix preferred", "Lo/Ro downmix preferred",
+	       "reserved" };
+
+	const char *AC3newmixlevText[8] =
+	{      "1.414 (+3.0 dB)", "1.189 (+1.5 dB)", "1.000 ( 0.0 dB)", "0.841 (-1.5 dB)",
+	       "0.707 (-3.0 dB)", "0.595 (-4.5 dB)", "0.500 (-6.0 dB)", "0.000 (-inf dB)"};
+
+	const char *AC3dsurexmodText[4] =
+	{      "not indicated", "NOT Dolby Surround EX encoded", 
+	       "Dolby Surround EX encoded", "reserved"};
+
+	const char *AC3dheadphonmodText[4] =
+	{     "not indicated", "NOT Dolby Headphone encoded",
+	      "Dolby Headphone encoded", "reserved"};
+
+	const char *AC3adconvtyp[2] = 
+	{     "Standard", "HDCD"};
+};
+
+#endif //		_DOLBYE_PARSER_H_
+
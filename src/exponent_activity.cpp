@@ -0,0 +1,232 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "exponent_activity.h"
+#include "dolbye_parser.h"
+
+static std::string DbText(double db)
+{
+	char text[16];
+
+	if (isinf(db))
+	{
+		return("-inf");
+	}
+	snprintf(text, sizeof(text), "%.1f", db);
+	return(text);
+}
+
+/**************************************************************************************************************************************************************/
+ExponentAnalyzer::ExponentAnalyzer(double silenceDb)
+{
+	for (int e = 0 ; e < ACTIVITY_MAX_EXP ; e++)
+	{
+		expPower[e] = pow(4.0, -e);
+	}
+	silencePower = pow(10.0, silenceDb / 10.0);
+	memset(channels, 0, sizeof(channels));
+	memset(sameFrames, 0, sizeof(sameFrames));
+	for (int ch = 0 ; ch < MAX_NCHANS ; ch++)
+	{
+		channels[ch].maxDb = -INFINITY;
+	}
+}
+
+void ExponentAnalyzer::Add(DolbyEParser &parser, const FrameInfoStruct &frameInfo)
+{
+	const ChannelExponentStruct *exps[MAX_NCHANS][2];
+	bool silent[MAX_NCHANS] = { false };
+	bool othersActive = false;
+	int n = std::min(frameInfo.nChans, MAX_NCHANS);
+
+	nChans = std::max(nChans, n);
+	for (int ch = 0 ; ch < n ; ch++)
+	{
+		ActivityChannelStats &stats = channels[ch];
+		double power = 0.0;
+		int count = 0;
+		int minExp = ACTIVITY_MAX_EXP - 1;
+		int topBand = 0;
+
+		// Energy over both halves of the frame, the exponents indexing a power table
+		for (int half = 0 ; half < 2 ; half++)
+		{
+			const ChannelExponentStruct &cep = parser.GetChannelExponents(ch, half);
+			exps[ch][half] = &cep;
+			if (!cep.valid)
+			{
+				continue;
+			}
+			for (int blk = 0 ; blk < cep.blockCount ; blk++)
+			{
+				const int *exponent = cep.exponent[blk];
+				for (int bnd = 0 ; bnd < cep.bandCount[blk] ; bnd++)
+				{
+					power += expPower[std::min(exponent[bnd], ACTIVITY_MAX_EXP - 1)];
+					minExp = std::min(minExp, exponent[bnd]);
+				}
+				count += cep.bandCount[blk];
+				stats.bandCount = std::max(stats.bandCount, cep.bandCount[blk]);
+			}
+		}
+		// Highest band within range of the loudest, in any block
+		for (int half = 0 ; half < 2 ; half++)
+		{
+			const ChannelExponentStruct &cep = *exps[ch][half];
+			for (int blk = 0 ; cep.valid && blk < cep.blockCount ; blk++)
+			{
+				for (int bnd = cep.bandCount[blk] - 1 ; bnd >= topBand ; bnd--)
+				{
+					if (cep.exponent[blk][bnd] <= minExp + ACTIVITY_BAND_RANGE)
+					{
+						topBand = bnd + 1;
+						break;
+					}
+				}
+			}
+		}
+		power = (count > 0) ? power / count : 0.0;
+		silent[ch] = (power < silencePower);
+
+		stats.lfe = stats.lfe || (ch == frameInfo.lfeChan);
+		stats.frames++;
+		stats.powerSum += power;
+		stats.maxDb = std::max(stats.maxDb, (power > 0.0) ? 10.0 * log10(power) : -INFINITY);
+		if (silent[ch])
+		{
+			stats.silentFrames++;
+		}
+		else
+		{
+			stats.topBandSum += topBand;
+			stats.topBandMax = std::max(stats.topBandMax, topBand);
+			stats.narrowFrames += (ch != frameInfo.lfeChan && topBand < ACTIVITY_NARROW_BANDS);
+			othersActive = othersActive || (ch != frameInfo.lfeChan);
+		}
+	}
+
+	// Pairs of channels carrying the same exponents, e.g. dual mono or a channel copied to another
+	for (int a = 0 ; a < n ; a++)
+	{
+		for (int b = a + 1 ; b < n && !silent[a] ; b++)
+		{
+			bool same = !silent[b];
+			for (int half = 0 ; same && half < 2 ; half++)
+			{
+				const ChannelExponentStruct &ea = *exps[a][half];
+				const ChannelExponentStruct &eb = *exps[b][half];
+				same = (ea.valid == eb.valid) && (ea.blockCount == eb.blockCount);
+				for (int blk = 0 ; same && ea.valid && blk < ea.blockCount ; blk++)
+				{
+					same = (ea.bandCount[blk] == eb.bandCount[blk]) &&
+						   (memcmp(ea.exponent[blk], eb.exponent[blk], ea.bandCount[blk] * sizeof(int)) == 0);
+				}
+			}
+			sameFrames[a][b] += same;
+		}
+	}
+	if (frameInfo.lfeChan >= 0 && frameInfo.lfeChan < n)
+	{
+		lfeFrames += othersActive;
+		lfeSilentFrames += (silent[frameInfo.lfeChan] && othersActive);
+	}
+	frames++;
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+double ExponentAnalyzer::MeanDb(int ch) const
+{
+	const ActivityChannelStats &stats = channels[ch];
+	double power = (stats.frames > 0) ? stats.powerSum / stats.frames : 0.0;
+
+	return((power > 0.0) ? 10.0 * log10(power) : -INFINITY);
+}
+
+void ExponentAnalyzer::Print(std::ostream &out, const char *const names[MAX_NCHANS]) const
+{
+	char text[64];
+
+	out << "Levels are approximate: relative, not dBFS, with master exponents applied to bands split evenly between regions"
+		<< std::endl;
+	for (int ch = 0 ; ch < nChans ; ch++)
+	{
+		const ActivityChannelStats &stats = channels[ch];
+		uint64_t active = stats.frames - stats.silentFrames;
+		snprintf(text, sizeof(text), "%.1f", active ? (double)stats.topBandSum / active : 0.0);
+		out << "Channel " << ch << " (" << names[ch] << "): level mean " << DbText(MeanDb(ch)) << " dB, max " << DbText(stats.maxDb)
+			<< " dB, " << stats.silentFrames << " silent of " << stats.frames << " frames, active bands mean " << text << " max "
+			<< stats.topBandMax << " of " << stats.bandCount << std::endl;
+	}
+	for (int ch = 0 ; ch < nChans ; ch++)
+	{
+		const ActivityChannelStats &stats = channels[ch];
+		uint64_t active = stats.frames - stats.silentFrames;
+		if (stats.frames > 0 && stats.silentFrames >= ACTIVITY_SILENT_SHARE * stats.frames)
+		{
+			out << "Silent channel: " << names[ch] << std::endl;
+		}
+		else if (!stats.lfe && active > 0 && stats.narrowFrames >= ACTIVITY_SILENT_SHARE * active)
+		{
+			out << "Band limited channel: " << names[ch] << " has no activity above band " << ACTIVITY_NARROW_BANDS
+				<< ", possibly LFE swapped with it" << std::endl;
+		}
+	}
+	if (lfeFrames > 0 && lfeSilentFrames >= ACTIVITY_SILENT_SHARE * lfeFrames)
+	{
+		out << "Missing LFE: the LFE channel is silent while other channels are not" << std::endl;
+	}
+	for (int a = 0 ; a < nChans ; a++)
+	{
+		for (int b = a + 1 ; b < nChans ; b++)
+		{
+			uint64_t active = std::min(channels[a].frames - channels[a].silentFrames, channels[b].frames - channels[b].silentFrames);
+			if (active > 0 && sameFrames[a][b] >= ACTIVITY_SAME_SHARE * active)
+			{
+				out << "Identical channels: " << names[a] << " and " << names[b] << " in " << sameFrames[a][b]
+					<< " frames, dual mono or a copied channel (polarity is not visible in exponents)" << std::endl;
+			}
+		}
+	}
+}
+/**************************************************************************************************************************************************************/
@@ -0,0 +1,105 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_EXPONENT_ACTIVITY_H_
+#define		_EXPONENT_ACTIVITY_H_
+
+#include <stdint.h>
+#include <vector>
+#include <ostream>
+
+#include "ddeinfo.h"
+
+class DolbyEParser;
+
+#define ACTIVITY_MAX_EXP		64			/* exponents are at most 31 + 3 * 3 */
+#define ACTIVITY_SILENCE_DB		-120.0		/* default level below which a channel's frame is silent */
+#define ACTIVITY_BAND_RANGE		10			/* bands within this many exponents (6 dB each) of the loudest are active */
+#define ACTIVITY_SILENT_SHARE	0.99		/* share of frames silent for a channel to be reported silent */
+#define ACTIVITY_SAME_SHARE		0.9			/* share of frames with identical exponents for a pair to be reported */
+#define ACTIVITY_NARROW_BANDS	10			/* a full range channel whose active bands stop below this looks like LFE */
+
+/* Whole file activity of one channel */
+struct ActivityChannelStats
+{
+	uint64_t frames;
+	uint64_t silentFrames;
+	double powerSum;				/* of each frame's energy estimate, for the mean */
+	double maxDb;
+	uint64_t topBandSum;			/* highest active band + 1, summed over frames not silent */
+	int topBandMax;
+	int bandCount;					/* most bands coded in a block */
+	uint64_t narrowFrames;			/* frames not silent whose active bands stop below ACTIVITY_NARROW_BANDS */
+	bool lfe;
+};
+
+/*	Activity of each channel estimated from the exponents of its channel subsegments, without decoding
+	the audio. An exponent e gives a band's level as roughly 6.02 * e dB below full scale, so a frame's
+	energy estimate is the mean of 4^-e over its blocks and bands, taken from a table. Levels are relative,
+	not calibrated dBFS, and approximate: the band to region boundaries of the master exponents are not
+	known here, so DolbyEParser takes the bands as split evenly between the regions.
+	Needs DolbyEParser::SetExponentCapture() */
+class ExponentAnalyzer
+{
+private:
+	double expPower[ACTIVITY_MAX_EXP];
+	double silencePower;
+	int nChans = 0;
+	uint64_t frames = 0;
+	ActivityChannelStats channels[MAX_NCHANS];
+	uint64_t sameFrames[MAX_NCHANS][MAX_NCHANS];	/* frames in which both channels, not silent, had identical exponents */
+	uint64_t lfeFrames = 0;							/* frames with an LFE channel and another channel not silent */
+	uint64_t lfeSilentFrames = 0;					/* of those, the frames the LFE channel was silent */
+
+public:
+	ExponentAnalyzer(double silenceDb = ACTIVITY_SILENCE_DB);
+
+	// Add the frame parser has just handed to its frame callback
+	void Add(DolbyEParser &parser, const FrameInfoStruct &frameInfo);
+
+	uint64_t FrameCount(void) const { return(frames); }
+	int ChannelCount(void) const { return(nChans); }
+	const ActivityChannelStats &Channel(int ch) const { return(channels[ch]); }
+
+	// Mean energy estimate of channel ch, averaged as power, in dB relative to full scale exponents
+	double MeanDb(int ch) const;
+
+	// Per channel summary, then any silent channel, silent LFE, identical pair or band limited channel found
+	void Print(std::ostream &out, const char *const names[MAX_NCHANS]) const;
+};
+
+#endif //		_EXPONENT_ACTIVITY_H_
@@ -0,0 +1,203 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <algorithm>
+#include <stdexcept>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "follow_reader.h"
+
+/**************************************************************************************************************************************************************/
+FollowReader::FollowReader(const std::string &fileName) :
+	path(fileName), fd(-1), offset(0), inode(0), notifyFd(-1), fileWatch(-1), dirWatch(-1)
+{
+#ifdef __linux__
+	notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (notifyFd >= 0)
+	{
+		// The directory is watched for the file being created again after rotation
+		size_t slash = path.rfind('/');
+		std::string dir = (slash == std::string::npos) ? "." : (slash == 0) ? "/" : path.substr(0, slash);
+		dirWatch = inotify_add_watch(notifyFd, dir.c_str(), IN_CREATE | IN_MOVED_TO);
+	}
+#endif
+	if (!Open())
+	{
+		int err = errno;
+		if (notifyFd >= 0)
+		{
+			close(notifyFd);
+		}
+		throw std::runtime_error("Error: Unable to open " + path + ": " + strerror(err));
+	}
+}
+
+FollowReader::~FollowReader()
+{
+	if (fd >= 0)
+	{
+		close(fd);
+	}
+	if (notifyFd >= 0)
+	{
+		close(notifyFd);
+	}
+}
+
+bool FollowReader::Open(void)
+{
+	struct stat st;
+
+	int newFd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (newFd < 0)
+	{
+		return(false);
+	}
+	if (fstat(newFd, &st) < 0)
+	{
+		close(newFd);
+		return(false);
+	}
+	if (fd >= 0)
+	{
+		close(fd);
+	}
+	fd = newFd;
+	inode = st.st_ino;
+	offset = 0;
+	Watch();
+	return(true);
+}
+
+void FollowReader::Watch(void)
+{
+#ifdef __linux__
+	if (notifyFd >= 0)
+	{
+		if (fileWatch >= 0)
+		{
+			inotify_rm_watch(notifyFd, fileWatch);
+		}
+		fileWatch = inotify_add_watch(notifyFd, path.c_str(), IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+	}
+#endif
+}
+
+// At end of file: start again if the file was truncated or another has taken its name
+bool FollowReader::Reopened(void)
+{
+	struct stat st;
+
+	if (fstat(fd, &st) == 0 && st.st_size < offset)
+	{
+		lseek(fd, 0, SEEK_SET);
+		offset = 0;
+		return(true);
+	}
+	if (stat(path.c_str(), &st) == 0 && st.st_ino != inode)
+	{
+		return(Open());
+	}
+	return(false);
+}
+
+void FollowReader::WaitForChange(int timeoutMs)
+{
+	timeoutMs = std::min(timeoutMs, FOLLOW_POLL_MS);
+	if (notifyFd < 0)
+	{
+		struct timespec ts = { timeoutMs / 1000, (long)(timeoutMs % 1000) * 1000000 };
+		nanosleep(&ts, NULL);
+		return;
+	}
+
+	// Any event means look at the file again, so they are only drained
+	struct pollfd pfd = { notifyFd, POLLIN, 0 };
+	if (poll(&pfd, 1, timeoutMs) > 0)
+	{
+		char events[4096];
+		while (read(notifyFd, events, sizeof(events)) > 0)
+		{
+		}
+	}
+}
+
+size_t FollowReader::Read(uint8_t *buf, size_t len, int timeoutMs, bool &restarted)
+{
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	restarted = false;
+	while (1)
+	{
+		ssize_t n = read(fd, buf, len);
+		if (n > 0)
+		{
+			offset += n;
+			return((size_t)n);
+		}
+		if (n < 0 && errno != EINTR)
+		{
+			throw std::runtime_error("Error: Unable to read " + path + ": " + strerror(errno));
+		}
+		if (n == 0 && Reopened())
+		{
+			restarted = true;
+			continue;
+		}
+
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		long long elapsedMs = (now.tv_sec - start.tv_sec) * 1000LL + (now.tv_nsec - start.tv_nsec) / 1000000;
+		if (elapsedMs >= timeoutMs)
+		{
+			return(0);
+		}
+		WaitForChange(timeoutMs - (int)elapsedMs);
+	}
+}
+/**************************************************************************************************************************************************************/
@@ -0,0 +1,79 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_FOLLOW_READER_H_
+#define		_FOLLOW_READER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <sys/types.h>
+
+#define FOLLOW_POLL_MS		250		/* longest wait without an event before looking at the file again */
+
+/*	Reads a file that is still being written, like tail -F. At end of file Read() waits for the file to grow,
+	woken by inotify on Linux and by polling elsewhere. When the file is truncated, or rotated (renamed or deleted
+	and a new file created under the same name), reading starts again from the beginning of the file now at the path,
+	once everything written to the old one has been read. Errors are reported with std::runtime_error */
+class FollowReader
+{
+private:
+	std::string path;
+	int fd;
+	off_t offset;
+	ino_t inode;
+	int notifyFd;
+	int fileWatch;
+	int dirWatch;
+
+	bool Open(void);
+	void Watch(void);
+	bool Reopened(void);
+	void WaitForChange(int timeoutMs);
+
+public:
+	FollowReader(const std::string &fileName);
+	~FollowReader();
+
+	// Up to len bytes, waiting up to timeoutMs for some; 0 on timeout. restarted is set when the bytes returned
+	// come from the start of a new or truncated file, rather than following on from those before
+	size_t Read(uint8_t *buf, size_t len, int timeoutMs, bool &restarted);
+
+	off_t Offset(void) const { return(offset); }
+};
+
+#endif //		_FOLLOW_READER_H_
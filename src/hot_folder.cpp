@@ -0,0 +1,383 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "hot_folder.h"
+#include "dolbye_parser.h"
+#include "sadm_sink.h"
+#include "json_text.h"
+
+static bool IsDdeName(const std::string &name)
+{
+	// Hidden files are writers' temporaries
+	return(name.size() > 4 && name[0] != '.' && !strcasecmp(name.c_str() + name.size() - 4, ".dde"));
+}
+
+/**************************************************************************************************************************************************************/
+HotFolder::HotFolder(WorkQueue &workQueue, const SadmTemplateSet *templateSet, unsigned int settle, bool useCloseWrite, const std::string &statusFile) :
+	queue(workQueue),
+	templates(templateSet),
+	settleMs(settle),
+	closeWrite(useCloseWrite),
+	statusPath(statusFile),
+	notifyFd(-1)
+{
+#ifdef __linux__
+	notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+	started = Clock::now();
+	lastStatus = started;
+}
+
+HotFolder::~HotFolder()
+{
+	if (notifyFd >= 0)
+	{
+		close(notifyFd);
+	}
+}
+
+void HotFolder::AddFolder(const std::string &dir, const std::string &outDir, unsigned int maxActive)
+{
+	std::unique_ptr<Folder> folder(new Folder);
+	folder->dir = dir;
+	folder->outDir = outDir.empty() ? dir : outDir;
+	folder->maxActive = std::max(maxActive, 1u);
+
+	DIR *d = opendir(dir.c_str());
+	if (d == NULL)
+	{
+		throw std::runtime_error("Error: Unable to open folder " + dir + ": " + strerror(errno));
+	}
+#ifdef __linux__
+	if (notifyFd >= 0)
+	{
+		folder->watch = inotify_add_watch(notifyFd, dir.c_str(), IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_TO);
+	}
+#endif
+	folders.push_back(std::move(folder));
+	closedir(d);
+	Scan(folders.size() - 1);
+}
+
+// Files in the folder not yet converted, or changed since they were
+void HotFolder::Scan(size_t folder)
+{
+	DIR *d = opendir(folders[folder]->dir.c_str());
+	if (d == NULL)
+	{
+		return;
+	}
+	struct dirent *entry;
+	while ((entry = readdir(d)) != NULL)
+	{
+		std::string name = entry->d_name;
+		if (!IsDdeName(name))
+		{
+			continue;
+		}
+		struct stat in, out;
+		std::string path = folders[folder]->dir + "/" + name;
+		std::string outPath = folders[folder]->outDir + "/" + name.substr(0, name.size() - 4) + ".xml";
+		if (stat(path.c_str(), &in) != 0 || (stat(outPath.c_str(), &out) == 0 && out.st_mtime >= in.st_mtime))
+		{
+			continue;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			std::map<std::string, time_t>::iterator it = rejected.find(path);
+			if (it != rejected.end() && it->second == in.st_mtime)
+			{
+				continue;
+			}
+		}
+		Found(folder, name, false);
+	}
+	closedir(d);
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void HotFolder::Found(size_t folder, const std::string &name, bool complete)
+{
+	if (!IsDdeName(name))
+	{
+		return;
+	}
+	std::string path = folders[folder]->dir + "/" + name;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (inProgress.count(path) || (!complete && settling.count(path)))
+		{
+			return;
+		}
+		if (complete)
+		{
+			settling.erase(path);
+			inProgress.insert(path);
+			folders[folder]->ready.push_back(path);
+			return;
+		}
+	}
+	struct stat st;
+	if (stat(path.c_str(), &st) == 0)
+	{
+		settling[path] = { folder, st.st_size, Clock::now() };
+	}
+}
+
+void HotFolder::Events(void)
+{
+#ifdef __linux__
+	alignas(struct inotify_event) char buf[8192];
+	ssize_t n;
+
+	while ((n = read(notifyFd, buf, sizeof(buf))) > 0)
+	{
+		for (char *p = buf ; p < buf + n ; p += sizeof(struct inotify_event) + ((struct inotify_event *)p)->len)
+		{
+			struct inotify_event *event = (struct inotify_event *)p;
+			if (event->len == 0)
+			{
+				continue;
+			}
+			for (size_t i = 0 ; i < folders.size() ; i++)
+			{
+				if (folders[i]->watch == event->wd)
+				{
+					Found(i, event->name, closeWrite && (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)));
+				}
+			}
+		}
+	}
+#endif
+}
+
+void HotFolder::Tick(void)
+{
+	Clock::time_point now = Clock::now();
+
+	// Without events, look for new files each time
+	if (notifyFd < 0)
+	{
+		for (size_t i = 0 ; i < folders.size() ; i++)
+		{
+			Scan(i);
+		}
+	}
+
+	// Files whose size has stayed the same for the settle time are complete
+	for (std::map<std::string, Settling>::iterator it = settling.begin() ; it != settling.end() ; )
+	{
+		struct stat st;
+		if (stat(it->first.c_str(), &st) != 0)
+		{
+			it = settling.erase(it);
+			continue;
+		}
+		if (st.st_size != it->second.size)
+		{
+			it->second.size = st.st_size;
+			it->second.changed = now;
+		}
+		else if (now - it->second.changed >= std::chrono::milliseconds(settleMs))
+		{
+			size_t folder = it->second.folder;
+			std::string path = it->first;
+			it = settling.erase(it);
+			std::lock_guard<std::mutex> lock(mutex);
+			if (inProgress.insert(path).second)
+			{
+				folders[folder]->ready.push_back(path);
+			}
+			continue;
+		}
+		++it;
+	}
+
+	// Start what each folder's limit allows. Submit() waits while the pool's queue is full
+	for (std::unique_ptr<Folder> &f : folders)
+	{
+		Folder *folder = f.get();
+		while (1)
+		{
+			std::string path;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (folder->ready.empty() || folder->active >= folder->maxActive)
+				{
+					break;
+				}
+				path = folder->ready.front();
+				folder->ready.pop_front();
+				folder->active++;
+			}
+			if (!queue.Submit([this, folder, path]() { Convert(folder, path); }))
+			{
+				return;
+			}
+		}
+	}
+
+	if (!statusPath.empty() && now - lastStatus >= std::chrono::milliseconds(HOT_FOLDER_STATUS_MS))
+	{
+		WriteStatus(now);
+	}
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void HotFolder::Convert(Folder *folder, const std::string &path)
+{
+	size_t slash = path.rfind('/');
+	std::string name = path.substr(slash + 1, path.size() - slash - 1 - 4);
+	std::string outPath = folder->outDir + "/" + name + ".xml";
+	std::string tmpPath = folder->outDir + "/." + name + ".xml.tmp";
+	struct stat st = {};
+	bool ok = false;
+
+	try
+	{
+		if (stat(path.c_str(), &st) != 0)
+		{
+			throw std::runtime_error("Error: File not found");
+		}
+		// Only the first frame is converted, so the file is not indexed
+		DolbyEParser parser(path, false);
+		parser.SetTemplates(templates);
+		parser.GetNextFrame();
+		{
+			int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+			if (fd < 0)
+			{
+				throw std::runtime_error("Error: Unable to open " + tmpPath + ": " + strerror(errno));
+			}
+			FdSink sink(fd, true);
+			parser.GenerateSadmXML(sink);
+			sink.Flush();
+		}
+		if (rename(tmpPath.c_str(), outPath.c_str()) != 0)
+		{
+			throw std::runtime_error("Error: Unable to rename " + tmpPath + ": " + strerror(errno));
+		}
+		ok = true;
+	}
+	catch (const std::exception &e)
+	{
+		unlink(tmpPath.c_str());
+		std::cerr << path << ": " << e.what() << std::endl;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	folder->active--;
+	inProgress.erase(path);
+	if (ok)
+	{
+		folder->done++;
+		filesDone++;
+		bytesDone += (uint64_t)st.st_size;
+	}
+	else
+	{
+		folder->failed++;
+		filesFailed++;
+		rejected[path] = st.st_mtime;
+	}
+}
+
+// Throughput over the last interval and since starting, written to a temporary file and renamed into place
+void HotFolder::WriteStatus(Clock::time_point now)
+{
+	char num[64];
+	std::string json;
+	double interval = std::chrono::duration<double>(now - lastStatus).count();
+	double uptime = std::chrono::duration<double>(now - started).count();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	snprintf(num, sizeof(num), "%.1f", uptime);
+	json = "{\"uptime\":" + std::string(num);
+	json += ",\"filesDone\":" + std::to_string(filesDone) + ",\"filesFailed\":" + std::to_string(filesFailed);
+	json += ",\"bytesDone\":" + std::to_string(bytesDone);
+	snprintf(num, sizeof(num), "%.2f", (double)(filesDone - lastFilesDone) / interval);
+	json += ",\"filesPerSec\":" + std::string(num);
+	snprintf(num, sizeof(num), "%.3f", (double)(bytesDone - lastBytesDone) / interval / 1e6);
+	json += ",\"MBPerSec\":" + std::string(num);
+	snprintf(num, sizeof(num), "%.2f", (double)filesDone / uptime);
+	json += ",\"filesPerSecAverage\":" + std::string(num);
+	snprintf(num, sizeof(num), "%.3f", (double)bytesDone / uptime / 1e6);
+	json += ",\"MBPerSecAverage\":" + std::string(num);
+	json += ",\"settling\":" + std::to_string(settling.size()) + ",\"folders\":[";
+	for (size_t i = 0 ; i < folders.size() ; i++)
+	{
+		const Folder &f = *folders[i];
+		json += (i ? ",{" : "{");
+		json += "\"dir\":" + JsonString(f.dir) + ",\"ready\":" + std::to_string(f.ready.size());
+		json += ",\"active\":" + std::to_string(f.active) + ",\"done\":" + std::to_string(f.done);
+		json += ",\"failed\":" + std::to_string(f.failed) + "}";
+	}
+	json += "]}\n";
+	lastStatus = now;
+	lastFilesDone = filesDone;
+	lastBytesDone = bytesDone;
+
+	std::string tmpPath = statusPath + ".tmp";
+	FILE *fp = fopen(tmpPath.c_str(), "w");
+	if (fp != NULL)
+	{
+		bool written = (fwrite(json.data(), 1, json.size(), fp) == json.size());
+		if (fclose(fp) == 0 && written)
+		{
+			rename(tmpPath.c_str(), statusPath.c_str());
+		}
+	}
+}
+/**************************************************************************************************************************************************************/
@@ -0,0 +1,131 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_HOT_FOLDER_H_
+#define		_HOT_FOLDER_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <sys/types.h>
+
+#include "sadm_template.h"
+#include "work_queue.h"
+
+#define HOT_FOLDER_SETTLE_MS		2000	/* default time a file's size must stay the same before it is taken as complete */
+#define HOT_FOLDER_STATUS_MS		1000	/* status file update interval */
+
+/*	Watches folders for .dde files and converts each, as dolbye2sadm infile.dde outfile.xml would, on a WorkQueue.
+	A file is complete when its writer closes it or it is renamed into the folder (if closeWrite is set, and inotify is
+	available), or once its size has not changed for the settle time. Each folder has a limit on the conversions it
+	may have running at once, so a flood into one cannot starve the others. The output is written to a temporary file
+	in the output folder and renamed into place, so name.xml only ever appears complete. Files already converted,
+	with an output newer than the input, are skipped when a folder is added.
+
+	AddFolder(), Events() and Tick() are called from one thread, the one running the daemon's poll loop */
+class HotFolder
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Folder
+	{
+		std::string dir;
+		std::string outDir;
+		unsigned int maxActive;
+		int watch = -1;
+		std::deque<std::string> ready;			/* complete, waiting for a worker */
+		unsigned int active = 0;				/* under mutex, as are the counts */
+		uint64_t done = 0;
+		uint64_t failed = 0;
+	};
+
+	struct Settling
+	{
+		size_t folder;
+		off_t size;
+		Clock::time_point changed;
+	};
+
+	WorkQueue &queue;
+	const SadmTemplateSet *templates;
+	unsigned int settleMs;
+	bool closeWrite;
+	std::string statusPath;
+	int notifyFd;
+
+	std::vector<std::unique_ptr<Folder>> folders;
+	std::map<std::string, Settling> settling;	/* path -> size when last seen changing */
+	std::set<std::string> inProgress;			/* ready or converting, under mutex */
+	std::map<std::string, time_t> rejected;	/* path -> modification time of inputs that failed, under mutex */
+
+	std::mutex mutex;
+	uint64_t filesDone = 0;
+	uint64_t filesFailed = 0;
+	uint64_t bytesDone = 0;
+	Clock::time_point started;
+	Clock::time_point lastStatus;
+	uint64_t lastFilesDone = 0;
+	uint64_t lastBytesDone = 0;
+
+	void Scan(size_t folder);
+	void Found(size_t folder, const std::string &name, bool complete);
+	void Convert(Folder *folder, const std::string &path);
+	void WriteStatus(Clock::time_point now);
+
+public:
+	HotFolder(WorkQueue &workQueue, const SadmTemplateSet *templateSet, unsigned int settle, bool useCloseWrite, const std::string &statusFile);
+	~HotFolder();
+
+	// Watch dir, writing outputs to outDir, with up to maxActive conversions at once
+	void AddFolder(const std::string &dir, const std::string &outDir, unsigned int maxActive);
+
+	// Readable when there are file system events for Events(), -1 if events are not available
+	int EventFd(void) const { return(notifyFd); }
+	void Events(void);
+
+	// Take files whose size has settled, start conversions and update the status file; call every few hundred ms
+	void Tick(void);
+};
+
+#endif //		_HOT_FOLDER_H_
@@ -0,0 +1,142 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include <stdio.h>
+
+#include "latency_histogram.h"
+
+/**************************************************************************************************************************************************************/
+LatencyHistogram::LatencyHistogram(void)
+{
+	Reset();
+}
+
+void LatencyHistogram::Reset(void)
+{
+	memset(counts, 0, sizeof(counts));
+	total = 0;
+	minValue = UINT64_MAX;
+	maxValue = 0;
+	sum = 0.0;
+}
+
+/*	Values below 2^LH_SUB_BUCKET_BITS have a bucket each. Above that a value whose most significant bit is msb
+	is shifted down by msb - (LH_SUB_BUCKET_BITS - 1), leaving LH_SUB_BUCKET_BITS bits with the top one set,
+	and each shift has the LH_SUB_BUCKET_HALF buckets following those of the shift below */
+int LatencyHistogram::BucketIndex(uint64_t value)
+{
+	if (value >= ((uint64_t)1 << LH_MAX_MAGNITUDE))
+	{
+		value = ((uint64_t)1 << LH_MAX_MAGNITUDE) - 1;
+	}
+	if (value < (1 << LH_SUB_BUCKET_BITS))
+	{
+		return((int)value);
+	}
+	int msb = 63;
+	while (!(value >> msb))
+	{
+		msb--;
+	}
+	int shift = msb - (LH_SUB_BUCKET_BITS - 1);
+	return(shift * LH_SUB_BUCKET_HALF + (int)(value >> shift));
+}
+
+// Largest value that falls in bucket index
+uint64_t LatencyHistogram::BucketValue(int index)
+{
+	if (index < (1 << LH_SUB_BUCKET_BITS))
+	{
+		return((uint64_t)index);
+	}
+	int shift = index / LH_SUB_BUCKET_HALF - 1;
+	uint64_t sub = (uint64_t)(index - shift * LH_SUB_BUCKET_HALF);
+	return(((sub + 1) << shift) - 1);
+}
+
+void LatencyHistogram::Record(uint64_t value)
+{
+	counts[BucketIndex(value)]++;
+	total++;
+	sum += (double)value;
+	if (value < minValue)
+	{
+		minValue = value;
+	}
+	if (value > maxValue)
+	{
+		maxValue = value;
+	}
+}
+
+uint64_t LatencyHistogram::ValueAtPercentile(double percentile) const
+{
+	if (total == 0)
+	{
+		return(0);
+	}
+	uint64_t wanted = (uint64_t)((percentile / 100.0) * (double)total + 0.5);
+	if (wanted < 1)
+	{
+		wanted = 1;
+	}
+	uint64_t seen = 0;
+	for (int i = 0 ; i < LH_NBUCKETS ; i++)
+	{
+		seen += counts[i];
+		if (seen >= wanted)
+		{
+			// The bucket bound may overshoot the largest value actually recorded
+			uint64_t value = BucketValue(i);
+			return((value < maxValue) ? value : maxValue);
+		}
+	}
+	return(maxValue);
+}
+
+void LatencyHistogram::Print(std::ostream &out, const char *name) const
+{
+	char line[256];
+
+	snprintf(line, sizeof(line), "%-10s %8llu  min %9.1f  mean %9.1f  p50 %9.1f  p90 %9.1f  p99 %9.1f  p99.9 %9.1f  max %9.1f us",
+		name, (unsigned long long)total, (double)Min() / 1000.0, Mean() / 1000.0,
+		(double)ValueAtPercentile(50.0) / 1000.0, (double)ValueAtPercentile(90.0) / 1000.0,
+		(double)ValueAtPercentile(99.0) / 1000.0, (double)ValueAtPercentile(99.9) / 1000.0, (double)Max() / 1000.0);
+	out << line << std::endl;
+}
+/**************************************************************************************************************************************************************/
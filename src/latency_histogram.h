@@ -0,0 +1,83 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_LATENCY_HISTOGRAM_H_
+#define		_LATENCY_HISTOGRAM_H_
+
+#include <stdint.h>
+#include <ostream>
+
+#define LH_SUB_BUCKET_BITS	6		/* 2^6 sub-buckets per power of two, values within 1/32 (3%) */
+#define LH_MAX_MAGNITUDE	40		/* values up to 2^40 ns (18 minutes), larger ones are clamped */
+
+#define LH_SUB_BUCKET_HALF	(1 << (LH_SUB_BUCKET_BITS - 1))
+#define LH_NBUCKETS			((LH_MAX_MAGNITUDE - LH_SUB_BUCKET_BITS + 3) * LH_SUB_BUCKET_HALF)
+
+/*	Latency histogram in the manner of HdrHistogram: buckets are linear within each power of two,
+	so relative precision is the same at every magnitude and Record() is a few integer operations
+	with no allocation, cheap enough for every frame. Values are in nanoseconds */
+class LatencyHistogram
+{
+private:
+	uint64_t counts[LH_NBUCKETS];
+	uint64_t total;
+	uint64_t minValue;
+	uint64_t maxValue;
+	double sum;
+
+	static int BucketIndex(uint64_t value);
+	static uint64_t BucketValue(int index);
+
+public:
+	LatencyHistogram(void);
+
+	void Record(uint64_t value);
+	void Reset(void);
+
+	uint64_t Count(void) const { return(total); }
+	uint64_t Min(void) const { return(total ? minValue : 0); }
+	uint64_t Max(void) const { return(maxValue); }
+	double Mean(void) const { return(total ? sum / (double)total : 0.0); }
+
+	// Smallest value that percentile % of recorded values do not exceed, to within bucket precision
+	uint64_t ValueAtPercentile(double percentile) const;
+
+	// One line: count, min, mean, 50/90/99/99.9 percentiles and max in microseconds
+	void Print(std::ostream &out, const char *name) const;
+};
+
+#endif //		_LATENCY_HISTOGRAM_H_
@@ -0,0 +1,277 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "metadata_changes.h"
+#include "json_text.h"
+
+#define FRAME_FIELD(f)		{ #f, offsetof(FrameInfoStruct, Metadata.f), FIELD_FRAME, 1 }
+#define PROG_FIELD(s, f)	{ #f, offsetof(FrameInfoStruct, s.f), FIELD_PROGRAMME, MAX_NPGRMS }
+#define CHAN_FIELD(f)		{ #f, offsetof(FrameInfoStruct, Metadata.f), FIELD_CHANNEL, MAX_NCHANS }
+#define SEG_FIELD(f)		{ #f, offsetof(FrameInfoStruct, Metadata.f), FIELD_SEGMENT, MAX_NUMSEGS }
+
+const MetadataField metadataFields[] =
+{
+	FRAME_FIELD(metadata_revision_id),
+	FRAME_FIELD(program_config),
+	FRAME_FIELD(frame_rate_code),
+	FRAME_FIELD(original_frame_rate_code),
+	PROG_FIELD(Metadata, bandwidth_id),
+	CHAN_FIELD(revision_id),
+	CHAN_FIELD(bitpool_type),
+	CHAN_FIELD(begin_gain),
+	CHAN_FIELD(end_gain),
+	SEG_FIELD(metadata_subsegment_id),
+	PROG_FIELD(AC3Metadata, ac3_datarate),
+	PROG_FIELD(AC3Metadata, ac3_bsmod),
+	PROG_FIELD(AC3Metadata, ac3_acmod),
+	PROG_FIELD(AC3Metadata, ac3_cmixlev),
+	PROG_FIELD(AC3Metadata, ac3_surmixlev),
+	PROG_FIELD(AC3Metadata, ac3_dsurmod),
+	PROG_FIELD(AC3Metadata, ac3_lfeon),
+	PROG_FIELD(AC3Metadata, ac3_dialnorm),
+	PROG_FIELD(AC3Metadata, ac3_langcode),
+	PROG_FIELD(AC3Metadata, ac3_langcod),
+	PROG_FIELD(AC3Metadata, ac3_audprodie),
+	PROG_FIELD(AC3Metadata, ac3_mixlevel),
+	PROG_FIELD(AC3Metadata, ac3_roomtyp),
+	PROG_FIELD(AC3Metadata, ac3_copyrightb),
+	PROG_FIELD(AC3Metadata, ac3_origbs),
+	PROG_FIELD(AC3Metadata, ac3_xbsi1e),
+	PROG_FIELD(AC3Metadata, ac3_dmixmod),
+	PROG_FIELD(AC3Metadata, ac3_ltrtcmixlev),
+	PROG_FIELD(AC3Metadata, ac3_ltrtsurmixlev),
+	PROG_FIELD(AC3Metadata, ac3_lorocmixlev),
+	PROG_FIELD(AC3Metadata, ac3_lorosurmixlev),
+	PROG_FIELD(AC3Metadata, ac3_xbsi2e),
+	PROG_FIELD(AC3Metadata, ac3_dsurexmod),
+	PROG_FIELD(AC3Metadata, ac3_dheadphonmod),
+	PROG_FIELD(AC3Metadata, ac3_adconvtyp),
+	PROG_FIELD(AC3Metadata, ac3_xbsi2),
+	PROG_FIELD(AC3Metadata, ac3_encinfo),
+	PROG_FIELD(AC3Metadata, ac3_hpfon),
+	PROG_FIELD(AC3Metadata, ac3_bwlpfon),
+	PROG_FIELD(AC3Metadata, ac3_lfelpfon),
+	PROG_FIELD(AC3Metadata, ac3_sur90on),
+	PROG_FIELD(AC3Metadata, ac3_suratton),
+	PROG_FIELD(AC3Metadata, ac3_rfpremphon),
+	PROG_FIELD(AC3Metadata, ac3_compre),
+	PROG_FIELD(AC3Metadata, ac3_compr1),
+	PROG_FIELD(AC3Metadata, ac3_dynrnge),
+	PROG_FIELD(AC3Metadata, ac3_dynrng1),
+	PROG_FIELD(AC3Metadata, ac3_dynrng2),
+	PROG_FIELD(AC3Metadata, ac3_dynrng3),
+	PROG_FIELD(AC3Metadata, ac3_dynrng4),
+	PROG_FIELD(AC3Metadata, ac3_addbsie),
+	PROG_FIELD(AC3Metadata, ac3_addbsil),
+	PROG_FIELD(AC3Metadata, ac3_timecod1e),
+	PROG_FIELD(AC3Metadata, ac3_timecod2e),
+	PROG_FIELD(AC3MetadataExt, ac3_compr2),
+	PROG_FIELD(AC3MetadataExt, ac3_dynrng5),
+	PROG_FIELD(AC3MetadataExt, ac3_dynrng6),
+	PROG_FIELD(AC3MetadataExt, ac3_dynrng7),
+	PROG_FIELD(AC3MetadataExt, ac3_dynrng8),
+};
+
+const int nMetadataFields = (int)(sizeof(metadataFields) / sizeof(metadataFields[0]));
+
+static const char *scopeKey[] = { NULL, "programme", "channel", "segment" };
+
+int MetadataFieldElements(const FrameInfoStruct &frameInfo, const MetadataField &field)
+{
+	switch (field.scope)
+	{
+		case FIELD_PROGRAMME:
+			return((frameInfo.nProgs < field.count) ? frameInfo.nProgs : field.count);
+		case FIELD_CHANNEL:
+			return((frameInfo.nChans < field.count) ? frameInfo.nChans : field.count);
+		default:
+			return(field.count);
+	}
+}
+
+static void PutLE(uint8_t *p, uint32_t value, int bytes)
+{
+	for (int i = 0 ; i < bytes ; i++)
+	{
+		p[i] = (uint8_t)(value >> (8 * i));
+	}
+}
+
+static void TimecodeBytes(const FrameInfoStruct &frameInfo, uint8_t tc[4])
+{
+	for (int i = 0 ; i < 4 ; i++)
+	{
+		tc[i] = (uint8_t)frameInfo.timecode[2 * i + 1];
+	}
+}
+
+static std::string TimecodeJson(const FrameInfoStruct &frameInfo)
+{
+	uint8_t tc[4];
+	char text[32];
+
+	TimecodeBytes(frameInfo, tc);
+	if ((tc[0] & 0x3f) == 0x3f)
+	{
+		return("null");
+	}
+	snprintf(text, sizeof(text), "\"%02d:%02d:%02d:%02d\"",
+			 (((tc[0] >> 4) & 0x03) * 10) + (tc[0] & 0x0f), (((tc[1] >> 4) & 0x07) * 10) + (tc[1] & 0x0f),
+			 (((tc[2] >> 4) & 0x07) * 10) + (tc[2] & 0x0f), (((tc[3] >> 4) & 0x03) * 10) + (tc[3] & 0x0f));
+	return(text);
+}
+
+/**************************************************************************************************************************************************************/
+MetadataChangeLog::MetadataChangeLog(std::ostream *json, std::ostream *binary) :
+	jsonOut(json),
+	binaryOut(binary)
+{
+	memset(&prev, 0, sizeof(prev));
+	if (binaryOut != NULL)
+	{
+		uint8_t header[8];
+		memcpy(header, CHANGES_MAGIC, 4);
+		PutLE(header + 4, CHANGES_VERSION, 2);
+		PutLE(header + 6, (uint32_t)(nMetadataFields + 1), 2);
+		binaryOut->write((const char *)header, sizeof(header));
+		for (int f = 0 ; f < nMetadataFields ; f++)
+		{
+			binaryOut->write(metadataFields[f].name, strlen(metadataFields[f].name) + 1);
+		}
+		binaryOut->write("description_text", sizeof("description_text"));
+	}
+}
+
+void MetadataChangeLog::Event(uint32_t frameNo, const FrameInfoStruct &frameInfo, int field, int element, bool initial, int oldValue, int newValue)
+{
+	nEvents++;
+	if (jsonOut != NULL)
+	{
+		const MetadataField &mf = metadataFields[field];
+		*jsonOut << "{\"frame\":" << frameNo << ",\"timecode\":" << TimecodeJson(frameInfo) << ",\"field\":\"" << mf.name << "\"";
+		if (scopeKey[mf.scope] != NULL)
+		{
+			*jsonOut << ",\"" << scopeKey[mf.scope] << "\":" << element;
+		}
+		*jsonOut << ",\"old\":";
+		if (initial)
+		{
+			*jsonOut << "null";
+		}
+		else
+		{
+			*jsonOut << oldValue;
+		}
+		*jsonOut << ",\"new\":" << newValue << "}\n";
+	}
+	if (binaryOut != NULL)
+	{
+		uint8_t record[20];
+		PutLE(record, frameNo, 4);
+		TimecodeBytes(frameInfo, record + 4);
+		PutLE(record + 8, (uint32_t)field, 2);
+		record[10] = (uint8_t)element;
+		record[11] = initial ? CHANGES_INITIAL : 0;
+		PutLE(record + 12, (uint32_t)oldValue, 4);
+		PutLE(record + 16, (uint32_t)newValue, 4);
+		binaryOut->write((const char *)record, sizeof(record));
+	}
+}
+
+void MetadataChangeLog::TextEvent(uint32_t frameNo, const FrameInfoStruct &frameInfo, int programme, const std::string &newText)
+{
+	bool initial = !textSeen[programme];
+
+	nEvents++;
+	if (jsonOut != NULL)
+	{
+		*jsonOut << "{\"frame\":" << frameNo << ",\"timecode\":" << TimecodeJson(frameInfo) << ",\"field\":\"description_text\",\"programme\":"
+				 << programme << ",\"old\":" << (initial ? "null" : JsonString(prevText[programme])) << ",\"new\":" << JsonString(newText) << "}\n";
+	}
+	if (binaryOut != NULL)
+	{
+		uint8_t record[20];
+		const std::string &oldText = prevText[programme];
+		PutLE(record, frameNo, 4);
+		TimecodeBytes(frameInfo, record + 4);
+		PutLE(record + 8, (uint32_t)nMetadataFields, 2);
+		record[10] = (uint8_t)programme;
+		record[11] = initial ? CHANGES_INITIAL : 0;
+		PutLE(record + 12, (uint32_t)oldText.size(), 4);
+		PutLE(record + 16, (uint32_t)newText.size(), 4);
+		binaryOut->write((const char *)record, sizeof(record));
+		binaryOut->write(oldText.data(), oldText.size());
+		binaryOut->write(newText.data(), newText.size());
+	}
+	prevText[programme] = newText;
+	textSeen[programme] = true;
+}
+
+// Only the fields in the table are compared, an int at a time, so a frame costs far less than parsing it
+void MetadataChangeLog::Frame(uint32_t frameNo, const FrameInfoStruct &frameInfo, const char *const text[MAX_NPGRMS])
+{
+	for (int f = 0 ; f < nMetadataFields ; f++)
+	{
+		const MetadataField &field = metadataFields[f];
+		int n = MetadataFieldElements(frameInfo, field);
+		int nPrev = first ? 0 : MetadataFieldElements(prev, field);
+		for (int e = 0 ; e < n ; e++)
+		{
+			int oldValue = MetadataFieldValue(prev, field, e);
+			int newValue = MetadataFieldValue(frameInfo, field, e);
+			if (e >= nPrev || oldValue != newValue)
+			{
+				// Programmes and channels new to this frame have no old value
+				Event(frameNo, frameInfo, f, e, (e >= nPrev), oldValue, newValue);
+			}
+		}
+	}
+	// Description text only counts once a whole text has been received, its first is an initial value
+	for (int p = 0 ; p < frameInfo.nProgs && p < MAX_NPGRMS ; p++)
+	{
+		if (text[p] != NULL && (!textSeen[p] || prevText[p] != text[p]))
+		{
+			TextEvent(frameNo, frameInfo, p, text[p]);
+		}
+	}
+	prev = frameInfo;
+	first = false;
+}
+/**************************************************************************************************************************************************************/
@@ -0,0 +1,113 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_METADATA_CHANGES_H_
+#define		_METADATA_CHANGES_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <ostream>
+
+#include "ddeinfo.h"
+
+#define CHANGES_MAGIC		"DDMC"
+#define CHANGES_VERSION		1
+#define CHANGES_INITIAL		0x01	/* record flag: first value seen of the field, element or text, old value not valid */
+
+enum MetadataFieldScope
+{
+	FIELD_FRAME,				/* one value per frame */
+	FIELD_PROGRAMME,			/* one per programme, compared up to nProgs */
+	FIELD_CHANNEL,				/* one per channel, compared up to nChans */
+	FIELD_SEGMENT				/* one per metadata subsegment */
+};
+
+/*	A metadata field of FrameInfoStruct. Sizes, reserved bits, keys, CRCs, frame_count, time code and
+	meters are not in the table as they change from frame to frame without the metadata changing */
+struct MetadataField
+{
+	const char *name;
+	size_t offset;				/* offsetof(FrameInfoStruct, ...) of the first element */
+	MetadataFieldScope scope;
+	int count;					/* elements in the array */
+};
+
+extern const MetadataField metadataFields[];
+extern const int nMetadataFields;
+
+/* Value of element of field in frameInfo */
+inline int MetadataFieldValue(const FrameInfoStruct &frameInfo, const MetadataField &field, int element)
+{
+	return(((const int *)((const char *)&frameInfo + field.offset))[element]);
+}
+
+/* Elements of field in use for frameInfo */
+int MetadataFieldElements(const FrameInfoStruct &frameInfo, const MetadataField &field);
+
+/*	Log of the metadata changes from frame to frame, as JSON Lines and/or a compact binary log.
+
+	Binary log: "DDMC", uint16 version, uint16 number of fields, field names each NUL terminated with
+	"description_text" last, then a 20 byte little-endian record per change:
+		uint32 frame, uint8 time code[4] (SMPTE_time_code bytes 1, 3, 5, 7), uint16 field, uint8 element,
+		uint8 flags, int32 old value, int32 new value
+	For description_text the values are the lengths of the old and new text, which follow the record */
+class MetadataChangeLog
+{
+private:
+	std::ostream *jsonOut;
+	std::ostream *binaryOut;
+	bool first = true;
+	FrameInfoStruct prev;
+	std::string prevText[MAX_NPGRMS];
+	bool textSeen[MAX_NPGRMS] = { false };
+	uint64_t nEvents = 0;
+
+	void Event(uint32_t frameNo, const FrameInfoStruct &frameInfo, int field, int element, bool initial, int oldValue, int newValue);
+	void TextEvent(uint32_t frameNo, const FrameInfoStruct &frameInfo, int programme, const std::string &newText);
+
+public:
+	// Either stream may be NULL
+	MetadataChangeLog(std::ostream *json, std::ostream *binary);
+
+	// Compare a frame with the last, text[] is each programme's description text, NULL if none received
+	void Frame(uint32_t frameNo, const FrameInfoStruct &frameInfo, const char *const text[MAX_NPGRMS]);
+
+	uint64_t EventCount(void) const { return(nEvents); }
+};
+
+#endif //		_METADATA_CHANGES_H_
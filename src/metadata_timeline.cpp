@@ -0,0 +1,366 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <stdexcept>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "metadata_timeline.h"
+#include "metadata_changes.h"
+
+/**************************************************************************************************************************************************************/
+// The file is little-endian. On a big-endian host each field is reversed on writing and again after reading, the
+// same Swap() converting either way
+static bool BigEndianHost(void)
+{
+	const uint16_t one = 1;
+	return(*(const uint8_t *)&one == 0);
+}
+
+template <typename T> static void Swap(T &field)
+{
+	uint8_t *p = (uint8_t *)&field;
+	std::reverse(p, p + sizeof(T));
+}
+
+static void Swap(TimelineHeader &header)
+{
+	Swap(header.version);
+	Swap(header.frames);
+	Swap(header.nColumns);
+	Swap(header.nTimecodeRuns);
+	Swap(header.frameRate);
+	Swap(header.columnsOffset);
+}
+
+static void Swap(TimecodeRun &run)
+{
+	Swap(run.offset);
+	Swap(run.stride);
+	Swap(run.firstFrame);
+	Swap(run.count);
+	Swap(run.firstTimecode);
+}
+
+static void Swap(TimelineColumn &column)
+{
+	Swap(column.element);
+	Swap(column.reserved);
+	Swap(column.nRuns);
+	Swap(column.runsOffset);
+}
+
+static void Swap(TimelineRunEntry &entry)
+{
+	Swap(entry.firstFrame);
+	Swap(entry.value);
+}
+
+template <typename T> static void Swap(T *items, size_t count)
+{
+	for (size_t i = 0 ; i < count ; i++)
+	{
+		Swap(items[i]);
+	}
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+TimelineWriter::TimelineWriter(void)
+{
+	for (int f = 0 ; f < nMetadataFields ; f++)
+	{
+		for (int e = 0 ; e < metadataFields[f].count ; e++)
+		{
+			columns.push_back({ metadataFields[f].name, e, metadataFields[f].offset, {} });
+		}
+	}
+	for (int ch = 0 ; ch < MAX_NCHANS ; ch++)
+	{
+		columns.push_back({ "peak_meter", ch, offsetof(FrameInfoStruct, Meter.peak_meter), {} });
+	}
+	for (int ch = 0 ; ch < MAX_NCHANS ; ch++)
+	{
+		columns.push_back({ "rms_meter", ch, offsetof(FrameInfoStruct, Meter.rms_meter), {} });
+	}
+}
+
+void TimelineWriter::Add(uint64_t offset, const FrameInfoStruct &frameInfo)
+{
+	for (Column &column : columns)
+	{
+		int32_t value = ((const int *)((const char *)&frameInfo + column.offset))[column.element];
+		if (column.runs.empty() || column.runs.back().value != value)
+		{
+			column.runs.push_back({ frames, value });
+		}
+	}
+	index.Add(offset, frameInfo.timecode, frameInfo.frameRate);
+	frames++;
+}
+
+void TimelineWriter::Write(const std::string &fileName)
+{
+	index.Finish();
+
+	std::vector<TimecodeRun> timecodeRuns = index.Runs();
+	TimelineHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, TIMELINE_MAGIC, sizeof(header.magic));
+	header.version = TIMELINE_VERSION;
+	header.frames = frames;
+	header.nColumns = (uint32_t)columns.size();
+	header.nTimecodeRuns = (uint32_t)timecodeRuns.size();
+	header.frameRate = index.FrameRate();
+	header.columnsOffset = sizeof(header) + timecodeRuns.size() * sizeof(TimecodeRun);
+
+	std::vector<TimelineColumn> directory(columns.size());
+	uint64_t runsOffset = header.columnsOffset + directory.size() * sizeof(TimelineColumn);
+	for (size_t c = 0 ; c < columns.size() ; c++)
+	{
+		memset(&directory[c], 0, sizeof(TimelineColumn));
+		strncpy(directory[c].name, columns[c].name.c_str(), TIMELINE_NAME_SZ - 1);
+		directory[c].element = (uint16_t)columns[c].element;
+		directory[c].nRuns = (uint32_t)columns[c].runs.size();
+		directory[c].runsOffset = runsOffset;
+		runsOffset += columns[c].runs.size() * sizeof(TimelineRunEntry);
+	}
+
+	bool swap = BigEndianHost();
+	if (swap)
+	{
+		Swap(header);
+		Swap(timecodeRuns.data(), timecodeRuns.size());
+		Swap(directory.data(), directory.size());
+	}
+
+	FILE *fp = fopen(fileName.c_str(), "wb");
+	if (fp == NULL)
+	{
+		throw std::runtime_error("Error: Unable to open " + fileName);
+	}
+	bool ok = (fwrite(&header, sizeof(header), 1, fp) == 1) &&
+			  (fwrite(timecodeRuns.data(), sizeof(TimecodeRun), timecodeRuns.size(), fp) == timecodeRuns.size()) &&
+			  (fwrite(directory.data(), sizeof(TimelineColumn), directory.size(), fp) == directory.size());
+	for (size_t c = 0 ; ok && c < columns.size() ; c++)
+	{
+		std::vector<TimelineRunEntry> runs = columns[c].runs;
+		if (swap)
+		{
+			Swap(runs.data(), runs.size());
+		}
+		ok = (fwrite(runs.data(), sizeof(TimelineRunEntry), runs.size(), fp) == runs.size());
+	}
+	if (fclose(fp) != 0 || !ok)
+	{
+		throw std::runtime_error("Error: Unable to write " + fileName);
+	}
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+TimelineFile::TimelineFile(const std::string &fileName)
+{
+#ifndef _WIN32
+	int fd = open(fileName.c_str(), O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) != 0)
+	{
+		if (fd >= 0)
+		{
+			close(fd);
+		}
+		throw std::runtime_error("Error: Unable to open " + fileName);
+	}
+	size = (size_t)st.st_size;
+	if (size > 0)
+	{
+		void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+		if (map == MAP_FAILED)
+		{
+			close(fd);
+			throw std::runtime_error("Error: Unable to map " + fileName);
+		}
+		data = (const uint8_t *)map;
+	}
+	close(fd);
+	if (BigEndianHost() && size > 0)
+	{
+		// Converted to host order in a copy, as the mapping is read only
+		std::vector<uint8_t> copy(data, data + size);
+		Unmap();
+		buffer.swap(copy);
+		data = buffer.data();
+	}
+#else
+	FILE *fp = fopen(fileName.c_str(), "rb");
+	if (fp == NULL)
+	{
+		throw std::runtime_error("Error: Unable to open " + fileName);
+	}
+	uint8_t block[65536];
+	size_t len;
+	while ((len = fread(block, 1, sizeof(block), fp)) > 0)
+	{
+		buffer.insert(buffer.end(), block, block + len);
+	}
+	fclose(fp);
+	data = buffer.data();
+	size = buffer.size();
+#endif
+
+	// Check every section lies within the file before anything is looked up, converting each to host order on a
+	// big-endian host once it is known to be there
+	bool swap = BigEndianHost();
+	header = (const TimelineHeader *)data;
+	bool valid = (size >= sizeof(TimelineHeader)) && (memcmp(header->magic, TIMELINE_MAGIC, sizeof(header->magic)) == 0);
+	if (valid && swap)
+	{
+		Swap(*(TimelineHeader *)buffer.data());
+	}
+	valid = valid && (header->version == TIMELINE_VERSION) &&
+			(header->columnsOffset == sizeof(TimelineHeader) + (uint64_t)header->nTimecodeRuns * sizeof(TimecodeRun)) &&
+			(header->columnsOffset + (uint64_t)header->nColumns * sizeof(TimelineColumn) <= size);
+	if (valid)
+	{
+		columns = (const TimelineColumn *)(data + header->columnsOffset);
+		if (swap)
+		{
+			Swap((TimecodeRun *)(buffer.data() + sizeof(TimelineHeader)), header->nTimecodeRuns);
+			Swap((TimelineColumn *)(buffer.data() + header->columnsOffset), header->nColumns);
+		}
+		for (uint32_t c = 0 ; valid && c < header->nColumns ; c++)
+		{
+			valid = (columns[c].runsOffset % sizeof(TimelineRunEntry) == 0) &&
+					(columns[c].runsOffset + (uint64_t)columns[c].nRuns * sizeof(TimelineRunEntry) <= size);
+			if (valid && swap)
+			{
+				Swap((TimelineRunEntry *)(buffer.data() + columns[c].runsOffset), columns[c].nRuns);
+			}
+			valid = valid && ((columns[c].nRuns > 0) == (header->frames > 0)) && (columns[c].nRuns == 0 || Runs((int)c)[0].firstFrame == 0) &&
+					(memchr(columns[c].name, '\0', TIMELINE_NAME_SZ) != NULL);
+		}
+		const TimecodeRun *timecodeRuns = (const TimecodeRun *)(data + sizeof(TimelineHeader));
+		uint32_t n = header->nTimecodeRuns;
+		valid = valid && ((n > 0) == (header->frames > 0)) &&
+				(n == 0 || (timecodeRuns[0].firstFrame == 0 && timecodeRuns[n - 1].firstFrame + timecodeRuns[n - 1].count == header->frames));
+	}
+	if (!valid)
+	{
+		Unmap();
+		throw std::runtime_error("Error: " + fileName + " is not a metadata timeline");
+	}
+	index.Load((const TimecodeRun *)(data + sizeof(TimelineHeader)), header->nTimecodeRuns, header->frameRate);
+}
+
+TimelineFile::~TimelineFile(void)
+{
+	Unmap();
+}
+
+void TimelineFile::Unmap(void)
+{
+#ifndef _WIN32
+	if (data != NULL && buffer.empty())
+	{
+		munmap((void *)data, size);
+	}
+#endif
+	data = NULL;
+}
+
+const TimelineRunEntry *TimelineFile::Runs(int column) const
+{
+	return((const TimelineRunEntry *)(data + columns[column].runsOffset));
+}
+
+int TimelineFile::FindColumn(const char *field, int element) const
+{
+	for (uint32_t c = 0 ; c < header->nColumns ; c++)
+	{
+		if (columns[c].element == element && strcmp(columns[c].name, field) == 0)
+		{
+			return((int)c);
+		}
+	}
+	return(-1);
+}
+
+bool TimelineFile::ValueAt(int column, uint32_t frameNo, int32_t &value) const
+{
+	if (column < 0 || column >= (int)header->nColumns || frameNo >= header->frames)
+	{
+		return(false);
+	}
+	const TimelineRunEntry *runs = Runs(column);
+	const TimelineRunEntry *run = std::upper_bound(runs, runs + columns[column].nRuns, frameNo,
+		[](uint32_t frame, const TimelineRunEntry &r) { return(frame < r.firstFrame); }) - 1;
+	value = run->value;
+	return(true);
+}
+
+std::vector<TimelineSpan> TimelineFile::Spans(int column, const std::function<bool(int32_t)> &match) const
+{
+	std::vector<TimelineSpan> spans;
+
+	if (column < 0 || column >= (int)header->nColumns)
+	{
+		return(spans);
+	}
+	const TimelineRunEntry *runs = Runs(column);
+	uint32_t nRuns = columns[column].nRuns;
+	for (uint32_t r = 0 ; r < nRuns ; r++)
+	{
+		if (match(runs[r].value))
+		{
+			uint32_t end = (r + 1 < nRuns) ? runs[r + 1].firstFrame : header->frames;
+			spans.push_back({ runs[r].firstFrame, end - runs[r].firstFrame, runs[r].value });
+		}
+	}
+	return(spans);
+}
+/**************************************************************************************************************************************************************/
@@ -0,0 +1,164 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_METADATA_TIMELINE_H_
+#define		_METADATA_TIMELINE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "ddeinfo.h"
+#include "timecode_index.h"
+
+#define TIMELINE_MAGIC		"DDTL"
+#define TIMELINE_VERSION	1
+#define TIMELINE_NAME_SZ	32
+
+/*	Timeline file, little-endian with each section 8 byte aligned, so it is used in place once mapped (on a big-endian
+	host it is read into memory and converted):
+		TimelineHeader
+		TimecodeRun[nTimecodeRuns]			frame offsets and time codes, as TimecodeIndex::Runs()
+		TimelineColumn[nColumns]
+		TimelineRunEntry[]					each column's runs, in frame order
+	A column holds one element of a field (one programme's ac3_dialnorm, one channel's peak_meter) as runs of
+	frames with the same value, so metadata that seldom changes costs a few bytes for a whole recording */
+struct TimelineHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t frames;
+	uint32_t nColumns;
+	uint32_t nTimecodeRuns;
+	int32_t frameRate;				/* frame_rate_code of the time codes */
+	uint64_t columnsOffset;			/* of the TimelineColumn array, the time code runs follow the header */
+};
+
+struct TimelineColumn
+{
+	char name[TIMELINE_NAME_SZ];	/* field name, NUL terminated */
+	uint16_t element;				/* programme, channel or subsegment, 0 for per frame fields */
+	uint16_t reserved;
+	uint32_t nRuns;
+	uint64_t runsOffset;
+};
+
+struct TimelineRunEntry
+{
+	uint32_t firstFrame;
+	int32_t value;
+};
+
+/* Frames in which a column holds a value */
+struct TimelineSpan
+{
+	uint32_t firstFrame;
+	uint32_t count;
+	int32_t value;
+};
+
+/* Builds a timeline from frames in file order */
+class TimelineWriter
+{
+private:
+	struct Column
+	{
+		std::string name;
+		int element;
+		size_t offset;				/* in FrameInfoStruct */
+		std::vector<TimelineRunEntry> runs;
+	};
+
+	std::vector<Column> columns;
+	TimecodeIndex index;
+	uint32_t frames = 0;
+
+public:
+	// Columns for each element of the fields in metadataFields[], and the peak and RMS meters of each channel
+	TimelineWriter(void);
+
+	// Add the next frame, whose preamble is at offset in the .dde file
+	void Add(uint64_t offset, const FrameInfoStruct &frameInfo);
+
+	uint32_t FrameCount(void) const { return(frames); }
+
+	// Write the timeline, throwing if it cannot be written
+	void Write(const std::string &fileName);
+};
+
+/*	A timeline file, mapped read only. Values are looked up by a binary search of a column's runs, and
+	time codes through a TimecodeIndex of the saved time code runs */
+class TimelineFile
+{
+private:
+	const uint8_t *data = nullptr;
+	size_t size = 0;
+	std::vector<uint8_t> buffer;	/* the file's contents where it cannot be mapped */
+	const TimelineHeader *header = nullptr;
+	const TimelineColumn *columns = nullptr;
+	TimecodeIndex index;
+
+	const TimelineRunEntry *Runs(int column) const;
+	void Unmap(void);
+
+public:
+	// Throws if the file cannot be read or is not a timeline
+	TimelineFile(const std::string &fileName);
+	~TimelineFile(void);
+
+	TimelineFile(const TimelineFile &) = delete;
+	TimelineFile &operator=(const TimelineFile &) = delete;
+
+	uint32_t FrameCount(void) const { return(header->frames); }
+	int FrameRate(void) const { return(header->frameRate); }
+	int ColumnCount(void) const { return((int)header->nColumns); }
+	const TimelineColumn &Column(int column) const { return(columns[column]); }
+	const TimecodeIndex &Timecodes(void) const { return(index); }
+
+	// Index of the column for element of field, -1 if there is none
+	int FindColumn(const char *field, int element) const;
+
+	// Value of column at frameNo. Returns false if there is no such frame
+	bool ValueAt(int column, uint32_t frameNo, int32_t &value) const;
+
+	// Runs of column whose value matches, in frame order
+	std::vector<TimelineSpan> Spans(int column, const std::function<bool(int32_t)> &match) const;
+};
+
+#endif //		_METADATA_TIMELINE_H_
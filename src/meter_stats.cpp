@@ -0,0 +1,287 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "meter_stats.h"
+#include "timecode_index.h"
+
+static std::string DbText(double db)
+{
+	char text[16];
+
+	if (isinf(db))
+	{
+		return("-inf");
+	}
+	snprintf(text, sizeof(text), "%.1f", db);
+	return(text);
+}
+
+/**************************************************************************************************************************************************************/
+MeterAnalyzer::MeterAnalyzer(double silenceDb)
+{
+	for (int code = 0 ; code < METER_CODES ; code++)
+	{
+		codeDb[code] = (code == 0) ? -INFINITY : (float)(-(METER_ZERO_DB - code) * METER_DB_STEP);
+		codePower[code] = (code == 0) ? 0.0 : pow(10.0, codeDb[code] / 10.0);
+	}
+	silenceCode = std::max(0, std::min(METER_CODES - 1, METER_ZERO_DB + (int)floor(silenceDb / METER_DB_STEP)));
+	memset(channels, 0, sizeof(channels));
+	for (int ch = 0 ; ch < MAX_NCHANS ; ch++)
+	{
+		silenceStart[ch] = UINT64_MAX;
+		clipStart[ch] = UINT64_MAX;
+	}
+	StartWindow(second, -1);
+	StartWindow(minute, -1);
+}
+
+void MeterAnalyzer::StartWindow(Window &window, int32_t timecode)
+{
+	memset(&window, 0, sizeof(window));
+	window.firstFrame = frames;
+	window.timecode = timecode;
+}
+
+void MeterAnalyzer::CloseWindow(Window &window, std::vector<MeterRollup> &rollups)
+{
+	MeterRollup rollup;
+
+	if (window.frames == 0)
+	{
+		return;
+	}
+	memset(&rollup, 0, sizeof(rollup));
+	rollup.firstFrame = window.firstFrame;
+	rollup.frames = window.frames;
+	rollup.timecode = window.timecode;
+	rollup.nChans = nChans;
+	for (int ch = 0 ; ch < MAX_NCHANS ; ch++)
+	{
+		double power = window.rmsPower[ch] / window.frames;
+		rollup.peakMax[ch] = codeDb[window.peakMax[ch]];
+		rollup.rmsMax[ch] = codeDb[window.rmsMax[ch]];
+		rollup.rmsMean[ch] = (power > 0.0) ? (float)(10.0 * log10(power)) : -INFINITY;
+	}
+	rollups.push_back(rollup);
+}
+
+void MeterAnalyzer::CloseSpans(int ch, bool silent, bool clipped)
+{
+	// Silence shorter than a second is a pause, not a dead channel
+	if (!silent && silenceStart[ch] != UINT64_MAX)
+	{
+		if (frames - silenceStart[ch] >= (uint64_t)std::max(fps, 1))
+		{
+			spans.push_back({ METER_SILENCE, ch, silenceStart[ch], frames - silenceStart[ch], silenceTimecode[ch] });
+		}
+		silenceStart[ch] = UINT64_MAX;
+	}
+	if (!clipped && clipStart[ch] != UINT64_MAX)
+	{
+		spans.push_back({ METER_CLIPPING, ch, clipStart[ch], frames - clipStart[ch], clipTimecode[ch] });
+		clipStart[ch] = UINT64_MAX;
+	}
+}
+
+void MeterAnalyzer::Add(const FrameInfoStruct &frameInfo)
+{
+	int32_t timecode = TimecodeIndex::TimecodeFrames(frameInfo.timecode, frameInfo.frameRate);
+	int n = std::min(frameInfo.nChans, MAX_NCHANS);
+	int peak[MAX_NCHANS] = { 0 };
+	int rms[MAX_NCHANS] = { 0 };
+
+	if (fps == 0)
+	{
+		frameRate = frameInfo.frameRate;
+		fps = std::max(TimecodeIndex::TimecodeFps(frameRate), 1);
+	}
+	nChans = std::max(nChans, n);
+	if (second.frames == 0)
+	{
+		second.timecode = timecode;
+	}
+	if (minute.frames == 0)
+	{
+		minute.timecode = timecode;
+	}
+	for (int ch = 0 ; ch < n ; ch++)
+	{
+		peak[ch] = frameInfo.Meter.peak_meter[ch] & (METER_CODES - 1);
+		rms[ch] = frameInfo.Meter.rms_meter[ch] & (METER_CODES - 1);
+	}
+
+	// Fixed width, branch free reductions over the channels
+	for (int ch = 0 ; ch < MAX_NCHANS ; ch++)
+	{
+		second.peakMax[ch] = std::max(second.peakMax[ch], peak[ch]);
+		second.rmsMax[ch] = std::max(second.rmsMax[ch], rms[ch]);
+		second.rmsPower[ch] += codePower[rms[ch]];
+		minute.peakMax[ch] = std::max(minute.peakMax[ch], peak[ch]);
+		minute.rmsMax[ch] = std::max(minute.rmsMax[ch], rms[ch]);
+		minute.rmsPower[ch] += codePower[rms[ch]];
+	}
+	second.frames++;
+	minute.frames++;
+
+	for (int ch = 0 ; ch < n ; ch++)
+	{
+		MeterChannelStats &stats = channels[ch];
+		bool silent = (peak[ch] <= silenceCode);
+		bool clipped = (peak[ch] > METER_ZERO_DB);
+
+		stats.frames++;
+		stats.peakHistogram[peak[ch]]++;
+		stats.peakMax = std::max(stats.peakMax, peak[ch]);
+		stats.rmsMax = std::max(stats.rmsMax, rms[ch]);
+		stats.rmsPowerSum += codePower[rms[ch]];
+		stats.silentFrames += silent;
+		stats.clippedFrames += clipped;
+
+		CloseSpans(ch, silent, clipped);
+		if (silent && silenceStart[ch] == UINT64_MAX)
+		{
+			silenceStart[ch] = frames;
+			silenceTimecode[ch] = timecode;
+		}
+		if (clipped && clipStart[ch] == UINT64_MAX)
+		{
+			clipStart[ch] = frames;
+			clipTimecode[ch] = timecode;
+		}
+	}
+	// Channels the program configuration no longer has end their spans
+	for (int ch = n ; ch < MAX_NCHANS ; ch++)
+	{
+		CloseSpans(ch, false, false);
+	}
+	frames++;
+
+	if (second.frames == (uint32_t)fps)
+	{
+		CloseWindow(second, seconds);
+		StartWindow(second, -1);
+	}
+	if (minute.frames == (uint32_t)(60 * fps))
+	{
+		CloseWindow(minute, minutes);
+		StartWindow(minute, -1);
+	}
+}
+
+void MeterAnalyzer::Finish(void)
+{
+	for (int ch = 0 ; ch < MAX_NCHANS ; ch++)
+	{
+		CloseSpans(ch, false, false);
+	}
+	std::sort(spans.begin(), spans.end(), [](const MeterSpan &a, const MeterSpan &b)
+		{ return((a.firstFrame != b.firstFrame) ? (a.firstFrame < b.firstFrame) : (a.channel < b.channel)); });
+	CloseWindow(second, seconds);
+	StartWindow(second, -1);
+	CloseWindow(minute, minutes);
+	StartWindow(minute, -1);
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+double MeterAnalyzer::PeakPercentile(int ch, double percent) const
+{
+	const MeterChannelStats &stats = channels[ch];
+	uint64_t target = (uint64_t)ceil(stats.frames * percent / 100.0);
+	uint64_t count = 0;
+
+	for (int code = 0 ; code < METER_CODES ; code++)
+	{
+		count += stats.peakHistogram[code];
+		if (count > 0 && count >= target)
+		{
+			return(codeDb[code]);
+		}
+	}
+	return(-INFINITY);
+}
+
+double MeterAnalyzer::RmsMeanDb(int ch) const
+{
+	const MeterChannelStats &stats = channels[ch];
+	double power = (stats.frames > 0) ? stats.rmsPowerSum / stats.frames : 0.0;
+
+	return((power > 0.0) ? 10.0 * log10(power) : -INFINITY);
+}
+
+void MeterAnalyzer::Print(std::ostream &out, const char *const names[MAX_NCHANS], const std::vector<MeterRollup> *rollups) const
+{
+	static const char *spanText[] = { "Silence", "Clipping" };
+
+	for (int ch = 0 ; ch < nChans ; ch++)
+	{
+		const MeterChannelStats &stats = channels[ch];
+		out << "Channel " << ch << " (" << names[ch] << "): peak max " << DbText(codeDb[stats.peakMax]) << " dB, 95% "
+			<< DbText(PeakPercentile(ch, 95.0)) << " dB, 99% " << DbText(PeakPercentile(ch, 99.0)) << " dB, RMS mean "
+			<< DbText(RmsMeanDb(ch)) << " dB, max " << DbText(codeDb[stats.rmsMax]) << " dB, " << stats.silentFrames << " silent, "
+			<< stats.clippedFrames << " clipped of " << stats.frames << " frames" << std::endl;
+	}
+	for (const MeterSpan &span : spans)
+	{
+		out << spanText[span.type] << " " << names[span.channel] << ": frames " << span.firstFrame << " to " << span.firstFrame + span.frames - 1
+			<< " from " << TimecodeIndex::TimecodeText(span.timecode, frameRate) << ", " << span.frames << " frames" << std::endl;
+	}
+	if (rollups != NULL)
+	{
+		for (const MeterRollup &rollup : *rollups)
+		{
+			out << TimecodeIndex::TimecodeText(rollup.timecode, frameRate) << " frame " << rollup.firstFrame << " peak";
+			for (int ch = 0 ; ch < rollup.nChans ; ch++)
+			{
+				out << " " << DbText(rollup.peakMax[ch]);
+			}
+			out << " rms";
+			for (int ch = 0 ; ch < rollup.nChans ; ch++)
+			{
+				out << " " << DbText(rollup.rmsMean[ch]) << "/" << DbText(rollup.rmsMax[ch]);
+			}
+			out << std::endl;
+		}
+	}
+}
+/**************************************************************************************************************************************************************/
@@ -0,0 +1,156 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_METER_STATS_H_
+#define		_METER_STATS_H_
+
+#include <stdint.h>
+#include <vector>
+#include <ostream>
+
+#include "ddeinfo.h"
+
+#define METER_CODES			1024		/* 10 bit peak_meter and rms_meter values */
+#define METER_ZERO_DB		0x3c0		/* code of 0 dBFS, each code below is METER_DB_STEP less */
+#define METER_DB_STEP		0.094
+#define METER_SILENCE_DB	-70.0		/* default level a channel's peak stays below to count as silent */
+
+enum MeterSpanType
+{
+	METER_SILENCE,				/* peak at or below the silence level for at least a second */
+	METER_CLIPPING				/* peak above 0 dBFS */
+};
+
+struct MeterSpan
+{
+	MeterSpanType type;
+	int channel;
+	uint64_t firstFrame;
+	uint64_t frames;
+	int32_t timecode;			/* of the first frame, frames since midnight, -1 if invalid */
+};
+
+/* Whole file statistics of one channel */
+struct MeterChannelStats
+{
+	uint64_t frames;
+	uint64_t peakHistogram[METER_CODES];
+	int peakMax;				/* codes */
+	int rmsMax;
+	double rmsPowerSum;			/* sum of the RMS levels as power, for the mean */
+	uint64_t silentFrames;
+	uint64_t clippedFrames;
+};
+
+/* Statistics of a second or a minute of frames, in dBFS */
+struct MeterRollup
+{
+	uint64_t firstFrame;
+	uint32_t frames;
+	int32_t timecode;			/* of the first frame, frames since midnight, -1 if invalid */
+	int nChans;
+	float peakMax[MAX_NCHANS];
+	float rmsMean[MAX_NCHANS];
+	float rmsMax[MAX_NCHANS];
+};
+
+/*	Per channel statistics of the meter segment's peak and RMS levels over a file, with per second and per
+	minute rollups and spans of silence and clipping. Levels are reduced as codes, a fixed MAX_NCHANS wide
+	per frame, and converted to dBFS by table, so the cost is small beside parsing the frame */
+class MeterAnalyzer
+{
+private:
+	struct Window
+	{
+		uint64_t firstFrame;
+		uint32_t frames;
+		int32_t timecode;
+		int peakMax[MAX_NCHANS];
+		int rmsMax[MAX_NCHANS];
+		double rmsPower[MAX_NCHANS];
+	};
+
+	float codeDb[METER_CODES];
+	double codePower[METER_CODES];
+	int silenceCode;
+	int nChans = 0;
+	int frameRate = 0;			/* of the first frame, which sets the rollups' length */
+	int fps = 0;
+	uint64_t frames = 0;
+	MeterChannelStats channels[MAX_NCHANS];
+	Window second;
+	Window minute;
+	std::vector<MeterRollup> seconds;
+	std::vector<MeterRollup> minutes;
+	uint64_t silenceStart[MAX_NCHANS];		/* frame each run of silent or clipped frames started, UINT64_MAX if none */
+	uint64_t clipStart[MAX_NCHANS];
+	int32_t silenceTimecode[MAX_NCHANS];
+	int32_t clipTimecode[MAX_NCHANS];
+	std::vector<MeterSpan> spans;
+
+	void StartWindow(Window &window, int32_t timecode);
+	void CloseWindow(Window &window, std::vector<MeterRollup> &rollups);
+	void CloseSpans(int ch, bool silent, bool clipped);
+
+public:
+	MeterAnalyzer(double silenceDb = METER_SILENCE_DB);
+
+	// Add the next frame's meters, then Finish() once all are added
+	void Add(const FrameInfoStruct &frameInfo);
+	void Finish(void);
+
+	uint64_t FrameCount(void) const { return(frames); }
+	int ChannelCount(void) const { return(nChans); }
+	const MeterChannelStats &Channel(int ch) const { return(channels[ch]); }
+	const std::vector<MeterRollup> &Seconds(void) const { return(seconds); }
+	const std::vector<MeterRollup> &Minutes(void) const { return(minutes); }
+	const std::vector<MeterSpan> &Spans(void) const { return(spans); }
+
+	// Level of a meter code in dBFS, -inf for 0
+	double CodeDb(int code) const { return(codeDb[code & (METER_CODES - 1)]); }
+
+	// Peak level of channel ch that percent of its frames are at or below, in dBFS
+	double PeakPercentile(int ch, double percent) const;
+
+	// Mean of channel ch's RMS level, averaged as power, in dBFS
+	double RmsMeanDb(int ch) const;
+
+	// Per channel summary and the spans, labelling channels with names; with rollups, a line per rollup too
+	void Print(std::ostream &out, const char *const names[MAX_NCHANS], const std::vector<MeterRollup> *rollups) const;
+};
+
+#endif //		_METER_STATS_H_
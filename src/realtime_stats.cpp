@@ -0,0 +1,73 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include "realtime_stats.h"
+
+static const char *stageNameTab[RT_NSTAGES] = { "sync", "parse", "serialize", "write", "latency" };
+
+/**************************************************************************************************************************************************************/
+RealtimeStats::RealtimeStats(void)
+{
+	Reset();
+}
+
+void RealtimeStats::Reset(void)
+{
+	for (int i = 0 ; i < RT_NSTAGES ; i++)
+	{
+		stage[i].Reset();
+	}
+	frames = 0;
+	deadlineMisses = 0;
+	skippedFrames = 0;
+	worstOverrun = 0;
+}
+
+void RealtimeStats::Print(std::ostream &out) const
+{
+	out << "Frames " << frames << ", deadline misses " << deadlineMisses << ", skipped " << skippedFrames;
+	if (deadlineMisses)
+	{
+		out << ", worst overrun " << (double)worstOverrun / 1000.0 << " us";
+	}
+	out << std::endl;
+	for (int i = 0 ; i < RT_NSTAGES ; i++)
+	{
+		stage[i].Print(out, stageNameTab[i]);
+	}
+}
+/**************************************************************************************************************************************************************/
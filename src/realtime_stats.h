@@ -0,0 +1,74 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_REALTIME_STATS_H_
+#define		_REALTIME_STATS_H_
+
+#include <stdint.h>
+#include <ostream>
+
+#include "latency_histogram.h"
+
+/* Stages timed for each frame pushed through DolbyEParser::Feed() */
+enum RealtimeStage
+{
+	RT_STAGE_SYNC,				/* searching for sync, from the later of the Feed() call and the end of the previous frame */
+	RT_STAGE_PARSE,				/* Dolby_E_frame(), or only the sync and metadata segments in early metadata mode */
+	RT_STAGE_SERIALIZE,			/* building and serializing the S-ADM document */
+	RT_STAGE_WRITE,				/* flushing it to the sink */
+	RT_STAGE_LATENCY,			/* from the Feed() call completing the words parsed to the S-ADM being written */
+	RT_NSTAGES
+};
+
+/*	Per stage latency histograms and deadline accounting for real-time conversion.
+	A frame misses its deadline when its latency exceeds the frame period */
+class RealtimeStats
+{
+public:
+	LatencyHistogram stage[RT_NSTAGES];
+	uint64_t frames;				/* frames parsed */
+	uint64_t deadlineMisses;
+	uint64_t skippedFrames;			/* unchanged frames not serialized while behind */
+	uint64_t worstOverrun;			/* ns beyond the frame period of the latest frame */
+
+	RealtimeStats(void);
+
+	void Reset(void);
+	void Print(std::ostream &out) const;
+};
+
+#endif //		_REALTIME_STATS_H_
@@ -0,0 +1,176 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "sadm_protocol.h"
+
+#define DEFAULT_SOCKET		"/tmp/dolbye2sadm.sock"
+
+void show_usage(void)
+{
+    std::cerr << "Usage: sadm_client [--socket path] request ..." << std::endl;
+    std::cerr << "    convert file [first [last]]   S-ADM XML for frames first to last of file, frame numbers or hh:mm:ss:ff" << std::endl;
+    std::cerr << "    probe file                    JSON summary of file" << std::endl;
+    std::cerr << "    stream fifo                   S-ADM XML for each frame written to fifo" << std::endl;
+    std::cerr << "All requests are sent before any response is read, so the daemon works on them together." << std::endl;
+    exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *socketPath = DEFAULT_SOCKET;
+    std::vector<std::pair<uint32_t, std::string>> requests;
+
+// Parse command line arguments into requests
+    int arg = 1;
+    if (arg + 1 < argc && !strcmp(argv[arg], "--socket"))
+    {
+        socketPath = argv[arg + 1];
+        arg += 2;
+    }
+    while (arg < argc)
+    {
+        uint32_t type;
+        int minArgs = 1, maxArgs = 1;
+        if (!strcmp(argv[arg], "convert"))
+        {
+            type = SADM_REQ_CONVERT;
+            maxArgs = 3;
+        }
+        else if (!strcmp(argv[arg], "probe"))
+        {
+            type = SADM_REQ_PROBE;
+        }
+        else if (!strcmp(argv[arg], "stream"))
+        {
+            type = SADM_REQ_STREAM;
+        }
+        else
+        {
+            show_usage();
+        }
+        arg++;
+
+        std::string payload;
+        int nArgs = 0;
+        // Optional frame numbers are the only arguments that start with a digit
+        while (arg < argc && nArgs < maxArgs && (nArgs < minArgs || (argv[arg][0] >= '0' && argv[arg][0] <= '9')))
+        {
+            if (nArgs++)
+            {
+                payload += '\n';
+            }
+            payload += argv[arg++];
+        }
+        if (nArgs < minArgs)
+        {
+            show_usage();
+        }
+        requests.push_back(std::make_pair(type, payload));
+    }
+    if (requests.empty())
+    {
+        show_usage();
+    }
+
+// Connect
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(addr.sun_path))
+    {
+        throw std::runtime_error("Error: Socket path too long");
+    }
+    strcpy(addr.sun_path, socketPath);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        std::cerr << "Error: Unable to connect to " << socketPath << ": " << strerror(errno) << std::endl;
+        return 1;
+    }
+
+// Send every request, ids are their position on the command line
+    for (uint32_t id = 0 ; id < requests.size() ; id++)
+    {
+        SadmWriteMsg(fd, requests[id].first, id, requests[id].second.data(), requests[id].second.size());
+    }
+
+// Print responses until every request has finished
+    size_t outstanding = requests.size();
+    int status = 0;
+    SadmMsgHeader header;
+    std::string payload;
+    while (outstanding && SadmReadMsg(fd, header, payload))
+    {
+        switch (header.type)
+        {
+        case SADM_RSP_XML:
+        case SADM_RSP_JSON:
+            std::cout << payload;
+            if (payload.empty() || payload.back() != '\n')
+            {
+                std::cout << std::endl;
+            }
+            break;
+        case SADM_RSP_ERROR:
+            std::cerr << "Request " << header.id << ": " << payload << std::endl;
+            status = 1;
+            outstanding--;
+            break;
+        case SADM_RSP_END:
+            outstanding--;
+            break;
+        }
+    }
+    close(fd);
+    if (outstanding)
+    {
+        std::cerr << "Error: Connection closed with " << outstanding << " requests outstanding" << std::endl;
+        return 1;
+    }
+    return status;
+}
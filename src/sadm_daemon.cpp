@@ -0,0 +1,404 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include "sadm_daemon.h"
+#include "dolbye_parser.h"
+
+#define POLL_INTERVAL_MS	200		/* how often blocked loops look at the stop flag */
+#define STREAM_READ_SZ		65536
+
+/**************************************************************************************************************************************************************/
+static std::vector<std::string> SplitFields(const std::string &payload)
+{
+	std::vector<std::string> fields;
+	size_t pos = 0;
+
+	while (pos < payload.size())
+	{
+		size_t end = payload.find('\n', pos);
+		end = (end == std::string::npos) ? payload.size() : end;
+		fields.push_back(payload.substr(pos, end - pos));
+		pos = end + 1;
+	}
+	return(fields);
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+SadmDaemon::Connection::~Connection()
+{
+	close(fd);
+}
+
+void SadmDaemon::Connection::Send(uint32_t type, uint32_t id, const void *payload, size_t len)
+{
+	std::lock_guard<std::mutex> lock(writeMutex);
+	SadmWriteMsg(fd, type, id, payload, len);
+}
+
+void SadmDaemon::Connection::Send(uint32_t type, uint32_t id, const std::string &payload)
+{
+	Send(type, id, payload.data(), payload.size());
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+SadmDaemon::SadmDaemon(const std::string &path, unsigned int nThreads, size_t queueDepth, const SadmTemplateSet *templateSet) :
+	socketPath(path),
+	listenFd(-1),
+	templates(templateSet),
+	stopping(false),
+	queue(nThreads, queueDepth)
+{
+	struct sockaddr_un addr;
+
+	if (socketPath.size() >= sizeof(addr.sun_path))
+	{
+		throw std::runtime_error("Error: Socket path too long");
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, socketPath.c_str());
+
+	if ((listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0)
+	{
+		throw std::runtime_error(std::string("Error: Unable to create socket: ") + strerror(errno));
+	}
+	// Replace a socket left by a previous run
+	unlink(socketPath.c_str());
+	if (bind(listenFd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(listenFd, SOMAXCONN) < 0)
+	{
+		int bindErr = errno;
+		close(listenFd);
+		throw std::runtime_error(std::string("Error: Unable to listen on ") + socketPath + ": " + strerror(bindErr));
+	}
+
+	// Xerces stays initialized for the daemon's lifetime
+	if (!DolbyEParser::XmlInitialize())
+	{
+		close(listenFd);
+		unlink(socketPath.c_str());
+		throw std::runtime_error("Error: Unable to initialize Xerces");
+	}
+}
+
+SadmDaemon::~SadmDaemon()
+{
+	if (listenFd >= 0)
+	{
+		close(listenFd);
+		unlink(socketPath.c_str());
+	}
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+HotFolder &SadmDaemon::WatchFolders(unsigned int settleMs, bool closeWrite, const std::string &statusFile)
+{
+	if (!hotFolder)
+	{
+		hotFolder.reset(new HotFolder(queue, templates, settleMs, closeWrite, statusFile));
+	}
+	return(*hotFolder);
+}
+
+void SadmDaemon::Run(volatile sig_atomic_t &stop)
+{
+	while (!stop)
+	{
+		struct pollfd pfd[2] = { { listenFd, POLLIN, 0 }, { hotFolder ? hotFolder->EventFd() : -1, POLLIN, 0 } };
+		int ready = poll(pfd, 2, POLL_INTERVAL_MS);
+		if (ready < 0 && errno != EINTR)
+		{
+			throw std::runtime_error(std::string("Error: poll failed: ") + strerror(errno));
+		}
+		if (hotFolder)
+		{
+			if (ready > 0 && (pfd[1].revents & POLLIN))
+			{
+				hotFolder->Events();
+			}
+			hotFolder->Tick();
+		}
+		if (ready <= 0 || !(pfd[0].revents & POLLIN))
+		{
+			continue;
+		}
+
+		int fd = accept4(listenFd, NULL, NULL, SOCK_CLOEXEC);
+		if (fd < 0)
+		{
+			continue;
+		}
+
+		std::shared_ptr<Connection> conn = std::make_shared<Connection>(fd);
+		{
+			std::lock_guard<std::mutex> lock(connMutex);
+			connections.remove_if([](const std::weak_ptr<Connection> &c) { return(c.expired()); });
+			connections.push_back(conn);
+			activeReaders++;
+		}
+		std::thread(&SadmDaemon::Serve, this, conn).detach();
+	}
+
+	// Stop taking requests, wake readers blocked on their sockets and wait for them
+	stopping = true;
+	close(listenFd);
+	unlink(socketPath.c_str());
+	listenFd = -1;
+	{
+		std::unique_lock<std::mutex> lock(connMutex);
+		for (std::weak_ptr<Connection> &c : connections)
+		{
+			std::shared_ptr<Connection> conn = c.lock();
+			if (conn)
+			{
+				shutdown(conn->fd, SHUT_RD);
+			}
+		}
+		readersDone.wait(lock, [this] { return(activeReaders == 0); });
+	}
+
+	// Jobs already queued still run, and must finish before Xerces goes
+	queue.Join();
+	DolbyEParser::XmlTerminate();
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void SadmDaemon::Serve(std::shared_ptr<Connection> conn)
+{
+	SadmMsgHeader header;
+	std::string payload;
+
+	try
+	{
+		while (!stopping && SadmReadMsg(conn->fd, header, payload))
+		{
+			// Waits while the queue is full, leaving further requests unread in the socket
+			if (!queue.Submit([this, conn, header, payload]() { Process(*conn, header, payload); }))
+			{
+				break;
+			}
+		}
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << "Closing connection: " << e.what() << std::endl;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(connMutex);
+		activeReaders--;
+	}
+	readersDone.notify_all();
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void SadmDaemon::Process(Connection &conn, const SadmMsgHeader &header, const std::string &payload)
+{
+	std::vector<std::string> args = SplitFields(payload);
+
+	try
+	{
+		switch(header.type)
+		{
+			case SADM_REQ_CONVERT:
+				Convert(conn, header.id, args);
+				break;
+			case SADM_REQ_PROBE:
+				Probe(conn, header.id, args);
+				break;
+			case SADM_REQ_STREAM:
+				Stream(conn, header.id, args);
+				break;
+			default:
+				throw std::runtime_error("Error: Unknown request");
+		}
+		conn.Send(SADM_RSP_END, header.id, NULL, 0);
+	}
+	catch (const std::exception &e)
+	{
+		try
+		{
+			conn.Send(SADM_RSP_ERROR, header.id, e.what());
+		}
+		catch (const std::exception &)
+		{
+			// Client has gone
+		}
+	}
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void SadmDaemon::Convert(Connection &conn, uint32_t id, const std::vector<std::string> &args)
+{
+	if (args.empty())
+	{
+		throw std::runtime_error("Error: convert needs a file name");
+	}
+	DolbyEParser parser(args[0]);
+	parser.SetTemplates(templates);
+
+	// Positions are frame numbers or time codes, found in the time code index
+	const TimecodeIndex &index = parser.GetTimecodeIndex();
+	uint32_t first = 0;
+	uint32_t last;
+	if (args.size() > 1 && !index.FindPosition(args[1].c_str(), first))
+	{
+		throw std::runtime_error("Error: Frame range outside file");
+	}
+	last = first;
+	if (args.size() > 2 && !index.FindPosition(args[2].c_str(), last))
+	{
+		// A frame number beyond the end converts to the end
+		if (args[2].empty() || args[2].find_first_not_of("0123456789") != std::string::npos || index.FrameCount() == 0)
+		{
+			throw std::runtime_error("Error: Frame range outside file");
+		}
+		last = index.FrameCount() - 1;
+	}
+	if (last < first)
+	{
+		throw std::runtime_error("Error: Frame range outside file");
+	}
+	parser.SeekFrame(first);
+
+	std::string xml;
+	for (uint32_t frame = first ; frame <= last && !stopping ; frame++)
+	{
+		parser.GetNextFrame();
+		parser.GenerateSadmXML(xml);
+		conn.Send(SADM_RSP_XML, id, xml);
+	}
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void SadmDaemon::Probe(Connection &conn, uint32_t id, const std::vector<std::string> &args)
+{
+	if (args.empty())
+	{
+		throw std::runtime_error("Error: probe needs a file name");
+	}
+	conn.Send(SADM_RSP_JSON, id, DolbyEProbeJson(DolbyEParser::Probe(args[0])));
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void SadmDaemon::Stream(Connection &conn, uint32_t id, const std::vector<std::string> &args)
+{
+	std::vector<unsigned char> buf(STREAM_READ_SZ);
+	int fd;
+
+	if (args.empty())
+	{
+		throw std::runtime_error("Error: stream needs a FIFO name");
+	}
+
+	// Opened without waiting for a writer, which may never come, so that the poll below can see the stop flag
+	if ((fd = open(args[0].c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC)) < 0)
+	{
+		throw std::runtime_error("Error: Unable to open " + args[0] + ": " + strerror(errno));
+	}
+
+	try
+	{
+		DolbyEParser parser;
+		std::string frame;
+		CallbackSink sink([&frame](const unsigned char *data, size_t len) { frame.append((const char *)data, len); },
+						  [&conn, &frame, id]() { conn.Send(SADM_RSP_XML, id, frame); frame.clear(); });
+
+		parser.SetTemplates(templates);
+		parser.SetSadmSink(&sink);
+		while (!stopping)
+		{
+			struct pollfd pfd = { fd, POLLIN, 0 };
+			if (poll(&pfd, 1, POLL_INTERVAL_MS) <= 0)
+			{
+				continue;
+			}
+
+			// Until a writer opens the FIFO poll times out, and once it has closed poll reports a hang-up and read 0
+			ssize_t n = read(fd, buf.data(), buf.size());
+			if (n < 0 && (errno == EINTR || errno == EAGAIN))
+			{
+				continue;
+			}
+			if (n < 0)
+			{
+				throw std::runtime_error("Error: Unable to read " + args[0] + ": " + strerror(errno));
+			}
+			if (n == 0)
+			{
+				break;
+			}
+			if (parser.Feed(buf.data(), (size_t)n))
+			{
+				std::cerr << "Warning: Frame parse error in " << args[0] << std::endl;
+			}
+		}
+	}
+	catch (...)
+	{
+		close(fd);
+		throw;
+	}
+	close(fd);
+}
+/**************************************************************************************************************************************************************/
@@ -0,0 +1,105 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_SADM_DAEMON_H_
+#define		_SADM_DAEMON_H_
+
+#include <signal.h>
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+#include "sadm_protocol.h"
+#include "sadm_template.h"
+#include "work_queue.h"
+#include "hot_folder.h"
+
+/*	Conversion server on a UNIX domain socket, see sadm_protocol.h for the protocol.
+	Each connection has a thread reading requests, which are queued for a pool of
+	worker threads. When the queue is full the reader stops reading, so a client that
+	pipelines more than the daemon can take is held back by the socket. Hot folders,
+	if any, are watched from the accept loop and share the same pool */
+class SadmDaemon
+{
+private:
+	// A client connection, shared by its reader thread and the jobs of its requests
+	struct Connection
+	{
+		int fd;
+		std::mutex writeMutex;			/* responses to pipelined requests come from several workers */
+
+		Connection(int connFd) : fd(connFd) {}
+		~Connection();
+
+		void Send(uint32_t type, uint32_t id, const void *payload, size_t len);
+		void Send(uint32_t type, uint32_t id, const std::string &payload);
+	};
+
+	std::string socketPath;
+	int listenFd;
+	const SadmTemplateSet *templates;
+	std::atomic<bool> stopping;
+	std::unique_ptr<HotFolder> hotFolder;	/* declared before the queue so conversions finish before it goes */
+	WorkQueue queue;
+
+	std::mutex connMutex;
+	std::list<std::weak_ptr<Connection>> connections;
+	int activeReaders = 0;				/* reader threads still running, under connMutex */
+	std::condition_variable readersDone;
+
+	void Serve(std::shared_ptr<Connection> conn);
+	void Process(Connection &conn, const SadmMsgHeader &header, const std::string &payload);
+	void Convert(Connection &conn, uint32_t id, const std::vector<std::string> &args);
+	void Probe(Connection &conn, uint32_t id, const std::vector<std::string> &args);
+	void Stream(Connection &conn, uint32_t id, const std::vector<std::string> &args);
+
+public:
+	SadmDaemon(const std::string &path, unsigned int nThreads, size_t queueDepth, const SadmTemplateSet *templateSet);
+	~SadmDaemon();
+
+	// Convert .dde files arriving in folders, alongside requests on the socket; add folders with AddFolder() before Run()
+	HotFolder &WatchFolders(unsigned int settleMs, bool closeWrite, const std::string &statusFile);
+
+	// Accept connections until stop is set, then finish queued work and return
+	void Run(volatile sig_atomic_t &stop);
+};
+
+#endif //		_SADM_DAEMON_H_
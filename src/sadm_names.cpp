@@ -0,0 +1,249 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include "sadm_names.h"
+
+struct SadmNameEntry
+{
+	char ascii[MAX_SADM_NAME_LEN];
+	XMLCh xml[MAX_SADM_NAME_LEN];
+};
+
+/* Build one table entry at compile time, widening the ASCII name into XMLCh */
+static constexpr SadmNameEntry Intern(const char *s)
+{
+	SadmNameEntry e = {};
+	for (int i = 0 ; (s[i] != '\0') && (i < (MAX_SADM_NAME_LEN - 1)) ; i++)
+	{
+		e.ascii[i] = s[i];
+		e.xml[i] = (XMLCh)s[i];
+	}
+	return(e);
+}
+
+static constexpr SadmNameEntry sadmNameTab[] =
+{
+	/* element names */
+	Intern("frame"),
+	Intern("frameHeader"),
+	Intern("frameFormat"),
+	Intern("transportTrackFormat"),
+	Intern("audioTrack"),
+	Intern("audioTrackUIDRef"),
+	Intern("profileList"),
+	Intern("profile"),
+	Intern("audioFormatExtended"),
+	Intern("audioProgramme"),
+	Intern("audioContentIDRef"),
+	Intern("loudnessMetadata"),
+	Intern("dialogueLoudness"),
+	Intern("audioContent"),
+	Intern("audioObjectIDRef"),
+	Intern("dialogue"),
+	Intern("audioObject"),
+	Intern("audioPackFormatIDRef"),
+	Intern("audioTrackUID"),
+	Intern("audioChannelFormatIDRef"),
+	Intern("audioFormatCustom"),
+	Intern("audioFormatCustomSet"),
+	Intern("dbmd"),
+	Intern("metadataSegment"),
+	Intern("dolbyE"),
+	Intern("programConfig"),
+	Intern("frameRateCode"),
+	Intern("smpteTimeCode"),
+	Intern("ac3Program"),
+	Intern("programInfo"),
+	Intern("acMod"),
+	Intern("bsMod"),
+	Intern("lfeOn"),
+	Intern("cMixLev"),
+	Intern("surMixLev"),
+	Intern("dSurMod"),
+	Intern("dialNorm"),
+	Intern("copyRightB"),
+	Intern("origBs"),
+	Intern("langCode"),
+	Intern("langCod"),
+	Intern("audioProdInfo"),
+	Intern("mixLevel"),
+	Intern("roomTyp"),
+	Intern("extBsi1e"),
+	Intern("loRoCMixLev"),
+	Intern("loRoSurMixLev"),
+	Intern("ltRtCMixLev"),
+	Intern("ltRtSurMixLev"),
+	Intern("dMixMod"),
+	Intern("extBsi2e"),
+	Intern("dSurExMod"),
+	Intern("dHeadPhonMod"),
+	Intern("adConvTyp"),
+	Intern("compr1"),
+	Intern("dynRng1"),
+	Intern("programDescriptionText"),
+	Intern("encodeParameters"),
+	Intern("hpFOn"),
+	Intern("bwLpFOn"),
+	Intern("lfeLpFOn"),
+	Intern("sur90On"),
+	Intern("surAttOn"),
+	Intern("rfPremphOn"),
+
+	/* attribute names */
+	Intern("version"),
+	Intern("frameFormatID"),
+	Intern("type"),
+	Intern("start"),
+	Intern("duration"),
+	Intern("timeReference"),
+	Intern("flowID"),
+	Intern("transportID"),
+	Intern("transportName"),
+	Intern("numIDs"),
+	Intern("numTracks"),
+	Intern("formatLabel"),
+	Intern("formatDefinition"),
+	Intern("trackID"),
+	Intern("profileName"),
+	Intern("profileVersion"),
+	Intern("profileLevel"),
+	Intern("audioProgrammeID"),
+	Intern("audioProgrammeName"),
+	Intern("audioProgrammeLanguage"),
+	Intern("audioContentID"),
+	Intern("audioContentName"),
+	Intern("audioContentLanguage"),
+	Intern("mixedContentKind"),
+	Intern("nonDialogueContentKind"),
+	Intern("dialogueContentKind"),
+	Intern("audioObjectID"),
+	Intern("audioObjectName"),
+	Intern("interact"),
+	Intern("UID"),
+	Intern("ID"),
+	Intern("exists"),
+	Intern("audioFormatCustomSetID"),
+	Intern("audioFormatCustomSetName"),
+	Intern("audioFormatCustomSetType"),
+	Intern("audioFormatCustomSetVersion"),
+
+	/* constant attribute and element values */
+	Intern("ITU-R_BS.2125-1"),
+	Intern("ITU-R_BS.2076-3"),
+	Intern("FF_00000001"),
+	Intern("full"),
+	Intern("00:00:00.00000S48000"),
+	Intern("local"),
+	Intern("TP_0001"),
+	Intern("X"),
+	Intern("0001"),
+	Intern("PCM"),
+	Intern("Advanced sound system: ADM and S-ADM profile for emission"),
+	Intern("ITU-R BS.2168"),
+	Intern("Dolby E ADM and S-ADM Profile for emission"),
+	Intern("und"),
+	Intern("AFC_1001"),
+	Intern("DolbyE DBMD Chunk"),
+	Intern("CUSTOM_SET_TYPE_DOLBYE_DBMD_CHUNK")
+};
+
+static_assert(sizeof(sadmNameTab) / sizeof(sadmNameTab[0]) == NSADMNAMES, "sadmNameTab does not match enum SadmName");
+
+const XMLCh *SadmXmlName(SadmName name)
+{
+	return(sadmNameTab[name].xml);
+}
+
+const char *SadmNameText(SadmName name)
+{
+	return(sadmNameTab[name].ascii);
+}
+
+/**************************************************************************************************************************************************************/
+XmlText::XmlText(const char *s)
+{
+	int i;
+
+	for (i = 0 ; (s[i] != '\0') && (i < (MAX_XML_TEXT_LEN - 1)) ; i++)
+	{
+		text[i] = (XMLCh)(unsigned char)s[i];
+	}
+	text[i] = 0;
+}
+
+XmlText::XmlText(const std::string &s) : XmlText(s.c_str())
+{
+}
+
+/* Format a decimal integer straight into an XMLCh buffer, return the number of characters written */
+static int FormatDecimal(XMLCh *dst, unsigned int value)
+{
+	XMLCh digits[10];
+	int n = 0, len = 0;
+
+	do
+	{
+		digits[n++] = (XMLCh)('0' + (value % 10));
+		value /= 10;
+	} while (value);
+
+	while (n)
+	{
+		dst[len++] = digits[--n];
+	}
+	dst[len] = 0;
+	return(len);
+}
+
+XmlText::XmlText(int value)
+{
+	if (value < 0)
+	{
+		text[0] = (XMLCh)'-';
+		// Negate in unsigned arithmetic so INT_MIN is formatted correctly
+		FormatDecimal(&text[1], 0u - (unsigned int)value);
+	}
+	else
+	{
+		FormatDecimal(text, (unsigned int)value);
+	}
+}
+
+XmlText::XmlText(unsigned int value)
+{
+	FormatDecimal(text, value);
+}
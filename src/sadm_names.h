@@ -0,0 +1,213 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_SADM_NAMES_H_
+#define		_SADM_NAMES_H_
+
+#include <string>
+
+#include <xercesc/util/XercesDefs.hpp>
+
+using namespace XERCES_CPP_NAMESPACE;
+
+#define MAX_SADM_NAME_LEN	64		/* longest interned name + terminator */
+#define MAX_XML_TEXT_LEN	128		/* longest formatted element / attribute value */
+
+/* Interned S-ADM element names, attribute names and constant attribute values.
+   The order must match sadmNameTab[] in sadm_names.cpp */
+enum SadmName
+{
+	/* element names */
+	SADM_frame,
+	SADM_frameHeader,
+	SADM_frameFormat,
+	SADM_transportTrackFormat,
+	SADM_audioTrack,
+	SADM_audioTrackUIDRef,
+	SADM_profileList,
+	SADM_profile,
+	SADM_audioFormatExtended,
+	SADM_audioProgramme,
+	SADM_audioContentIDRef,
+	SADM_loudnessMetadata,
+	SADM_dialogueLoudness,
+	SADM_audioContent,
+	SADM_audioObjectIDRef,
+	SADM_dialogue,
+	SADM_audioObject,
+	SADM_audioPackFormatIDRef,
+	SADM_audioTrackUID,
+	SADM_audioChannelFormatIDRef,
+	SADM_audioFormatCustom,
+	SADM_audioFormatCustomSet,
+	SADM_dbmd,
+	SADM_metadataSegment,
+	SADM_dolbyE,
+	SADM_programConfig,
+	SADM_frameRateCode,
+	SADM_smpteTimeCode,
+	SADM_ac3Program,
+	SADM_programInfo,
+	SADM_acMod,
+	SADM_bsMod,
+	SADM_lfeOn,
+	SADM_cMixLev,
+	SADM_surMixLev,
+	SADM_dSurMod,
+	SADM_dialNorm,
+	SADM_copyRightB,
+	SADM_origBs,
+	SADM_langCode,
+	SADM_langCod,
+	SADM_audioProdInfo,
+	SADM_mixLevel,
+	SADM_roomTyp,
+	SADM_extBsi1e,
+	SADM_loRoCMixLev,
+	SADM_loRoSurMixLev,
+	SADM_ltRtCMixLev,
+	SADM_ltRtSurMixLev,
+	SADM_dMixMod,
+	SADM_extBsi2e,
+	SADM_dSurExMod,
+	SADM_dHeadPhonMod,
+	SADM_adConvTyp,
+	SADM_compr1,
+	SADM_dynRng1,
+	SADM_programDescriptionText,
+	SADM_encodeParameters,
+	SADM_hpFOn,
+	SADM_bwLpFOn,
+	SADM_lfeLpFOn,
+	SADM_sur90On,
+	SADM_surAttOn,
+	SADM_rfPremphOn,
+
+	/* attribute names */
+	SADM_version,
+	SADM_frameFormatID,
+	SADM_type,
+	SADM_start,
+	SADM_duration,
+	SADM_timeReference,
+	SADM_flowID,
+	SADM_transportID,
+	SADM_transportName,
+	SADM_numIDs,
+	SADM_numTracks,
+	SADM_formatLabel,
+	SADM_formatDefinition,
+	SADM_trackID,
+	SADM_profileName,
+	SADM_profileVersion,
+	SADM_profileLevel,
+	SADM_audioProgrammeID,
+	SADM_audioProgrammeName,
+	SADM_audioProgrammeLanguage,
+	SADM_audioContentID,
+	SADM_audioContentName,
+	SADM_audioContentLanguage,
+	SADM_mixedContentKind,
+	SADM_nonDialogueContentKind,
+	SADM_dialogueContentKind,
+	SADM_audioObjectID,
+	SADM_audioObjectName,
+	SADM_interact,
+	SADM_UID,
+	SADM_ID,
+	SADM_exists,
+	SADM_audioFormatCustomSetID,
+	SADM_audioFormatCustomSetName,
+	SADM_audioFormatCustomSetType,
+	SADM_audioFormatCustomSetVersion,
+
+	/* constant attribute and element values */
+	SADMV_frameVersion,
+	SADMV_admVersion,
+	SADMV_frameFormatID,
+	SADMV_full,
+	SADMV_startTime,
+	SADMV_local,
+	SADMV_transportID,
+	SADMV_transportName,
+	SADMV_formatLabel,
+	SADMV_PCM,
+	SADMV_advSSProfileName,
+	SADMV_advSSProfile,
+	SADMV_dolbyEProfile,
+	SADMV_und,
+	SADMV_customSetID,
+	SADMV_customSetName,
+	SADMV_customSetType,
+
+	NSADMNAMES
+};
+
+/* Return the interned XMLCh form of an S-ADM name. The table is built at compile time */
+const XMLCh *SadmXmlName(SadmName name);
+
+/* Return the ASCII form of an S-ADM name */
+const char *SadmNameText(SadmName name);
+
+/*	Fixed size XMLCh value formatted without transcoding.
+	All S-ADM values are 7-bit ASCII (description text is limited to 0x20-0x7e by the
+	metadata parser) so widening each character is an exact conversion */
+class XmlText
+{
+private:
+	XMLCh text[MAX_XML_TEXT_LEN];
+
+public:
+	XmlText(const char *s);
+	XmlText(const std::string &s);
+	XmlText(int value);
+	XmlText(unsigned int value);
+
+	const XMLCh *xml(void) const
+	{
+		return text;
+	}
+};
+
+/* Attribute name / value pair for the AddDomNode*Attributes() helpers */
+struct SadmAttribute
+{
+	SadmName name;
+	const XMLCh *value;
+};
+
+#endif //		_SADM_NAMES_H_
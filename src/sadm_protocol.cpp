@@ -0,0 +1,152 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <algorithm>
+#include <stdexcept>
+
+#include "sadm_protocol.h"
+
+/**************************************************************************************************************************************************************/
+// Read exactly len bytes, false if the stream ends before any are read
+static bool ReadAll(int fd, void *buf, size_t len)
+{
+	size_t done = 0;
+
+	while (done < len)
+	{
+		ssize_t n = read(fd, (char *)buf + done, len - done);
+		if (n < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (n < 0)
+		{
+			throw std::runtime_error(std::string("Error reading message: ") + strerror(errno));
+		}
+		if (n == 0)
+		{
+			if (done == 0)
+			{
+				return(false);
+			}
+			throw std::runtime_error("Error reading message: truncated");
+		}
+		done += (size_t)n;
+	}
+	return(true);
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+bool SadmReadMsg(int fd, SadmMsgHeader &header, std::string &payload)
+{
+	if (!ReadAll(fd, &header, sizeof(header)))
+	{
+		return(false);
+	}
+	if (header.magic != SADM_MSG_MAGIC || header.length > SADM_MSG_MAX_PAYLOAD)
+	{
+		throw std::runtime_error("Error reading message: bad header");
+	}
+	payload.resize(header.length);
+	if (header.length > 0 && !ReadAll(fd, &payload[0], header.length))
+	{
+		throw std::runtime_error("Error reading message: truncated");
+	}
+	return(true);
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void SadmWriteMsg(int fd, uint32_t type, uint32_t id, const void *payload, size_t len)
+{
+	SadmMsgHeader header = { SADM_MSG_MAGIC, type, id, (uint32_t)len };
+	struct iovec iov[2];
+	struct msghdr msg;
+	size_t left = sizeof(header) + len;
+
+	if (len > SADM_MSG_MAX_PAYLOAD)
+	{
+		throw std::runtime_error("Error writing message: too long");
+	}
+
+	iov[0].iov_base = &header;
+	iov[0].iov_len = sizeof(header);
+	iov[1].iov_base = (void *)payload;
+	iov[1].iov_len = len;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = 2;
+
+	// MSG_NOSIGNAL so a client that has gone away is an error here rather than SIGPIPE
+	while (left > 0)
+	{
+		ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (n < 0)
+		{
+			throw std::runtime_error(std::string("Error writing message: ") + strerror(errno));
+		}
+		left -= (size_t)n;
+
+		// Step past what was sent
+		while (n > 0 && msg.msg_iovlen > 0)
+		{
+			size_t step = std::min((size_t)n, msg.msg_iov->iov_len);
+			msg.msg_iov->iov_base = (char *)msg.msg_iov->iov_base + step;
+			msg.msg_iov->iov_len -= step;
+			n -= (ssize_t)step;
+			if (msg.msg_iov->iov_len == 0)
+			{
+				msg.msg_iov++;
+				msg.msg_iovlen--;
+			}
+		}
+	}
+}
+/**************************************************************************************************************************************************************/
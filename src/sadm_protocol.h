@@ -0,0 +1,85 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_SADM_PROTOCOL_H_
+#define		_SADM_PROTOCOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+/*	Framing used on the daemon's UNIX domain socket.
+	Every message is a header followed by length bytes of payload, all in native byte order
+	as the socket is local. A client may send any number of requests without waiting (pipelining);
+	the responses to each carry its id and end with exactly one SADM_RSP_END or SADM_RSP_ERROR.
+	Responses to different requests may interleave.
+
+	Request payloads are '\n' separated text fields:
+		SADM_REQ_CONVERT	file [first frame [last frame]]		-> SADM_RSP_XML per frame
+		SADM_REQ_PROBE		file								-> SADM_RSP_JSON
+		SADM_REQ_STREAM		fifo								-> SADM_RSP_XML per frame until the writer closes it */
+
+#define SADM_MSG_MAGIC			0x4d444153		/* "SADM" */
+#define SADM_MSG_MAX_PAYLOAD	(16 * 1024 * 1024)
+
+enum SadmMsgType
+{
+	SADM_REQ_CONVERT = 1,
+	SADM_REQ_PROBE,
+	SADM_REQ_STREAM,
+
+	SADM_RSP_XML = 0x81,
+	SADM_RSP_JSON,
+	SADM_RSP_ERROR,						/* payload is the error message */
+	SADM_RSP_END
+};
+
+struct SadmMsgHeader
+{
+	uint32_t magic;
+	uint32_t type;						/* SadmMsgType */
+	uint32_t id;						/* chosen by the client, echoed in responses */
+	uint32_t length;					/* of payload */
+};
+
+// Read one message. Returns false on a clean end of stream, throws std::runtime_error on errors
+bool SadmReadMsg(int fd, SadmMsgHeader &header, std::string &payload);
+
+// Write one message. Throws std::runtime_error on errors, including the peer having gone
+void SadmWriteMsg(int fd, uint32_t type, uint32_t id, const void *payload, size_t len);
+
+#endif //		_SADM_PROTOCOL_H_
@@ -0,0 +1,197 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <stdexcept>
+#include <iostream>
+#include <string.h>
+
+#include "sadm_shm_sink.h"
+
+static inline size_t RecordSize(size_t xmlLen)
+{
+	return((sizeof(ShmFrameRecord) + xmlLen + SHM_FRAME_ALIGN - 1) & ~(size_t)(SHM_FRAME_ALIGN - 1));
+}
+
+/**************************************************************************************************************************************************************/
+ShmFrameSink::ShmFrameSink(const std::string &ringName, size_t capacity, bool overwriteOldest) :
+	ring(ringName, capacity, overwriteOldest), used(0)
+{
+	memset(&record, 0, sizeof(record));
+	record.magic = SHM_FRAME_MAGIC;
+}
+
+ShmFrameSink::~ShmFrameSink()
+{
+	ring.Close();
+	if (!ring.IsOverwrite())
+	{
+		// No frame is lost in block mode, so wait for the reader to take the last ones before the ring goes, but
+		// not for ever, as the reader may have exited or never attached
+		size_t space;
+		if (ring.Reserve(ring.Capacity(), space, SHM_SINK_DRAIN_MS) == NULL)
+		{
+			uint64_t tail = ring.Tail();
+			size_t unread = 0;
+			for (uint64_t end : recordEnds)
+			{
+				unread += (end > tail) ? 1 : 0;
+			}
+			std::cerr << "Warning: " << unread << " S-ADM frames not read from the shared memory ring" << std::endl;
+		}
+	}
+}
+
+// The record being built starts at the head, which only moves when it is committed
+uint8_t *ShmFrameSink::Space(size_t len)
+{
+	if (len > ring.Capacity())
+	{
+		throw std::runtime_error("Error: S-ADM frame larger than the shared memory ring");
+	}
+	if (ring.IsOverwrite())
+	{
+		return(ring.Overwrite(len));
+	}
+	size_t space;
+	return(ring.Reserve(len, space, -1));
+}
+
+void ShmFrameSink::BeginFrame(unsigned int frameCount, const char *timecode)
+{
+	record.frameCount = frameCount;
+	strncpy(record.timecode, timecode, sizeof(record.timecode) - 1);
+	used = sizeof(ShmFrameRecord);
+}
+
+void ShmFrameSink::Write(const unsigned char *data, size_t len)
+{
+	if (used == 0)
+	{
+		BeginFrame(0, "");
+	}
+	uint8_t *dst = Space(used + len);
+	memcpy(dst + used, data, len);
+	used += len;
+}
+
+void ShmFrameSink::EndFrame(void)
+{
+	if (used == 0)
+	{
+		return;
+	}
+	record.length = (uint32_t)(used - sizeof(ShmFrameRecord));
+	uint8_t *dst = Space(RecordSize(record.length));
+	memcpy(dst, &record, sizeof(ShmFrameRecord));
+
+	uint64_t start = ring.Head();
+	ring.Commit(RecordSize(record.length));
+	ring.SetMark(start);
+	if (!ring.IsOverwrite())
+	{
+		uint64_t tail = ring.Tail();
+		while (!recordEnds.empty() && recordEnds.front() <= tail)
+		{
+			recordEnds.pop_front();
+		}
+		recordEnds.push_back(ring.Head());
+	}
+	record.sequence++;
+	used = 0;
+}
+
+/**************************************************************************************************************************************************************/
+ShmFrameReader::ShmFrameReader(const std::string &ringName) :
+	ring(ringName), pos(0), nextSequence(0), lost(0)
+{
+	if (ring.IsOverwrite() && ring.Head() > 0)
+	{
+		// Frames before the latest were missed by starting late, not lost
+		pos = ring.Mark();
+		nextSequence = UINT64_MAX;
+	}
+}
+
+bool ShmFrameReader::Next(ShmFrameRecord &record, std::string &xml, int timeoutMs)
+{
+	if (!ring.IsOverwrite())
+	{
+		// Records are published whole, so once the header is there so is the rest
+		size_t len;
+		uint8_t *src = ring.Peek(sizeof(ShmFrameRecord), len, timeoutMs);
+		if (src == NULL)
+		{
+			return(false);
+		}
+		memcpy(&record, src, sizeof(ShmFrameRecord));
+		if (record.magic != SHM_FRAME_MAGIC || RecordSize(record.length) > len)
+		{
+			throw std::runtime_error("Error: Corrupt S-ADM frame in shared memory ring");
+		}
+		xml.assign((const char *)src + sizeof(ShmFrameRecord), record.length);
+		ring.Release(RecordSize(record.length));
+	}
+	else
+	{
+		while (1)
+		{
+			if (!ring.WaitFor(pos, timeoutMs))
+			{
+				return(false);
+			}
+			if (ring.ReadAt(pos, &record, sizeof(ShmFrameRecord)) && record.magic == SHM_FRAME_MAGIC &&
+				RecordSize(record.length) <= ring.Capacity())
+			{
+				xml.resize(record.length);
+				if (ring.ReadAt(pos + sizeof(ShmFrameRecord), &xml[0], record.length))
+				{
+					pos += RecordSize(record.length);
+					break;
+				}
+			}
+			// Lapped by the writer, start again from its latest frame
+			pos = ring.Mark();
+		}
+		if (nextSequence != UINT64_MAX && record.sequence > nextSequence)
+		{
+			lost += record.sequence - nextSequence;
+		}
+	}
+	nextSequence = record.sequence + 1;
+	return(true);
+}
+/**************************************************************************************************************************************************************/
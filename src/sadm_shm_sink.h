@@ -0,0 +1,109 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_SADM_SHM_SINK_H_
+#define		_SADM_SHM_SINK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
+#include <string>
+
+#include "sadm_sink.h"
+#include "shm_ring.h"
+
+/*	S-ADM frames passed to downstream embedders through a ShmRing (see shm_ring.h), one record per frame:
+	a ShmFrameRecord then length bytes of XML, padded to a multiple of SHM_FRAME_ALIGN. A record is published
+	by the single advance of head after it is complete, and mark is set to its start */
+
+#define SHM_FRAME_MAGIC		0x46444153		/* "SADF" */
+#define SHM_FRAME_ALIGN		8
+#define SHM_SINK_DRAIN_MS	2000			/* longest a block mode sink waits on destruction for its reader */
+
+struct ShmFrameRecord
+{
+	uint32_t magic;
+	uint32_t length;					/* of the XML that follows */
+	uint64_t sequence;					/* # frames written to the ring before this one */
+	uint32_t frameCount;				/* Dolby E frame_count */
+	char timecode[12];					/* SMPTE time code "hh:mm:ss:ff", or "invalid" */
+};
+
+/*	Writes each frame straight into the ring as it is serialized. With overwriteOldest the sink never waits
+	and readers that fall more than a ring behind lose frames, otherwise it waits for its one reader, including
+	on destruction for up to SHM_SINK_DRAIN_MS for the last frames to be read. Any left unread, as when the reader
+	has exited, are reported on stderr */
+class ShmFrameSink : public SadmSink
+{
+private:
+	ShmRing ring;
+	ShmFrameRecord record;
+	size_t used;						/* bytes of the current record written, 0 between frames */
+	std::deque<uint64_t> recordEnds;	/* block mode: end of each record the reader may not have taken yet */
+
+	uint8_t *Space(size_t len);
+
+public:
+	ShmFrameSink(const std::string &ringName, size_t capacity = SHM_RING_DEFAULT_SZ, bool overwriteOldest = false);
+	~ShmFrameSink();
+
+	void BeginFrame(unsigned int frameCount, const char *timecode) override;
+	void Write(const unsigned char *data, size_t len) override;
+	void EndFrame(void) override;
+};
+
+/*	Reads the frames written by a ShmFrameSink. In overwrite mode readers start at the latest frame and, if lapped,
+	carry on from the latest frame again */
+class ShmFrameReader
+{
+private:
+	ShmRing ring;
+	uint64_t pos;						/* overwrite mode only, block mode uses the ring's tail */
+	uint64_t nextSequence;
+	uint64_t lost;
+
+public:
+	ShmFrameReader(const std::string &ringName);
+
+	// Wait up to timeoutMs (-1 forever) for the next frame. False on timeout, or once the writer has finished
+	bool Next(ShmFrameRecord &record, std::string &xml, int timeoutMs);
+
+	// # frames overwritten before they could be read
+	uint64_t Lost(void) const { return(lost); }
+};
+
+#endif //		_SADM_SHM_SINK_H_
@@ -0,0 +1,280 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <algorithm>
+#include <stdexcept>
+#include <string.h>
+
+#include "sadm_sink.h"
+
+#ifndef _WIN32
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+#define SINK_MAX_BLOCKS 16		/* fragment cache limit before a batch is written early */
+
+/**************************************************************************************************************************************************************/
+FdSink::FdSink(int fileDesc, bool ownFileDesc, unsigned int batchFrames) :
+fd(fileDesc),
+ownFd(ownFileDesc),
+framesPerWrite(batchFrames ? batchFrames : 1),
+pendingFrames(0),
+blockNo(0)
+{
+	if (fd < 0)
+	{
+		throw std::runtime_error("Error: Invalid output file descriptor");
+	}
+	blocks.emplace_back();
+	blocks[0].reserve(SINK_BLOCK_SZ);
+}
+
+FdSink::~FdSink()
+{
+	try
+	{
+		WriteAll();
+	}
+	catch (const std::exception &)
+	{
+		// Nothing sensible can be done with a write error during destruction
+	}
+	if (ownFd)
+	{
+		close(fd);
+	}
+}
+
+void FdSink::Write(const unsigned char *data, size_t len)
+{
+	while (len)
+	{
+		std::vector<unsigned char> &block = blocks[blockNo];
+		size_t space = block.capacity() - block.size();
+
+		if (space == 0)
+		{
+			if (blockNo + 1 >= SINK_MAX_BLOCKS)
+			{
+				WriteAll();
+				continue;
+			}
+			blockNo++;
+			if (blockNo == blocks.size())
+			{
+				blocks.emplace_back();
+				blocks[blockNo].reserve(SINK_BLOCK_SZ);
+			}
+			continue;
+		}
+
+		size_t n = (len < space) ? len : space;
+		unsigned char *dst = block.data() + block.size();
+
+		// Capacity is reserved up front so appending never moves the block
+		block.insert(block.end(), data, data + n);
+
+		// Extend the last iovec if this fragment continues it, otherwise start a new one
+		if (!iov.empty() && ((unsigned char *)iov.back().iov_base + iov.back().iov_len == dst))
+		{
+			iov.back().iov_len += n;
+		}
+		else
+		{
+			struct iovec v;
+			v.iov_base = dst;
+			v.iov_len = n;
+			iov.push_back(v);
+		}
+		data += n;
+		len -= n;
+	}
+}
+
+void FdSink::EndFrame(void)
+{
+	pendingFrames++;
+	if (pendingFrames >= framesPerWrite)
+	{
+		WriteAll();
+	}
+}
+
+void FdSink::Flush(void)
+{
+	WriteAll();
+}
+
+void FdSink::WriteAll(void)
+{
+	size_t first = 0;
+
+	while (first < iov.size())
+	{
+		int count = (int)std::min(iov.size() - first, (size_t)IOV_MAX);
+		ssize_t n = writev(fd, &iov[first], count);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			throw std::runtime_error("Error: Unable to write output");
+		}
+
+		// Step over whatever was written, allowing for partial writes
+		while ((n > 0) && (first < iov.size()))
+		{
+			if ((size_t)n >= iov[first].iov_len)
+			{
+				n -= iov[first].iov_len;
+				first++;
+			}
+			else
+			{
+				iov[first].iov_base = (unsigned char *)iov[first].iov_base + n;
+				iov[first].iov_len -= n;
+				n = 0;
+			}
+		}
+	}
+
+	iov.clear();
+	for (size_t i = 0 ; i <= blockNo ; i++)
+	{
+		blocks[i].clear();
+	}
+	blockNo = 0;
+	pendingFrames = 0;
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+MmapFileSink::MmapFileSink(const std::string &fileName, size_t preallocSz) :
+map(nullptr),
+mapSz(0),
+written(0)
+{
+	if ((fd = open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0)
+	{
+		throw std::runtime_error("Error: Unable to open file to write xml data");
+	}
+	Reserve(preallocSz ? preallocSz : MMAP_SINK_INITIAL_SZ);
+}
+
+MmapFileSink::~MmapFileSink()
+{
+	if (map)
+	{
+		munmap(map, mapSz);
+	}
+	// Drop the unused preallocated tail
+	if (ftruncate(fd, (off_t)written) != 0)
+	{
+		// Leave the file as is, the data written is still intact
+	}
+	close(fd);
+}
+
+void MmapFileSink::Reserve(size_t needed)
+{
+	size_t newSz = mapSz ? mapSz : needed;
+
+	while (newSz < needed)
+	{
+		newSz *= 2;
+	}
+	if (newSz == mapSz)
+	{
+		return;
+	}
+
+#ifdef __linux__
+	if (fallocate(fd, 0, 0, (off_t)newSz) != 0)
+#endif
+	{
+		// Filesystems without fallocate() support still allow the file to be extended
+		if (ftruncate(fd, (off_t)newSz) != 0)
+		{
+			throw std::runtime_error("Error: Unable to extend output file");
+		}
+	}
+
+	if (map)
+	{
+		munmap(map, mapSz);
+	}
+	map = (unsigned char *)mmap(nullptr, newSz, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED)
+	{
+		map = nullptr;
+		mapSz = 0;
+		throw std::runtime_error("Error: Unable to map output file");
+	}
+	mapSz = newSz;
+}
+
+void MmapFileSink::Write(const unsigned char *data, size_t len)
+{
+	if (written + len > mapSz)
+	{
+		Reserve(written + len);
+	}
+	memcpy(map + written, data, len);
+	written += len;
+}
+
+void MmapFileSink::Flush(void)
+{
+	if (map && written)
+	{
+		msync(map, written, MS_ASYNC);
+	}
+}
+/**************************************************************************************************************************************************************/
+
+#endif	// _WIN32
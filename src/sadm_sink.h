@@ -0,0 +1,167 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_SADM_SINK_H_
+#define		_SADM_SINK_H_
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <functional>
+
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
+
+/*	Destination for serialized S-ADM frames.
+	BeginFrame() labels each frame, Write() may be called many times per frame with fragments of the document,
+	EndFrame() marks the end of each frame and Flush() forces any batched data
+	out to the destination. Errors are reported with std::runtime_error */
+class SadmSink
+{
+public:
+	virtual ~SadmSink() {}
+
+	// Called before the first Write() of each frame with the Dolby E frame_count and SMPTE time code
+	virtual void BeginFrame(unsigned int frameCount, const char *timecode) { (void)frameCount; (void)timecode; }
+	virtual void Write(const unsigned char *data, size_t len) = 0;
+	virtual void EndFrame(void) {}
+	virtual void Flush(void) {}
+};
+
+/* Appends frames to a std::string, kept for callers of GenerateSadmXML(std::string &) */
+class StringSink : public SadmSink
+{
+private:
+	std::string &str;
+
+public:
+	StringSink(std::string &s) : str(s) {}
+
+	void Write(const unsigned char *data, size_t len) override
+	{
+		str.append((const char *)data, len);
+	}
+};
+
+/* Hands each fragment and the end of each frame to user supplied functions */
+class CallbackSink : public SadmSink
+{
+public:
+	typedef std::function<void(const unsigned char *data, size_t len)> DataCallback;
+	typedef std::function<void(void)> FrameCallback;
+
+	CallbackSink(DataCallback onData, FrameCallback onFrame = nullptr) :
+		dataCallback(onData), frameCallback(onFrame) {}
+
+	void Write(const unsigned char *data, size_t len) override
+	{
+		dataCallback(data, len);
+	}
+
+	void EndFrame(void) override
+	{
+		if (frameCallback)
+		{
+			frameCallback();
+		}
+	}
+
+private:
+	DataCallback dataCallback;
+	FrameCallback frameCallback;
+};
+
+#ifndef _WIN32
+
+#define SINK_BLOCK_SZ			(256 * 1024)	/* fragment cache block size (bytes) */
+#define SINK_FRAMES_PER_WRITE	32				/* default # of frames batched per writev() */
+
+/*	Writes to a raw file descriptor.
+	Fragments are cached in fixed blocks and written with writev(), one system
+	call per batch of frames (or sooner if the cache fills). The descriptor is
+	closed on destruction only if ownFd is set */
+class FdSink : public SadmSink
+{
+private:
+	int fd;
+	bool ownFd;
+	unsigned int framesPerWrite;
+	unsigned int pendingFrames;
+
+	std::vector<std::vector<unsigned char>> blocks;		/* fragment cache */
+	size_t blockNo;										/* block currently being filled */
+	std::vector<struct iovec> iov;						/* pending output, one entry per contiguous run */
+
+	void WriteAll(void);
+
+public:
+	FdSink(int fileDesc, bool ownFileDesc = false, unsigned int batchFrames = SINK_FRAMES_PER_WRITE);
+	~FdSink();
+
+	void Write(const unsigned char *data, size_t len) override;
+	void EndFrame(void) override;
+	void Flush(void) override;
+};
+
+#define MMAP_SINK_INITIAL_SZ	(4 * 1024 * 1024)	/* initial preallocation (bytes) */
+
+/*	Writes into a memory mapped output file.
+	The file is preallocated with fallocate() and grown geometrically, so a frame
+	costs a memcpy and no system calls. The file is truncated to the number of
+	bytes written when the sink is destroyed */
+class MmapFileSink : public SadmSink
+{
+private:
+	int fd;
+	unsigned char *map;
+	size_t mapSz;
+	size_t written;
+
+	void Reserve(size_t needed);
+
+public:
+	MmapFileSink(const std::string &fileName, size_t preallocSz = MMAP_SINK_INITIAL_SZ);
+	~MmapFileSink();
+
+	void Write(const unsigned char *data, size_t len) override;
+	void Flush(void) override;
+};
+
+#endif	// _WIN32
+
+#endif //		_SADM_SINK_H_
@@ -0,0 +1,369 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <stdexcept>
+
+#include "sadm_template.h"
+
+/* program_config codes that have templates */
+#define PROGCONFIG_5_1_2		0		/* 5.1+2 */
+#define PROGCONFIG_2_2_2_2		6		/* 2+2+2+2 */
+#define PROGCONFIG_5_1			11		/* 5.1 */
+
+/* frame_rate codes that have templates */
+#define FRAMERATE_25			3
+#define FRAMERATE_29_97			4
+
+static const char flowIdAttr[] = "flowID=\"";
+static const char durationAttr[] = " duration=\"";
+static const char dbmdMarker[] = "<!-- dbmd goes here -->";
+static const char audioFormatExtendedMarker[] = "<!-- audioFormatExtended goes here -->";
+static const char dialogueLoudnessOpen[] = "<dialogueLoudness>";
+static const char dialogueLoudnessClose[] = "</dialogueLoudness>";
+static const char programmeIdAttr[] = "audioProgrammeID=\"APR_";
+static const char contentIdAttr[] = "audioContentID=\"ACO_";
+
+
+/**************************************************************************************************************************************************************/
+static void WriteText(SadmSink &sink, const char *s, size_t len, const std::string &indent)
+{
+	const char *end = s + len;
+	const char *nl;
+
+	// Continue each new line at the indentation of the enclosing slot
+	while (!indent.empty() && (nl = (const char *)memchr(s, '\n', end - s)) != NULL)
+	{
+		sink.Write((const unsigned char *)s, nl + 1 - s);
+		sink.Write((const unsigned char *)indent.data(), indent.size());
+		s = nl + 1;
+	}
+	sink.Write((const unsigned char *)s, end - s);
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+SadmTemplate::SadmTemplate(const char *data, size_t size)
+{
+	text.reserve(size);
+	for (size_t i = 0 ; i < size ; i++)
+	{
+		if (data[i] != '\r')
+		{
+			text.push_back(data[i]);
+		}
+	}
+	Compile();
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void SadmTemplate::AddSlot(SadmSlot slot, size_t offset, size_t length, int progNo)
+{
+	SadmSlotDesc desc;
+	size_t lineStart = text.rfind('\n', offset);
+
+	lineStart = (lineStart == std::string::npos) ? 0 : lineStart + 1;
+	desc.slot = slot;
+	desc.offset = offset;
+	desc.length = length;
+	desc.indentOffset = lineStart;
+	desc.indentLength = std::min(text.find_first_not_of(" \t", lineStart), offset) - lineStart;
+	desc.progNo = progNo;
+	slots.push_back(desc);
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void SadmTemplate::Compile(void)
+{
+	size_t pos;
+
+	// Strip the first line's indentation from every line so the template can be placed at any depth
+	std::string firstIndent = text.substr(0, text.find_first_not_of(" \t"));
+	if (!firstIndent.empty())
+	{
+		std::string dedented;
+		dedented.reserve(text.size());
+		pos = 0;
+		while (pos < text.size())
+		{
+			size_t eol = text.find('\n', pos);
+			eol = (eol == std::string::npos) ? text.size() : eol + 1;
+			if (text.compare(pos, firstIndent.size(), firstIndent) == 0)
+			{
+				pos += firstIndent.size();
+			}
+			dedented.append(text, pos, eol - pos);
+			pos = eol;
+		}
+		text.swap(dedented);
+	}
+	text.erase(text.find_last_not_of(" \t\n") + 1);
+
+	// Attribute values
+	if ((pos = text.find(flowIdAttr)) != std::string::npos)
+	{
+		pos += strlen(flowIdAttr);
+		AddSlot(SLOT_FLOW_ID, pos, text.find('"', pos) - pos, 0);
+	}
+	if ((pos = text.find(durationAttr)) != std::string::npos)
+	{
+		pos += strlen(durationAttr);
+		AddSlot(SLOT_DURATION, pos, text.find('"', pos) - pos, 0);
+	}
+
+	// Blocks
+	if ((pos = text.find(dbmdMarker)) != std::string::npos)
+	{
+		AddSlot(SLOT_DBMD, pos, strlen(dbmdMarker), 0);
+	}
+	if ((pos = text.find(audioFormatExtendedMarker)) != std::string::npos)
+	{
+		AddSlot(SLOT_AUDIO_FORMAT_EXTENDED, pos, strlen(audioFormatExtendedMarker), 0);
+	}
+
+	// Loudness values belong to the audioProgramme or audioContent they are in, found from its ID
+	pos = 0;
+	while ((pos = text.find(dialogueLoudnessOpen, pos)) != std::string::npos)
+	{
+		size_t programme = text.rfind(programmeIdAttr, pos);
+		size_t content = text.rfind(contentIdAttr, pos);
+		size_t idPos;
+		int progNo;
+
+		if (programme != std::string::npos && (content == std::string::npos || programme > content))
+		{
+			idPos = programme + strlen(programmeIdAttr);
+		}
+		else if (content != std::string::npos)
+		{
+			idPos = content + strlen(contentIdAttr);
+		}
+		else
+		{
+			throw std::runtime_error("Error: dialogueLoudness outside audioProgramme or audioContent in template");
+		}
+		progNo = (int)strtol(text.c_str() + idPos, NULL, 16) - 0x1001;
+		if (progNo < 0 || progNo >= MAX_NPGRMS)
+		{
+			throw std::runtime_error("Error: Invalid programme ID in template");
+		}
+
+		pos += strlen(dialogueLoudnessOpen);
+		size_t end = text.find(dialogueLoudnessClose, pos);
+		if (end == std::string::npos)
+		{
+			throw std::runtime_error("Error: Unterminated dialogueLoudness in template");
+		}
+		AddSlot(SLOT_DIALOGUE_LOUDNESS, pos, end - pos, progNo);
+		pos = end;
+	}
+
+	std::sort(slots.begin(), slots.end(), [](const SadmSlotDesc &a, const SadmSlotDesc &b) { return a.offset < b.offset; });
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void SadmTemplate::WriteBody(SadmSink &sink, const SadmTemplateFill &fill, const std::string &indent) const
+{
+	size_t pos = 0;
+	char value[16];
+
+	for (const SadmSlotDesc &slot : slots)
+	{
+		WriteText(sink, text.data() + pos, slot.offset - pos, indent);
+		switch(slot.slot)
+		{
+			case SLOT_FLOW_ID:
+				sink.Write((const unsigned char *)fill.flowID, strlen(fill.flowID));
+				break;
+			case SLOT_DURATION:
+				sink.Write((const unsigned char *)fill.duration, strlen(fill.duration));
+				break;
+			case SLOT_DIALOGUE_LOUDNESS:
+				snprintf(value, sizeof(value), "%d", fill.dialogueLoudness[slot.progNo]);
+				sink.Write((const unsigned char *)value, strlen(value));
+				break;
+			case SLOT_DBMD:
+				WriteText(sink, fill.dbmd.data(), fill.dbmd.find_last_not_of(" \t\n") + 1, indent + text.substr(slot.indentOffset, slot.indentLength));
+				break;
+			case SLOT_AUDIO_FORMAT_EXTENDED:
+				if (fill.audioFormatExtended != NULL)
+				{
+					fill.audioFormatExtended->WriteBody(sink, fill, indent + text.substr(slot.indentOffset, slot.indentLength));
+				}
+				break;
+		}
+		pos = slot.offset + slot.length;
+	}
+	WriteText(sink, text.data() + pos, text.size() - pos, indent);
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void SadmTemplate::Write(SadmSink &sink, const SadmTemplateFill &fill) const
+{
+	WriteBody(sink, fill, std::string());
+	sink.Write((const unsigned char *)"\n", 1);
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+SadmTemplateSet::SadmTemplateSet(void)
+{
+	for (size_t i = 0 ; i < nSadmEmbeddedTemplates ; i++)
+	{
+		templates.emplace(sadmEmbeddedTemplates[i].name, SadmTemplate((const char *)sadmEmbeddedTemplates[i].data, sadmEmbeddedTemplates[i].size));
+	}
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void SadmTemplateSet::LoadDirectory(const std::string &dirName)
+{
+	for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(dirName))
+	{
+		if (!entry.is_regular_file() || entry.path().extension() != ".xml")
+		{
+			continue;
+		}
+
+		std::ifstream file(entry.path(), std::ios::binary);
+		if (!file.is_open())
+		{
+			throw std::runtime_error("Error: Unable to open template " + entry.path().string());
+		}
+		std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		templates.insert_or_assign(entry.path().filename().string(), SadmTemplate(data.data(), data.size()));
+	}
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+const SadmTemplate *SadmTemplateSet::Find(const std::string &name) const
+{
+	auto it = templates.find(name);
+
+	return((it == templates.end()) ? NULL : &it->second);
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+const SadmTemplate *SadmTemplateSet::SelectFrame(int progConfig, int frameRate) const
+{
+	std::string name;
+
+	switch(progConfig)
+	{
+		case PROGCONFIG_5_1_2:
+			name = "dolbye_5.1+2";
+			break;
+		case PROGCONFIG_2_2_2_2:
+			name = "dolbye_4x2";
+			break;
+		case PROGCONFIG_5_1:
+			name = "dolbye_5.1";
+			break;
+		default:
+			return(NULL);
+	}
+
+	switch(frameRate)
+	{
+		case FRAMERATE_25:
+			return(Find(name + "_sadm_pal_tplt.xml"));
+		case FRAMERATE_29_97:
+			return(Find(name + "_sadm_ntsc_tplt.xml"));
+		default:
+			return(NULL);
+	}
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+const SadmTemplate *SadmTemplateSet::SelectAudioFormatExtended(int progConfig, const int acmod[], const int bsmod[]) const
+{
+	switch(progConfig)
+	{
+		case PROGCONFIG_5_1_2:
+			// Second programme is always 2.0, it may be audio description
+			if (acmod[1] != 2)
+			{
+				return(NULL);
+			}
+			if (acmod[0] == 7)
+			{
+				return(Find((bsmod[1] == 2) ? "dolbye_5.1+2_ad_adm_tplt.xml" : "dolbye_5.1+2_adm_tplt.xml"));
+			}
+			if (acmod[0] == 2)
+			{
+				return(Find("dolbye_5.1+2_adm_tplt_alt_2.0.xml"));
+			}
+			return(NULL);
+		case PROGCONFIG_2_2_2_2:
+			for (int progNo = 0 ; progNo < 4 ; progNo++)
+			{
+				if (acmod[progNo] != 2)
+				{
+					return(NULL);
+				}
+			}
+			return(Find("dolbye_4x2_adm_tplt.xml"));
+		case PROGCONFIG_5_1:
+			return((acmod[0] == 7) ? Find("dolbye_5.1_adm_tplt.xml") : NULL);
+		default:
+			return(NULL);
+	}
+}
+/**************************************************************************************************************************************************************/
@@ -0,0 +1,132 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_SADM_TEMPLATE_H_
+#define		_SADM_TEMPLATE_H_
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "ddeinfo.h"
+#include "sadm_sink.h"
+
+/* Template compiled into the binary by cmake/EmbedTemplates.cmake */
+struct SadmEmbeddedTemplate
+{
+	const char *name;					/* file name in Templates/ */
+	const unsigned char *data;
+	size_t size;
+};
+
+extern const SadmEmbeddedTemplate sadmEmbeddedTemplates[];
+extern const size_t nSadmEmbeddedTemplates;
+
+/* Parts of a template that are replaced per frame */
+enum SadmSlot
+{
+	SLOT_FLOW_ID,						/* frameFormat flowID attribute value */
+	SLOT_DURATION,						/* frameFormat duration attribute value */
+	SLOT_DIALOGUE_LOUDNESS,				/* dialogueLoudness element value, per programme */
+	SLOT_DBMD,							/* <!-- dbmd goes here --> */
+	SLOT_AUDIO_FORMAT_EXTENDED			/* <!-- audioFormatExtended goes here --> */
+};
+
+struct SadmSlotDesc
+{
+	SadmSlot slot;
+	size_t offset;						/* of the template text replaced */
+	size_t length;						/* of the template text replaced */
+	size_t indentOffset;				/* indentation of the line holding the slot, block slots continue at it */
+	size_t indentLength;
+	int progNo;							/* programme of per programme slots */
+};
+
+/* Values filled into the slots */
+struct SadmTemplateFill
+{
+	const char *flowID;
+	const char *duration;
+	int dialogueLoudness[MAX_NPGRMS];
+	std::string dbmd;					/* <dbmd> element, unindented */
+	const class SadmTemplate *audioFormatExtended;
+};
+
+/*	A template with its fill-in plan.
+	Slots are located once when the template is loaded, writing a frame is then
+	a copy of the text between slots plus the slot values */
+class SadmTemplate
+{
+private:
+	std::string text;					/* with CRs removed, first line indentation and trailing white space stripped */
+	std::vector<SadmSlotDesc> slots;	/* in offset order */
+
+	void Compile(void);
+	void AddSlot(SadmSlot slot, size_t offset, size_t length, int progNo);
+	void WriteBody(SadmSink &sink, const SadmTemplateFill &fill, const std::string &indent) const;
+
+public:
+	SadmTemplate(const char *data, size_t size);
+
+	// Write the filled template as a complete document
+	void Write(SadmSink &sink, const SadmTemplateFill &fill) const;
+};
+
+/*	Set of templates keyed by file name.
+	Starts with the embedded templates; a site template directory can be loaded
+	on top, replacing templates of the same name */
+class SadmTemplateSet
+{
+private:
+	std::map<std::string, SadmTemplate> templates;
+
+	const SadmTemplate *Find(const std::string &name) const;
+
+public:
+	SadmTemplateSet(void);
+
+	void LoadDirectory(const std::string &dirName);
+
+	// S-ADM frame template for program_config and frame_rate code, NULL if none
+	const SadmTemplate *SelectFrame(int progConfig, int frameRate) const;
+
+	// audioFormatExtended template for program_config and each programme's ac3_acmod and ac3_bsmod, NULL if none
+	const SadmTemplate *SelectAudioFormatExtended(int progConfig, const int acmod[], const int bsmod[]) const;
+};
+
+#endif //		_SADM_TEMPLATE_H_
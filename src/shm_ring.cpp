@@ -0,0 +1,418 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <algorithm>
+#include <stdexcept>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "shm_ring.h"
+
+#define SHM_RING_POLL_US	100		/* wait between checks where there is no futex */
+
+/**************************************************************************************************************************************************************/
+
+static long long NowMs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return((long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+// Wait until seq no longer holds expected, for up to timeoutMs (-1 forever). May return early
+static void WaitSeq(std::atomic<uint32_t> *seq, uint32_t expected, int timeoutMs)
+{
+#ifdef __linux__
+	// Not FUTEX_PRIVATE_FLAG, the word is shared between processes
+	struct timespec ts;
+	struct timespec *tsp = NULL;
+	if (timeoutMs >= 0)
+	{
+		ts.tv_sec = timeoutMs / 1000;
+		ts.tv_nsec = (long)(timeoutMs % 1000) * 1000000;
+		tsp = &ts;
+	}
+	syscall(SYS_futex, (uint32_t *)seq, FUTEX_WAIT, expected, tsp, NULL, 0);
+#else
+	(void)timeoutMs;
+	if (seq->load(std::memory_order_acquire) == expected)
+	{
+		usleep(SHM_RING_POLL_US);
+	}
+#endif
+}
+
+static void WakeSeq(std::atomic<uint32_t> *seq)
+{
+#ifdef __linux__
+	syscall(SYS_futex, (uint32_t *)seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#else
+	(void)seq;
+#endif
+}
+
+static std::string ShmName(const std::string &ringName)
+{
+	return((!ringName.empty() && ringName[0] == '/') ? ringName : "/" + ringName);
+}
+
+/**************************************************************************************************************************************************************/
+ShmRing::ShmRing(const std::string &ringName, size_t minCapacity, bool overwriteOldest) :
+	name(ShmName(ringName)), producer(true), fd(-1), map(NULL), mapSz(0), header(NULL), data(NULL), capacity(0)
+{
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	uint64_t dataOffset = std::max((size_t)SHM_RING_HEADER_SZ, page);
+	capacity = ((std::max(minCapacity, (size_t)1) + page - 1) / page) * page;
+
+	fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+	if (fd < 0)
+	{
+		throw std::runtime_error("Error: Unable to create shared memory " + name + ": " + strerror(errno));
+	}
+	if (ftruncate(fd, (off_t)(dataOffset + capacity)) < 0)
+	{
+		int err = errno;
+		close(fd);
+		shm_unlink(name.c_str());
+		throw std::runtime_error("Error: Unable to size shared memory " + name + ": " + strerror(err));
+	}
+
+	// The object is zero filled, so only the constants need setting, magic last
+	uint64_t *fields = (uint64_t *)mmap(NULL, SHM_RING_HEADER_SZ, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (fields == MAP_FAILED)
+	{
+		int err = errno;
+		close(fd);
+		shm_unlink(name.c_str());
+		throw std::runtime_error("Error: Unable to map shared memory " + name + ": " + strerror(err));
+	}
+	ShmRingHeader *h = (ShmRingHeader *)fields;
+	h->version = SHM_RING_VERSION;
+	h->capacity = capacity;
+	h->dataOffset = dataOffset;
+	h->overwrite = overwriteOldest ? 1 : 0;
+	std::atomic_thread_fence(std::memory_order_release);
+	h->magic = SHM_RING_MAGIC;
+	munmap(fields, SHM_RING_HEADER_SZ);
+
+	Map();
+}
+
+ShmRing::ShmRing(const std::string &ringName) :
+	name(ShmName(ringName)), producer(false), fd(-1), map(NULL), mapSz(0), header(NULL), data(NULL), capacity(0)
+{
+	fd = shm_open(name.c_str(), O_RDWR, 0);
+	if (fd < 0)
+	{
+		throw std::runtime_error("Error: Unable to open shared memory " + name + ": " + strerror(errno));
+	}
+
+	struct stat st;
+	ShmRingHeader *h = NULL;
+	if (fstat(fd, &st) == 0 && (size_t)st.st_size >= SHM_RING_HEADER_SZ)
+	{
+		h = (ShmRingHeader *)mmap(NULL, SHM_RING_HEADER_SZ, PROT_READ, MAP_SHARED, fd, 0);
+	}
+	if (h == NULL || h == MAP_FAILED)
+	{
+		close(fd);
+		throw std::runtime_error("Error: Unable to map shared memory " + name);
+	}
+	bool valid = (h->magic == SHM_RING_MAGIC && h->version == SHM_RING_VERSION &&
+				  h->dataOffset + h->capacity == (uint64_t)st.st_size);
+	capacity = h->capacity;
+	munmap(h, SHM_RING_HEADER_SZ);
+	if (!valid)
+	{
+		close(fd);
+		throw std::runtime_error("Error: " + name + " is not a Dolby E ring");
+	}
+
+	Map();
+}
+
+ShmRing::~ShmRing()
+{
+	if (map != NULL)
+	{
+		munmap(map, mapSz);
+	}
+	if (fd >= 0)
+	{
+		close(fd);
+	}
+	if (producer)
+	{
+		shm_unlink(name.c_str());
+	}
+}
+
+// Map the header and data area, then the data area again straight after it, then its first page once more
+// so that reading a word beyond a span that ends at the very end of the mirror is harmless
+void ShmRing::Map(void)
+{
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	uint64_t dataOffset = std::max((size_t)SHM_RING_HEADER_SZ, page);
+
+	mapSz = dataOffset + 2 * capacity + page;
+	void *base = mmap(NULL, mapSz, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (base == MAP_FAILED)
+	{
+		close(fd);
+		if (producer)
+		{
+			shm_unlink(name.c_str());
+		}
+		throw std::runtime_error("Error: Unable to reserve address space for " + name);
+	}
+	map = (uint8_t *)base;
+	if (mmap(map, dataOffset + capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+		mmap(map + dataOffset + capacity, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, (off_t)dataOffset) == MAP_FAILED ||
+		mmap(map + dataOffset + 2 * capacity, page, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, (off_t)dataOffset) == MAP_FAILED)
+	{
+		int err = errno;
+		munmap(map, mapSz);
+		map = NULL;
+		close(fd);
+		if (producer)
+		{
+			shm_unlink(name.c_str());
+		}
+		throw std::runtime_error("Error: Unable to map shared memory " + name + ": " + strerror(err));
+	}
+	header = (ShmRingHeader *)map;
+	data = map + dataOffset;
+}
+
+/**************************************************************************************************************************************************************/
+uint8_t *ShmRing::Reserve(size_t minLen, size_t &len, int timeoutMs)
+{
+	long long deadline = (timeoutMs >= 0) ? NowMs() + timeoutMs : 0;
+
+	minLen = std::min(minLen, (size_t)capacity);
+	if (header->overwrite)
+	{
+		len = (size_t)capacity;
+		return(Overwrite(minLen));
+	}
+	while (1)
+	{
+		uint32_t seq = header->spaceSeq.load(std::memory_order_acquire);
+		uint64_t head = header->head.load(std::memory_order_relaxed);
+		uint64_t tail = header->tail.load(std::memory_order_acquire);
+		len = (size_t)(capacity - (head - tail));
+		if (len >= minLen && len > 0)
+		{
+			return(data + head % capacity);
+		}
+
+		int waitMs = -1;
+		if (timeoutMs >= 0)
+		{
+			long long left = deadline - NowMs();
+			if (left <= 0)
+			{
+				return(NULL);
+			}
+			waitMs = (int)left;
+		}
+		header->producerWaiting.store(1);
+		if (header->tail.load() == tail)
+		{
+			WaitSeq(&header->spaceSeq, seq, waitMs);
+		}
+		header->producerWaiting.store(0, std::memory_order_relaxed);
+	}
+}
+
+void ShmRing::Commit(size_t len)
+{
+	header->head.store(header->head.load(std::memory_order_relaxed) + len, std::memory_order_release);
+	header->dataSeq.fetch_add(1);
+	if (header->consumerWaiting.load())
+	{
+		WakeSeq(&header->dataSeq);
+	}
+}
+
+void ShmRing::Write(const void *src, size_t len)
+{
+	const uint8_t *p = (const uint8_t *)src;
+
+	while (len > 0)
+	{
+		size_t space;
+		uint8_t *dst = Reserve(1, space, -1);
+		size_t n = std::min(len, space);
+		memcpy(dst, p, n);
+		Commit(n);
+		p += n;
+		len -= n;
+	}
+}
+
+void ShmRing::Close(void)
+{
+	header->closed.store(1, std::memory_order_release);
+	header->dataSeq.fetch_add(1);
+	WakeSeq(&header->dataSeq);
+}
+
+uint8_t *ShmRing::Peek(size_t minLen, size_t &len, int timeoutMs)
+{
+	long long deadline = (timeoutMs >= 0) ? NowMs() + timeoutMs : 0;
+
+	while (1)
+	{
+		uint32_t seq = header->dataSeq.load(std::memory_order_acquire);
+		bool closed = Closed();
+		uint64_t tail = header->tail.load(std::memory_order_relaxed);
+		uint64_t head = header->head.load(std::memory_order_acquire);
+		len = (size_t)(head - tail);
+		if (len >= minLen && len > 0)
+		{
+			return(data + tail % capacity);
+		}
+		if (closed)
+		{
+			return(NULL);
+		}
+
+		int waitMs = -1;
+		if (timeoutMs >= 0)
+		{
+			long long left = deadline - NowMs();
+			if (left <= 0)
+			{
+				return(NULL);
+			}
+			waitMs = (int)left;
+		}
+		header->consumerWaiting.store(1);
+		if (header->head.load() == head && !Closed())
+		{
+			WaitSeq(&header->dataSeq, seq, waitMs);
+		}
+		header->consumerWaiting.store(0, std::memory_order_relaxed);
+	}
+}
+
+uint8_t *ShmRing::Overwrite(size_t len)
+{
+	uint64_t head = header->head.load(std::memory_order_relaxed);
+
+	// As a seqlock: readers that copy anything written after the fence see the new reserved after their acquire fence
+	header->reserved.store(head + len, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	return(data + head % capacity);
+}
+
+void ShmRing::SetMark(uint64_t pos)
+{
+	header->mark.store(pos, std::memory_order_release);
+}
+
+bool ShmRing::WaitFor(uint64_t pos, int timeoutMs)
+{
+	long long deadline = (timeoutMs >= 0) ? NowMs() + timeoutMs : 0;
+
+	while (1)
+	{
+		uint32_t seq = header->dataSeq.load(std::memory_order_acquire);
+		bool closed = Closed();
+		uint64_t head = header->head.load(std::memory_order_acquire);
+		if (head > pos)
+		{
+			return(true);
+		}
+		if (closed)
+		{
+			return(false);
+		}
+
+		int waitMs = -1;
+		if (timeoutMs >= 0)
+		{
+			long long left = deadline - NowMs();
+			if (left <= 0)
+			{
+				return(false);
+			}
+			waitMs = (int)left;
+		}
+		// Any number of readers may be waiting, so the flag is only ever set here
+		header->consumerWaiting.store(1);
+		if (header->head.load() == head && !Closed())
+		{
+			WaitSeq(&header->dataSeq, seq, waitMs);
+		}
+	}
+}
+
+bool ShmRing::ReadAt(uint64_t pos, void *dst, size_t len) const
+{
+	if (len > capacity || pos + len > header->head.load(std::memory_order_acquire) ||
+		header->reserved.load(std::memory_order_relaxed) > pos + capacity)
+	{
+		return(false);
+	}
+	memcpy(dst, data + pos % capacity, len);
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return(header->reserved.load(std::memory_order_relaxed) <= pos + capacity);
+}
+
+void ShmRing::Release(size_t len)
+{
+	header->tail.store(header->tail.load(std::memory_order_relaxed) + len, std::memory_order_release);
+	header->spaceSeq.fetch_add(1);
+	if (header->producerWaiting.load())
+	{
+		WakeSeq(&header->spaceSeq);
+	}
+}
+/**************************************************************************************************************************************************************/
@@ -0,0 +1,165 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_SHM_RING_H_
+#define		_SHM_RING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+/*	Single producer, single consumer byte ring in POSIX shared memory (shm_open), used to pass .dde data from a capture
+	process to the converter without pipes or copies.
+
+	Layout of the shared memory object, all integers in native byte order:
+
+		offset 0			ShmRingHeader
+		offset dataOffset	data area of capacity bytes; dataOffset is SHM_RING_HEADER_SZ (4096) or the page size
+							if larger, and capacity a multiple of the page size
+
+	head and tail count bytes written and consumed since creation and never wrap; the byte at position p is held at
+	data offset p % capacity. The producer writes data between head and tail + capacity, then advances head with
+	release ordering; the consumer reads between tail and head, then advances tail with release ordering. Neither
+	side ever writes the other's index. After advancing head the producer increments dataSeq and, if consumerWaiting
+	is set, wakes it with FUTEX_WAKE on dataSeq; the consumer does the same with spaceSeq and producerWaiting after
+	advancing tail. A waiter sets its flag, checks the indices again, then waits on the sequence value it read before
+	checking. closed is set by the producer when it will write no more.
+
+	A ring created with overwrite set has no flow control: the producer never waits for tail, which is unused, and
+	overwrites the oldest data. Readers, any number, keep their own position. Before writing bytes up to position r
+	the producer stores r in reserved, then issues a release fence; a reader copies what it wants, issues an acquire
+	fence and reads reserved again, and the copy of position p is good if p + capacity >= reserved. Record oriented
+	producers store the start of their latest record in mark, where a reader that has been lapped can pick up again.
+
+	The consumer owns the bytes between tail and head until it releases them and may modify them in place
+	(the parser unkeys Dolby E frames where they lie). Each side maps the data area twice, back to back, so that
+	any span of up to capacity bytes starting in the first mapping is contiguous in memory */
+
+#define SHM_RING_MAGIC			0x52454444		/* "DDER" */
+#define SHM_RING_VERSION		1
+#define SHM_RING_HEADER_SZ		4096
+#define SHM_RING_DEFAULT_SZ		(1024 * 1024)
+
+struct ShmRingHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t capacity;								/* bytes in the data area */
+	uint64_t dataOffset;							/* of the data area from the start of the object */
+	alignas(64) std::atomic<uint64_t> head;			/* written by the producer only */
+	std::atomic<uint32_t> dataSeq;
+	std::atomic<uint32_t> consumerWaiting;
+	std::atomic<uint32_t> closed;
+	uint32_t overwrite;								/* no flow control, set at creation */
+	std::atomic<uint64_t> reserved;					/* overwrite mode: producer is writing up to here */
+	std::atomic<uint64_t> mark;						/* start of the latest record, if the producer uses records */
+	alignas(64) std::atomic<uint64_t> tail;			/* written by the consumer only */
+	std::atomic<uint32_t> spaceSeq;
+	std::atomic<uint32_t> producerWaiting;
+};
+
+static_assert(sizeof(ShmRingHeader) <= SHM_RING_HEADER_SZ, "ring header must fit its page");
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+	"ring indices must be lock free to be shared between processes");
+
+/*	One end of a ring. The producer creates the shared memory object and removes its name on destruction,
+	the consumer attaches to an existing one. Errors are reported with std::runtime_error */
+class ShmRing
+{
+private:
+	std::string name;
+	bool producer;
+	int fd;
+	uint8_t *map;						/* header, data area, its mirror and a guard page */
+	size_t mapSz;
+	ShmRingHeader *header;
+	uint8_t *data;
+	uint64_t capacity;
+
+	void Map(void);
+
+public:
+	// Create a ring of at least capacity bytes as its producer
+	ShmRing(const std::string &ringName, size_t minCapacity, bool overwriteOldest = false);
+
+	// Attach to an existing ring as its consumer
+	ShmRing(const std::string &ringName);
+
+	~ShmRing();
+
+	size_t Capacity(void) const { return((size_t)capacity); }
+
+	// Producer: contiguous space for up to len bytes, waiting up to timeoutMs (-1 forever) for at least minLen.
+	// Returns NULL on timeout. Commit() publishes the bytes written there
+	uint8_t *Reserve(size_t minLen, size_t &len, int timeoutMs);
+	void Commit(size_t len);
+
+	// Producer: copy len bytes in, waiting for space as needed
+	void Write(const void *src, size_t len);
+
+	// Producer: no more data will be written
+	void Close(void);
+
+	// Producer, overwrite mode: space for len bytes at the head, announcing that they are about to be overwritten.
+	// May be called again with a larger len before Commit()
+	uint8_t *Overwrite(size_t len);
+
+	// Producer: the start of the latest record
+	void SetMark(uint64_t pos);
+
+	uint64_t Head(void) const { return(header->head.load(std::memory_order_acquire)); }
+	uint64_t Tail(void) const { return(header->tail.load(std::memory_order_acquire)); }
+	uint64_t Mark(void) const { return(header->mark.load(std::memory_order_acquire)); }
+	bool IsOverwrite(void) const { return(header->overwrite != 0); }
+
+	// Reader, overwrite mode: wait up to timeoutMs (-1 forever) for data beyond pos. False on timeout, or once the ring
+	// is closed with none
+	bool WaitFor(uint64_t pos, int timeoutMs);
+
+	// Reader, overwrite mode: copy len bytes from position pos, false if not yet written or overwritten
+	bool ReadAt(uint64_t pos, void *dst, size_t len) const;
+
+	// Consumer: the unconsumed bytes, contiguous, once there are at least minLen of them. Returns NULL on timeout,
+	// or once the ring is closed with fewer than minLen left (len is then what is left). Release() consumes them
+	uint8_t *Peek(size_t minLen, size_t &len, int timeoutMs);
+	void Release(size_t len);
+
+	bool Closed(void) const { return(header->closed.load(std::memory_order_acquire) != 0); }
+};
+
+#endif //		_SHM_RING_H_
@@ -0,0 +1,302 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "timecode_index.h"
+
+/* Frames per second of time code and the frame numbers dropped at each minute but every tenth, per frame_rate_code.
+   As DolbyEParser's last_frame_tab and drop_frame_tab, extended to the high frame rates, where 59.94 drops four */
+static const int tcFramesTab[NFRMRATE] = { 24, 24, 25, 30, 30, 50, 60, 60 };
+static const int tcDropTab[NFRMRATE] = { 2, 0, 0, 2, 0, 0, 4, 0 };
+
+static int32_t HmsfFrames(int hours, int minutes, int seconds, int frame, int frameRateCode)
+{
+	int fps = tcFramesTab[frameRateCode - 1];
+	int dropped = tcDropTab[frameRateCode - 1];
+	int32_t totalMinutes = 60 * hours + minutes;
+	int32_t frames = (totalMinutes * 60 + seconds) * fps + frame;
+
+	frames -= dropped * (totalMinutes - totalMinutes / 10);
+	return(frames);
+}
+
+// A frame number skipped at drop frame rates, which no frame has
+static bool HmsfDropped(int minutes, int seconds, int frame, int frameRateCode)
+{
+	return(seconds == 0 && frame < tcDropTab[frameRateCode - 1] && minutes % 10 != 0);
+}
+
+static void FramesHmsf(int32_t frames, int frameRateCode, int &hours, int &minutes, int &seconds, int &frame)
+{
+	int fps = tcFramesTab[frameRateCode - 1];
+	int dropped = tcDropTab[frameRateCode - 1];
+
+	if (dropped)
+	{
+		// Put back the frame numbers HmsfFrames() skipped
+		int32_t perTenMinutes = 600 * fps - 9 * dropped;
+		int32_t perMinute = 60 * fps - dropped;
+		int32_t tens = frames / perTenMinutes;
+		int32_t rest = frames % perTenMinutes;
+		frames += 9 * dropped * tens + ((rest > dropped) ? dropped * ((rest - dropped) / perMinute) : 0);
+	}
+	hours = (int)(frames / (3600 * fps));
+	minutes = (int)((frames / (60 * fps)) % 60);
+	seconds = (int)((frames / fps) % 60);
+	frame = (int)(frames % fps);
+}
+
+/**************************************************************************************************************************************************************/
+int32_t TimecodeIndex::TimecodeFrames(const int timecode[8], int frameRateCode)
+{
+	if ((timecode[1] & 0x3f) == 0x3f || frameRateCode < 1 || frameRateCode > NFRMRATE)
+	{
+		return(-1);
+	}
+	int hours = (((timecode[1] >> 4) & 0x03) * 10) + (timecode[1] & 0x0f);
+	int minutes = (((timecode[3] >> 4) & 0x07) * 10) + (timecode[3] & 0x0f);
+	int seconds = (((timecode[5] >> 4) & 0x07) * 10) + (timecode[5] & 0x0f);
+	int frame = (((timecode[7] >> 4) & 0x03) * 10) + (timecode[7] & 0x0f);
+	if (hours > 23 || minutes > 59 || seconds > 59 || frame >= tcFramesTab[frameRateCode - 1] ||
+		HmsfDropped(minutes, seconds, frame, frameRateCode))
+	{
+		return(-1);
+	}
+	return(HmsfFrames(hours, minutes, seconds, frame, frameRateCode));
+}
+
+bool TimecodeIndex::ParseTimecode(const char *text, int frameRateCode, int32_t &frames)
+{
+	int hours, minutes, seconds, frame, len = 0;
+	char sep;
+
+	if (frameRateCode < 1 || frameRateCode > NFRMRATE ||
+		sscanf(text, "%2d:%2d:%2d%c%2d%n", &hours, &minutes, &seconds, &sep, &frame, &len) != 5 ||
+		text[len] != '\0' || (sep != ':' && sep != ';' && sep != '.'))
+	{
+		return(false);
+	}
+	if (hours > 23 || minutes > 59 || seconds > 59 || frame >= tcFramesTab[frameRateCode - 1] ||
+		HmsfDropped(minutes, seconds, frame, frameRateCode))
+	{
+		return(false);
+	}
+	frames = HmsfFrames(hours, minutes, seconds, frame, frameRateCode);
+	return(true);
+}
+
+int TimecodeIndex::TimecodeFps(int frameRateCode)
+{
+	return((frameRateCode < 1 || frameRateCode > NFRMRATE) ? 0 : tcFramesTab[frameRateCode - 1]);
+}
+
+std::string TimecodeIndex::TimecodeText(int32_t frames, int frameRateCode)
+{
+	char text[4 * 11 + 4];		/* room for four fields of any int, so the compiler can see it is never truncated */
+	int hours, minutes, seconds, frame;
+
+	if (frames < 0 || frameRateCode < 1 || frameRateCode > NFRMRATE)
+	{
+		return("invalid");
+	}
+	FramesHmsf(frames, frameRateCode, hours, minutes, seconds, frame);
+	snprintf(text, sizeof(text), "%02d:%02d:%02d%c%02d", hours, minutes, seconds, tcDropTab[frameRateCode - 1] ? ';' : ':', frame);
+	return(text);
+}
+
+void TimecodeIndex::SetTimecode(int32_t frames, int frameRateCode, int timecode[8])
+{
+	int hours, minutes, seconds, frame;
+
+	// Frame numbers from 40 have no room in the two bit tens digit
+	if (frames < 0 || frameRateCode < 1 || frameRateCode > NFRMRATE || tcFramesTab[frameRateCode - 1] > 40)
+	{
+		return;
+	}
+	FramesHmsf(frames % HmsfFrames(24, 0, 0, 0, frameRateCode), frameRateCode, hours, minutes, seconds, frame);
+	timecode[1] = (timecode[1] & ~0x3f) | ((hours / 10) << 4) | (hours % 10);
+	timecode[3] = (timecode[3] & ~0x7f) | ((minutes / 10) << 4) | (minutes % 10);
+	timecode[5] = (timecode[5] & ~0x7f) | ((seconds / 10) << 4) | (seconds % 10);
+	timecode[7] = (timecode[7] & ~0x3f) | ((frame / 10) << 4) | (frame % 10);
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+void TimecodeIndex::Clear(void)
+{
+	runs.clear();
+	byTimecode.clear();
+	maxEnd.clear();
+	frames = 0;
+	frameRate = 0;
+}
+
+void TimecodeIndex::Add(uint64_t offset, const int timecode[8], int frameRateCode)
+{
+	int32_t tc = TimecodeFrames(timecode, frameRateCode);
+
+	if (frameRate == 0)
+	{
+		frameRate = frameRateCode;
+	}
+	if (!runs.empty() && frameRateCode == frameRate)
+	{
+		TimecodeRun &run = runs.back();
+		uint64_t last = run.offset + (uint64_t)(run.count - 1) * run.stride;
+		bool spaced = (run.count == 1) ? (offset > run.offset && offset - run.offset <= UINT32_MAX) : (offset == last + run.stride);
+		bool counting = (run.firstTimecode < 0) ? (tc < 0) : (tc == run.firstTimecode + (int32_t)run.count);
+
+		if (spaced && counting)
+		{
+			if (run.count == 1)
+			{
+				run.stride = (uint32_t)(offset - run.offset);
+			}
+			run.count++;
+			frames++;
+			return;
+		}
+	}
+	runs.push_back({ offset, 0, frames, 1, tc });
+	frames++;
+}
+
+void TimecodeIndex::Finish(void)
+{
+	byTimecode.clear();
+	for (uint32_t i = 0 ; i < runs.size() ; i++)
+	{
+		if (runs[i].firstTimecode >= 0)
+		{
+			byTimecode.push_back(i);
+		}
+	}
+	// Stable, so runs with the same start stay in file order
+	std::stable_sort(byTimecode.begin(), byTimecode.end(),
+		[this](uint32_t a, uint32_t b) { return(runs[a].firstTimecode < runs[b].firstTimecode); });
+
+	maxEnd.resize(byTimecode.size());
+	int32_t end = -1;
+	for (size_t i = 0 ; i < byTimecode.size() ; i++)
+	{
+		const TimecodeRun &run = runs[byTimecode[i]];
+		end = std::max(end, run.firstTimecode + (int32_t)run.count);
+		maxEnd[i] = end;
+	}
+}
+/**************************************************************************************************************************************************************/
+
+
+void TimecodeIndex::Load(const TimecodeRun *saved, size_t count, int frameRateCode)
+{
+	runs.assign(saved, saved + count);
+	frames = runs.empty() ? 0 : runs.back().firstFrame + runs.back().count;
+	frameRate = frameRateCode;
+	Finish();
+}
+/**************************************************************************************************************************************************************/
+
+
+/**************************************************************************************************************************************************************/
+bool TimecodeIndex::FrameOffset(uint32_t frameNo, uint64_t &offset) const
+{
+	if (frameNo >= frames)
+	{
+		return(false);
+	}
+	std::vector<TimecodeRun>::const_iterator run = std::upper_bound(runs.begin(), runs.end(), frameNo,
+		[](uint32_t frame, const TimecodeRun &r) { return(frame < r.firstFrame); }) - 1;
+	offset = run->offset + (uint64_t)(frameNo - run->firstFrame) * run->stride;
+	return(true);
+}
+
+int32_t TimecodeIndex::FrameTimecode(uint32_t frameNo) const
+{
+	if (frameNo >= frames)
+	{
+		return(-1);
+	}
+	std::vector<TimecodeRun>::const_iterator run = std::upper_bound(runs.begin(), runs.end(), frameNo,
+		[](uint32_t frame, const TimecodeRun &r) { return(frame < r.firstFrame); }) - 1;
+	return((run->firstTimecode < 0) ? -1 : run->firstTimecode + (int32_t)(frameNo - run->firstFrame));
+}
+
+bool TimecodeIndex::FindTimecode(int32_t timecode, uint32_t &frameNo) const
+{
+	// Runs starting at or before the time code, latest start first, while any of them could still contain it
+	size_t i = std::upper_bound(byTimecode.begin(), byTimecode.end(), timecode,
+		[this](int32_t tc, uint32_t r) { return(tc < runs[r].firstTimecode); }) - byTimecode.begin();
+	bool found = false;
+
+	while (i > 0 && maxEnd[i - 1] > timecode)
+	{
+		const TimecodeRun &run = runs[byTimecode[--i]];
+		if (timecode < run.firstTimecode + (int32_t)run.count)
+		{
+			uint32_t frame = run.firstFrame + (uint32_t)(timecode - run.firstTimecode);
+			if (!found || frame < frameNo)
+			{
+				frameNo = frame;
+				found = true;
+			}
+		}
+	}
+	return(found);
+}
+
+bool TimecodeIndex::FindPosition(const char *text, uint32_t &frameNo) const
+{
+	if (strpbrk(text, ":;") != NULL)
+	{
+		int32_t timecode;
+		return(ParseTimecode(text, frameRate, timecode) && FindTimecode(timecode, frameNo));
+	}
+	char *end;
+	unsigned long frame = strtoul(text, &end, 10);
+	if (*text == '\0' || *end != '\0' || frame >= frames)
+	{
+		return(false);
+	}
+	frameNo = (uint32_t)frame;
+	return(true);
+}
+/**************************************************************************************************************************************************************/
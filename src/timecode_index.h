@@ -0,0 +1,116 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_TIMECODE_INDEX_H_
+#define		_TIMECODE_INDEX_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "ddeinfo.h"
+
+/* A run of frames at equal spacing in the file whose time codes count up by one frame each */
+struct TimecodeRun
+{
+	uint64_t offset;				/* of the first frame's preamble */
+	uint32_t stride;				/* bytes from one frame to the next, 0 until the run has two frames */
+	uint32_t firstFrame;			/* # frames in the file before this run */
+	uint32_t count;
+	int32_t firstTimecode;			/* frames since midnight, -1 for invalid time codes */
+};
+
+/*	Maps frame numbers and SMPTE time codes to file offsets. Frames are added in file order and
+	stored as runs, so an index for a file without discontinuities is a single entry. A time code
+	jump, a change of spacing or midnight starts a new run, so each run's time codes increase
+	monotonically and lookups are binary searches. Where a time code occurs more than once,
+	lookups find the first occurrence in the file */
+class TimecodeIndex
+{
+private:
+	std::vector<TimecodeRun> runs;			/* file order */
+	std::vector<uint32_t> byTimecode;		/* runs with valid time codes in order of firstTimecode */
+	std::vector<int32_t> maxEnd;			/* greatest end time code of byTimecode[0..i] */
+	uint32_t frames = 0;
+	int frameRate = 0;
+
+public:
+	void Clear(void);
+
+	// Add the next frame in the file, then Finish() once all are added
+	void Add(uint64_t offset, const int timecode[8], int frameRateCode);
+	void Finish(void);
+
+	// Replace the index with runs saved from Runs(), e.g. in a metadata timeline
+	void Load(const TimecodeRun *saved, size_t count, int frameRateCode);
+
+	uint32_t FrameCount(void) const { return(frames); }
+	int FrameRate(void) const { return(frameRate); }
+	const std::vector<TimecodeRun> &Runs(void) const { return(runs); }
+
+	// File offset of frame frameNo (from 0). Returns false if there is no such frame
+	bool FrameOffset(uint32_t frameNo, uint64_t &offset) const;
+
+	// Time code of frame frameNo, as frames since midnight, -1 if invalid or there is no such frame
+	int32_t FrameTimecode(uint32_t frameNo) const;
+
+	// Frame number of the first frame with the time code, as frames since midnight. Returns false if not found
+	bool FindTimecode(int32_t timecode, uint32_t &frameNo) const;
+
+	// As FindTimecode() for "hh:mm:ss:ff", otherwise text is a frame number. Returns false if malformed or not found
+	bool FindPosition(const char *text, uint32_t &frameNo) const;
+
+	// BCD SMPTE_time_code as frames since midnight, -1 if invalid. Drop frame rates count as check_time_code() does,
+	// and four frame numbers a minute are dropped at 59.94. A frame number that is dropped is invalid
+	static int32_t TimecodeFrames(const int timecode[8], int frameRateCode);
+
+	// "hh:mm:ss:ff" (or ';' before ff) as frames since midnight. Returns false if malformed or a dropped frame number
+	static bool ParseTimecode(const char *text, int frameRateCode, int32_t &frames);
+
+	// Nominal time code frames per second of a frame_rate_code, 0 if invalid
+	static int TimecodeFps(int frameRateCode);
+
+	// Frames since midnight as "hh:mm:ss:ff" (';' before ff at drop frame rates), "invalid" if negative
+	static std::string TimecodeText(int32_t frames, int frameRateCode);
+
+	// Frames since midnight, wrapping at midnight, into the digits of BCD SMPTE_time_code, its other bits unchanged.
+	// Left unchanged at frame rates over 40, whose frame numbers do not fit
+	static void SetTimecode(int32_t frames, int frameRateCode, int timecode[8]);
+};
+
+#endif //		_TIMECODE_INDEX_H_
@@ -0,0 +1,137 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+#ifndef		_WORK_QUEUE_H_
+#define		_WORK_QUEUE_H_
+
+#include <stddef.h>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/*	Fixed pool of worker threads taking jobs from a bounded queue.
+	Submit() blocks while the queue is full, pushing back on whoever produces the work */
+class WorkQueue
+{
+private:
+	std::mutex mutex;
+	std::condition_variable notEmpty;
+	std::condition_variable notFull;
+	std::deque<std::function<void(void)>> jobs;
+	size_t capacity;
+	bool closed = false;
+	std::vector<std::thread> workers;
+
+	void Worker(void)
+	{
+		while (1)
+		{
+			std::function<void(void)> job;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				notEmpty.wait(lock, [this] { return(closed || !jobs.empty()); });
+				if (jobs.empty())
+				{
+					return;
+				}
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+			notFull.notify_one();
+			job();
+		}
+	}
+
+public:
+	WorkQueue(unsigned int nThreads, size_t queueCapacity) : capacity(queueCapacity)
+	{
+		for (unsigned int i = 0 ; i < nThreads ; i++)
+		{
+			workers.emplace_back(&WorkQueue::Worker, this);
+		}
+	}
+
+	~WorkQueue()
+	{
+		Join();
+	}
+
+	// Queue a job, waiting for space. Returns false if the queue has been closed
+	bool Submit(std::function<void(void)> job)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			notFull.wait(lock, [this] { return(closed || jobs.size() < capacity); });
+			if (closed)
+			{
+				return(false);
+			}
+			jobs.push_back(std::move(job));
+		}
+		notEmpty.notify_one();
+		return(true);
+	}
+
+	// Refuse new jobs, the workers finish the ones already queued then exit
+	void Close(void)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			closed = true;
+		}
+		notEmpty.notify_all();
+		notFull.notify_all();
+	}
+
+	// Close and wait for the jobs already queued to finish
+	void Join(void)
+	{
+		Close();
+		for (std::thread &worker : workers)
+		{
+			if (worker.joinable())
+			{
+				worker.join();
+			}
+		}
+	}
+};
+
+#endif //		_WORK_QUEUE_H_
@@ -0,0 +1,156 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*	Checks of ContinuityScanner frame spacing: files built from a fixture with the frames spaced in the cadences of
+	29.97 and 59.94 fps have no discontinuities, and a lost frame or a change of spacing is reported once.
+	Run by ctest and run_test.sh from the top of the tree; prints each failure and exits non-zero if there are any */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "continuity_scan.h"
+
+#define FIXTURE			"test/dde/5.1-1.dde"
+#define FIXTURE_STRIDE	14608		/* bytes between its frames */
+#define SAMPLE_SZ		8			/* the extra bytes of the longer frames of a cadence */
+
+static int failures = 0;
+
+static void Check(bool ok, const std::string &what)
+{
+	if (!ok)
+	{
+		fprintf(stderr, "FAIL: %s\n", what.c_str());
+		failures++;
+	}
+}
+
+// The fixture's frames, each followed by pad(frame) zero bytes, with frame blank zeroed as if its sync were lost
+static std::vector<ContinuityEvent> Scan(const std::string &what, size_t (*pad)(size_t), size_t blank, uint64_t &frames)
+{
+	std::ifstream in(FIXTURE, std::ios::binary);
+	std::string dde((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	std::string name = "/tmp/continuity_scan_test_" + std::to_string(getpid()) + ".dde";
+	std::ofstream out(name, std::ios::binary);
+
+	Check(dde.size() > 0 && dde.size() % FIXTURE_STRIDE == 0, what + ": unable to read " FIXTURE);
+	for (size_t frame = 0 ; frame < dde.size() / FIXTURE_STRIDE ; frame++)
+	{
+		out.write((frame != blank) ? dde.data() + frame * FIXTURE_STRIDE : std::string(FIXTURE_STRIDE, '\0').data(), FIXTURE_STRIDE);
+		out.write(std::string(pad(frame), '\0').data(), pad(frame));
+	}
+	out.close();
+
+	ContinuityScanner scanner(name, 1);
+	scanner.Scan();
+	unlink(name.c_str());
+	frames = scanner.FrameCount();
+	return(scanner.Events());
+}
+
+static size_t Count(const std::vector<ContinuityEvent> &events, ContinuityEventType type)
+{
+	size_t n = 0;
+	for (const ContinuityEvent &event : events)
+	{
+		n += (event.type == type) ? 1 : 0;
+	}
+	return(n);
+}
+
+// 1602, 1601, 1602, 1601, 1602 samples a frame at 29.97, and four of 801 with one of 800 at 59.94
+static size_t Pad2997(size_t frame)
+{
+	return(((frame % 5) % 2 == 0) ? SAMPLE_SZ : 0);
+}
+
+static size_t Pad5994(size_t frame)
+{
+	return((frame % 5 != 4) ? SAMPLE_SZ : 0);
+}
+
+static size_t PadChange(size_t frame)
+{
+	return(Pad2997(frame) + ((frame >= 13) ? FIXTURE_STRIDE / 2 : 0));
+}
+
+static void CheckCadence(void)
+{
+	uint64_t frames;
+	std::vector<ContinuityEvent> events = Scan("29.97", Pad2997, SIZE_MAX, frames);
+	Check(frames == 26, "29.97: " + std::to_string(frames) + " frames");
+	Check(events.empty(), "29.97: " + std::to_string(events.size()) + " discontinuities");
+
+	events = Scan("59.94", Pad5994, SIZE_MAX, frames);
+	Check(frames == 26, "59.94: " + std::to_string(frames) + " frames");
+	Check(events.empty(), "59.94: " + std::to_string(events.size()) + " discontinuities");
+}
+
+// A frame lost to a damaged preamble is one spacing discontinuity, not a second where the spacing returns to the cadence
+static void CheckLostFrame(void)
+{
+	uint64_t frames;
+	std::vector<ContinuityEvent> events = Scan("lost frame", Pad2997, 12, frames);
+	Check(frames == 25, "lost frame: " + std::to_string(frames) + " frames");
+	Check(Count(events, CONT_SPACING) == 1 && events[0].type == CONT_SPACING && events[0].frameNo == 12,
+		"lost frame: spacing discontinuities");
+	Check(Count(events, CONT_FRAME_COUNT) == 1, "lost frame: frame_count discontinuities");
+	Check(Count(events, CONT_TIMECODE) == 1, "lost frame: time code discontinuities");
+}
+
+// Frames spaced further apart from frame 13 on are reported at frame 13 only
+static void CheckSpacingChange(void)
+{
+	uint64_t frames;
+	std::vector<ContinuityEvent> events = Scan("spacing change", PadChange, SIZE_MAX, frames);
+	Check(Count(events, CONT_SPACING) == 1 && events.size() == 1 && events[0].frameNo == 14,
+		"spacing change: " + std::to_string(events.size()) + " discontinuities");
+}
+
+int main(void)
+{
+	CheckCadence();
+	CheckLostFrame();
+	CheckSpacingChange();
+
+	printf("ContinuityScanner: %s, %d failures\n", failures ? "FAIL" : "pass", failures);
+	return(failures ? 1 : 0);
+}
@@ -0,0 +1,128 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*	Checks that the CRC kernels agree: DolbyECrc16() (carry-less multiplication where the CPU has it),
+	DolbyECrc16Table() and the bitwise reference DolbyECrc16Bitwise(), on random words of each Dolby E word size,
+	for every length up to well past the fold width, at each alignment and from random starting CRCs.
+	Run by ctest and run_test.sh; prints each failure and exits non-zero if there are any */
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <random>
+
+#include "dolbye_crc.h"
+
+#define MAX_WORDS		300			/* all lengths up to this, several times the 16 word fold threshold */
+#define FRAME_WORDS		3652		/* a 25 fps frame of 20 bit words, checked too */
+#define ALIGNMENTS		4			/* word offsets into a 16 byte aligned buffer */
+
+static const int wordSizes[] = { 16, 20, 24 };
+
+static int failures = 0;
+
+static void Check(bool ok, const std::string &what)
+{
+	if (!ok)
+	{
+		fprintf(stderr, "FAIL: %s\n", what.c_str());
+		failures++;
+	}
+}
+
+// Random words, with random bits below the word size too, which every kernel must ignore
+static void CheckLength(std::mt19937 &random, std::vector<int32_t> &buf, int wordSz, int nWords)
+{
+	for (int align = 0 ; align < ALIGNMENTS ; align++)
+	{
+		for (int i = 0 ; i < nWords ; i++)
+		{
+			buf[align + i] = (int32_t)random();
+		}
+		unsigned int crc = random() & 0xffff;
+		const int32_t *words = &buf[align];
+		unsigned int expected = DolbyECrc16Bitwise(words, nWords, wordSz, crc);
+		unsigned int table = DolbyECrc16Table(words, nWords, wordSz, crc);
+		unsigned int fast = DolbyECrc16(words, nWords, wordSz, crc);
+		if (table != expected || fast != expected)
+		{
+			Check(false, std::to_string(wordSz) + " bit words, " + std::to_string(nWords) + " words at offset " +
+				std::to_string(align) + ": bitwise " + std::to_string(expected) + ", table " + std::to_string(table) +
+				", " + (DolbyECrcClmul() ? "clmul " : "default ") + std::to_string(fast));
+		}
+	}
+}
+
+// Words followed by their CRC word, as in a segment, check as zero
+static void CheckSegment(std::mt19937 &random, int wordSz)
+{
+	std::vector<int32_t> words(FRAME_WORDS + 1);
+	for (int i = 0 ; i < FRAME_WORDS ; i++)
+	{
+		words[i] = (int32_t)(random() & (~0u << (32 - wordSz)));
+	}
+	// The CRC is right justified, so it covers the zero bits above it in its word too
+	const int32_t zero = 0;
+	unsigned int crc = DolbyECrc16Bitwise(words.data(), FRAME_WORDS, wordSz);
+	if (wordSz > 16)
+	{
+		crc = DolbyECrc16Bitwise(&zero, 1, wordSz - 16, crc);
+	}
+	words[FRAME_WORDS] = (int32_t)(crc << (32 - wordSz));
+	Check(DolbyECrc16(words.data(), FRAME_WORDS + 1, wordSz) == 0 && DolbyECrc16Table(words.data(), FRAME_WORDS + 1, wordSz) == 0,
+		std::to_string(wordSz) + " bit segment with its CRC word does not check as zero");
+}
+
+int main(void)
+{
+	std::mt19937 random(20250826);
+	std::vector<int32_t> buf(FRAME_WORDS + ALIGNMENTS);
+
+	for (int wordSz : wordSizes)
+	{
+		for (int nWords = 0 ; nWords <= MAX_WORDS ; nWords++)
+		{
+			CheckLength(random, buf, wordSz, nWords);
+		}
+		CheckLength(random, buf, wordSz, FRAME_WORDS);
+		CheckSegment(random, wordSz);
+	}
+
+	printf("DolbyECrc16: %s, %d failures, %s\n", failures ? "FAIL" : "pass", failures,
+		   DolbyECrcClmul() ? "carry-less multiplication checked" : "no carry-less multiplication on this CPU, table checked");
+	return(failures ? 1 : 0);
+}
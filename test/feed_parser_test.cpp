@@ -0,0 +1,233 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*	Checks of the push mode parser: fixtures fed to DolbyEParser::Feed() in awkward chunks (single bytes, chunks that
+	split the preamble sync word and the metadata segment) and presented to ParseInPlace() a few words at a time give
+	the frames of the file mode parse and the S-ADM of a single Feed(), and in early metadata mode each frame's S-ADM
+	is written before its last word has been fed.
+	Run by ctest and run_test.sh from the top of the tree; prints each failure and exits non-zero if there are any */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "dolbye_parser.h"
+#include "sadm_sink.h"
+
+#define FLOWID_NS		"3f2504e0-4f89-11d3-9a0c-0305e82c3301"
+#define FIXTURE_STRIDE	14608		/* bytes between the fixtures' frames */
+
+static const char *fixtures[] = { "test/dde/5.1-1.dde", "test/dde/2+2-1.dde" };
+
+static int failures = 0;
+
+static void Check(bool ok, const std::string &what)
+{
+	if (!ok)
+	{
+		fprintf(stderr, "FAIL: %s\n", what.c_str());
+		failures++;
+	}
+}
+
+// What a parse produced: the frames handed to the frame callback and each frame's S-ADM
+struct Parsed
+{
+	std::vector<FrameInfoStruct> frames;
+	std::vector<std::string> sadm;
+	std::string partial;
+};
+
+static std::string ReadFile(const char *fileName)
+{
+	std::ifstream in(fileName, std::ios::binary);
+	return(std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>()));
+}
+
+// File mode: frames parsed from the file one at a time
+static std::vector<FrameInfoStruct> ParseFile(const char *fileName)
+{
+	std::vector<FrameInfoStruct> frames;
+	DolbyEParser parser(fileName);
+	std::string xml;
+
+	for (unsigned int frame = 0 ; frame < parser.GetFrameCount() ; frame++)
+	{
+		parser.GetNextFrame();
+		parser.GenerateSadmXML(xml);
+		frames.push_back(parser.GetFrameInfo());
+	}
+	return(frames);
+}
+
+static void Attach(DolbyEParser &parser, Parsed &parsed, CallbackSink &sink, bool earlyMetadata)
+{
+	parser.SetDeterministicFlowID(FLOWID_NS);
+	parser.SetEarlyMetadata(earlyMetadata);
+	parser.SetSadmSink(&sink);
+	parser.SetFrameCallback([&parsed](const FrameInfoStruct &frameInfo) { parsed.frames.push_back(frameInfo); });
+}
+
+// Feed the file in chunks of the sizes given, cycling through them
+static Parsed Feed(const std::string &dde, const std::vector<size_t> &chunks, bool earlyMetadata)
+{
+	Parsed parsed;
+	DolbyEParser parser;
+	CallbackSink sink([&parsed](const unsigned char *data, size_t len) { parsed.partial.append((const char *)data, len); },
+					  [&parsed]() { parsed.sadm.push_back(parsed.partial); parsed.partial.clear(); });
+	Attach(parser, parsed, sink, earlyMetadata);
+
+	for (size_t pos = 0, chunk = 0 ; pos < dde.size() ; chunk = (chunk + 1) % chunks.size())
+	{
+		size_t len = std::min(chunks[chunk], dde.size() - pos);
+		parser.Feed((const uint8_t *)dde.data() + pos, len);
+		pos += len;
+	}
+	return(parsed);
+}
+
+// Present the file to ParseInPlace() from a buffer, wordsPerCall more words each time
+static Parsed ParseInPlace(const std::string &dde, size_t wordsPerCall, bool earlyMetadata)
+{
+	Parsed parsed;
+	DolbyEParser parser;
+	CallbackSink sink([&parsed](const unsigned char *data, size_t len) { parsed.partial.append((const char *)data, len); },
+					  [&parsed]() { parsed.sadm.push_back(parsed.partial); parsed.partial.clear(); });
+	Attach(parser, parsed, sink, earlyMetadata);
+
+	// Unkeyed in place, so a copy, with room for the word beyond the end that may be read
+	std::vector<uint8_t> data(dde.begin(), dde.end());
+	data.resize(dde.size() + FILE_WORD_SZ);
+	size_t size = dde.size() - dde.size() % FILE_WORD_SZ;
+	size_t pos = 0;
+	for (size_t end = 0 ; end < size ; )
+	{
+		end = std::min(end + wordsPerCall * FILE_WORD_SZ, size);
+		size_t consumed = 0;
+		parser.ParseInPlace(&data[pos], end - pos, consumed);
+		pos += consumed;
+	}
+	return(parsed);
+}
+
+// The frames of a push mode parse are those of the file mode parse, and its S-ADM that of a single Feed()
+static void Compare(const Parsed &parsed, const std::vector<FrameInfoStruct> &fileFrames, const Parsed &single, const std::string &what)
+{
+	Check(parsed.frames.size() == fileFrames.size(), what + ": " + std::to_string(parsed.frames.size()) + " frames, expected " +
+		std::to_string(fileFrames.size()));
+	for (size_t frame = 0 ; frame < std::min(parsed.frames.size(), fileFrames.size()) ; frame++)
+	{
+		Check(memcmp(&parsed.frames[frame], &fileFrames[frame], offsetof(FrameInfoStruct, Meter)) == 0,
+			what + ": frame " + std::to_string(frame) + " metadata differs from the file mode parse");
+	}
+	Check(parsed.sadm == single.sadm, what + ": S-ADM differs from a single Feed()");
+	Check(parsed.partial.empty(), what + ": unfinished S-ADM frame");
+}
+
+// Cuts in every frame: in the middle of the preamble's sync word, just after the preamble and in the metadata segment
+static std::vector<size_t> SplitChunks(void)
+{
+	size_t preamble = PREAMBLE_SZ * FILE_WORD_SZ;
+	return(std::vector<size_t>({ 2, preamble - 2 + 3, 97, FIXTURE_STRIDE - (preamble + 3 + 97) }));
+}
+
+static void CheckChunks(const char *fileName)
+{
+	std::string dde = ReadFile(fileName);
+	std::vector<FrameInfoStruct> fileFrames = ParseFile(fileName);
+	Parsed single = Feed(dde, { dde.size() }, false);
+	std::string name = fileName;
+
+	Check(!dde.empty() && !fileFrames.empty(), name + ": unable to read");
+	Compare(single, fileFrames, single, name + " single Feed()");
+	Compare(Feed(dde, { 1 }, false), fileFrames, single, name + " 1 byte chunks");
+	Compare(Feed(dde, { 3, 5, 7, 1021 }, false), fileFrames, single, name + " odd chunks");
+	Compare(Feed(dde, SplitChunks(), false), fileFrames, single, name + " split sync and metadata");
+	Compare(Feed(dde, { 1 }, true), fileFrames, single, name + " early metadata, 1 byte chunks");
+	Compare(Feed(dde, SplitChunks(), true), fileFrames, single, name + " early metadata, split sync and metadata");
+	Compare(ParseInPlace(dde, 1, false), fileFrames, single, name + " in place, a word at a time");
+	Compare(ParseInPlace(dde, 37, true), fileFrames, single, name + " in place, early metadata");
+}
+
+// Early metadata: the S-ADM is written once the metadata segment is in, before the frame callback, which waits for
+// the frame's last word
+static void CheckEarly(const char *fileName)
+{
+	std::string dde = ReadFile(fileName);
+	std::string name = fileName;
+	Parsed parsed;
+	DolbyEParser parser;
+	CallbackSink sink([&parsed](const unsigned char *data, size_t len) { parsed.partial.append((const char *)data, len); },
+					  [&parsed]() { parsed.sadm.push_back(parsed.partial); parsed.partial.clear(); });
+	Attach(parser, parsed, sink, true);
+
+	// The first frame up to the start of its last word
+	size_t pos = 0;
+	for ( ; pos < FIXTURE_STRIDE - FILE_WORD_SZ ; pos++)
+	{
+		parser.Feed((const uint8_t *)dde.data() + pos, 1);
+		if (!parsed.sadm.empty())
+		{
+			break;
+		}
+	}
+	Check(parsed.sadm.size() == 1 && parsed.frames.empty(), name + ": no early S-ADM before the first frame completed");
+	Check(pos < FIXTURE_STRIDE / 4, name + ": early S-ADM written after byte " + std::to_string(pos) + " of the first frame");
+
+	parser.Feed((const uint8_t *)dde.data() + pos + 1, FIXTURE_STRIDE - FILE_WORD_SZ - pos - 1);
+	Check(parsed.sadm.size() == 1 && parsed.frames.empty(), name + ": frame callback before the frame completed");
+	parser.Feed((const uint8_t *)dde.data() + FIXTURE_STRIDE - FILE_WORD_SZ, FILE_WORD_SZ);
+	Check(parsed.frames.size() == 1, name + ": no frame callback once the frame completed");
+}
+
+int main(void)
+{
+	DolbyEParser::XmlInitialize();
+	for (const char *fileName : fixtures)
+	{
+		CheckChunks(fileName);
+		CheckEarly(fileName);
+	}
+	DolbyEParser::XmlTerminate();
+
+	printf("DolbyEParser push mode: %s, %d failures\n", failures ? "FAIL" : "pass", failures);
+	return(failures ? 1 : 0);
+}
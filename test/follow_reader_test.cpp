@@ -0,0 +1,148 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*	Checks of FollowReader on a file appended to between reads and rotated: by rename with the old file still being
+	written, by truncation and by deletion. What was written to the old file is read before the new one, and the
+	first read of a new file reports restarted. Run by ctest and run_test.sh; prints each failure and exits non-zero
+	if there are any */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <chrono>
+
+#include "follow_reader.h"
+
+#define READ_TIMEOUT_MS		2000		/* longest wait for bytes that have been written */
+#define IDLE_TIMEOUT_MS		100			/* wait for bytes that should not come */
+
+static int failures = 0;
+
+static void Check(bool ok, const std::string &what)
+{
+	if (!ok)
+	{
+		fprintf(stderr, "FAIL: %s\n", what.c_str());
+		failures++;
+	}
+}
+
+static void Write(const std::string &name, const char *mode, const std::string &text)
+{
+	FILE *fp = fopen(name.c_str(), mode);
+	Check(fp != NULL, "unable to write " + name);
+	if (fp != NULL)
+	{
+		fwrite(text.data(), 1, text.size(), fp);
+		fclose(fp);
+	}
+}
+
+// One Read(), checked to return expected and to set restarted as given
+static void Expect(FollowReader &reader, const std::string &expected, bool restart, const std::string &what)
+{
+	uint8_t buf[64];
+	bool restarted;
+	size_t n = reader.Read(buf, sizeof(buf), expected.empty() ? IDLE_TIMEOUT_MS : READ_TIMEOUT_MS, restarted);
+	std::string text((const char *)buf, n);
+	Check(text == expected, what + ": read \"" + text + "\", expected \"" + expected + "\"");
+	Check(restarted == restart, what + ": restarted " + (restarted ? "set" : "not set"));
+}
+
+int main(void)
+{
+	std::string name = "/tmp/follow_reader_test_" + std::to_string(getpid());
+	std::string rotated = name + ".1";
+
+	Write(name, "wb", "abc");
+	{
+		FollowReader reader(name);
+		Expect(reader, "abc", false, "initial contents");
+		Expect(reader, "", false, "end of file");
+
+		Write(name, "ab", "def");
+		Expect(reader, "def", false, "append between reads");
+		Check(reader.Offset() == 6, "offset after append");
+
+		// Written while Read() waits
+		std::thread writer([&]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(IDLE_TIMEOUT_MS));
+			Write(name, "ab", "ghi");
+		});
+		Expect(reader, "ghi", false, "append during read");
+		writer.join();
+
+		// Renamed, the old file still written to after a new one takes its name
+		FILE *old = fopen(name.c_str(), "ab");
+		rename(name.c_str(), rotated.c_str());
+		Write(name, "wb", "new");
+		fputs("jkl", old);
+		fclose(old);
+		Expect(reader, "jkl", false, "rename: the rest of the old file");
+		Expect(reader, "new", true, "rename: the new file");
+		Expect(reader, "", false, "rename: end of the new file");
+
+		Write(name, "wb", "xy");
+		Expect(reader, "xy", true, "truncation");
+		Check(reader.Offset() == 2, "offset after truncation");
+
+		// Deleted, then some time later created again
+		unlink(name.c_str());
+		Expect(reader, "", false, "deleted");
+		Write(name, "wb", "zz");
+		Expect(reader, "zz", true, "created again");
+	}
+	unlink(name.c_str());
+	unlink(rotated.c_str());
+
+	bool missing = false;
+	try
+	{
+		FollowReader reader(name);
+	}
+	catch (const std::runtime_error &)
+	{
+		missing = true;
+	}
+	Check(missing, "no error for a file that does not exist");
+
+	printf("FollowReader: %s, %d failures\n", failures ? "FAIL" : "pass", failures);
+	return(failures ? 1 : 0);
+}
@@ -0,0 +1,177 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*	Round trip of a metadata timeline: one built from a fixture is written, read back and gives each frame's value of
+	every column, offset and time code as parsed. The file's integers are checked to be little-endian whatever the
+	host, and a truncated file is rejected. Run by ctest and run_test.sh from the top of the tree; prints each failure
+	and exits non-zero if there are any */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdexcept>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "dolbye_parser.h"
+#include "metadata_changes.h"
+#include "metadata_timeline.h"
+
+#define FIXTURE			"test/dde/5.1+2-2.dde"
+
+static int failures = 0;
+
+static void Check(bool ok, const std::string &what)
+{
+	if (!ok)
+	{
+		fprintf(stderr, "FAIL: %s\n", what.c_str());
+		failures++;
+	}
+}
+
+static uint64_t LittleEndian(const std::string &bytes, size_t pos, int n)
+{
+	uint64_t value = 0;
+	for (int i = n - 1 ; i >= 0 ; i--)
+	{
+		value = (value << 8) | (uint8_t)bytes[pos + i];
+	}
+	return(value);
+}
+
+// Offset in FrameInfoStruct of the field a column holds
+static size_t FieldOffset(const TimelineColumn &column)
+{
+	if (!strcmp(column.name, "peak_meter"))
+	{
+		return(offsetof(FrameInfoStruct, Meter.peak_meter));
+	}
+	if (!strcmp(column.name, "rms_meter"))
+	{
+		return(offsetof(FrameInfoStruct, Meter.rms_meter));
+	}
+	for (int f = 0 ; f < nMetadataFields ; f++)
+	{
+		if (!strcmp(column.name, metadataFields[f].name))
+		{
+			return(metadataFields[f].offset);
+		}
+	}
+	return(0);
+}
+
+int main(void)
+{
+	std::string name = "/tmp/metadata_timeline_test_" + std::to_string(getpid()) + ".ddtl";
+	std::vector<FrameInfoStruct> frames;
+	std::vector<uint64_t> offsets;
+	TimelineWriter writer;
+	DolbyEParser parser;
+
+	std::ifstream in(FIXTURE, std::ios::binary);
+	std::string dde((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	Check(dde.size() > 0, "unable to read " FIXTURE);
+	parser.SetFrameCallback([&](const FrameInfoStruct &frameInfo)
+	{
+		frames.push_back(frameInfo);
+		offsets.push_back(parser.FedFrameOffset());
+		writer.Add(parser.FedFrameOffset(), frameInfo);
+	});
+	parser.Feed((const unsigned char *)dde.data(), dde.size());
+	writer.Write(name);
+
+	std::ifstream written(name, std::ios::binary);
+	std::string bytes((std::istreambuf_iterator<char>(written)), std::istreambuf_iterator<char>());
+	Check(bytes.size() >= sizeof(TimelineHeader) && bytes.compare(0, 4, TIMELINE_MAGIC) == 0, "magic");
+	Check(bytes.size() >= sizeof(TimelineHeader) && LittleEndian(bytes, offsetof(TimelineHeader, version), 4) == TIMELINE_VERSION &&
+		  LittleEndian(bytes, offsetof(TimelineHeader, frames), 4) == frames.size(), "header is not little-endian");
+
+	{
+		TimelineFile timeline(name);
+		Check(frames.size() > 1 && timeline.FrameCount() == frames.size(), "frame count");
+		Check(timeline.FindColumn("peak_meter", 0) >= 0 && timeline.FindColumn("no_such_field", 0) < 0, "FindColumn");
+		for (int c = 0 ; c < timeline.ColumnCount() ; c++)
+		{
+			const TimelineColumn &column = timeline.Column(c);
+			size_t offset = FieldOffset(column);
+			Check(offset != 0, std::string("unknown column ") + column.name);
+			size_t changes = 0;
+			for (uint32_t f = 0 ; offset != 0 && f < frames.size() ; f++)
+			{
+				int32_t expected = ((const int *)((const char *)&frames[f] + offset))[column.element];
+				int32_t value;
+				if (!timeline.ValueAt(c, f, value) || value != expected)
+				{
+					Check(false, std::string(column.name) + " " + std::to_string(column.element) + " at frame " + std::to_string(f));
+					break;
+				}
+				changes += (f > 0 && expected != ((const int *)((const char *)&frames[f - 1] + offset))[column.element]) ? 1 : 0;
+			}
+			Check(timeline.Spans(c, [](int32_t) { return(true); }).size() == changes + 1,
+				  std::string(column.name) + " " + std::to_string(column.element) + " spans");
+		}
+		for (uint32_t f = 0 ; f < frames.size() ; f++)
+		{
+			uint64_t offset;
+			Check(timeline.Timecodes().FrameOffset(f, offset) && offset == offsets[f], "offset of frame " + std::to_string(f));
+			Check(timeline.Timecodes().FrameTimecode(f) == TimecodeIndex::TimecodeFrames(frames[f].timecode, frames[f].frameRate),
+				  "time code of frame " + std::to_string(f));
+		}
+		int32_t value;
+		Check(!timeline.ValueAt(0, (uint32_t)frames.size(), value), "value after the last frame");
+	}
+
+	// Cut short in the runs, past the directory
+	truncate(name.c_str(), (off_t)bytes.size() - sizeof(TimelineRunEntry));
+	bool rejected = false;
+	try
+	{
+		TimelineFile timeline(name);
+	}
+	catch (const std::runtime_error &)
+	{
+		rejected = true;
+	}
+	Check(rejected, "truncated timeline accepted");
+	unlink(name.c_str());
+
+	printf("TimelineWriter/TimelineFile: %s, %d failures\n", failures ? "FAIL" : "pass", failures);
+	return(failures ? 1 : 0);
+}
@@ -0,0 +1,211 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*	Checks of the conversion daemon's stream requests: frames fed through a FIFO come back as S-ADM, and the daemon
+	stops promptly with a stream request whose FIFO no writer ever opens.
+	Run by ctest and run_test.sh from the top of the tree; prints each failure and exits non-zero if there are any */
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "sadm_daemon.h"
+
+#define STOP_LIMIT_MS	3000		/* well over the daemon's poll interval */
+#define FIXTURE			"test/dde/2+2-1.dde"
+
+static int failures = 0;
+
+static void Check(bool ok, const std::string &what)
+{
+	if (!ok)
+	{
+		fprintf(stderr, "FAIL: %s\n", what.c_str());
+		failures++;
+	}
+}
+
+static std::string TempName(const char *what)
+{
+	return("/tmp/sadm_daemon_test_" + std::string(what) + "_" + std::to_string(getpid()));
+}
+
+// A daemon running on its own thread, stopped as by a signal
+class TestDaemon
+{
+private:
+	volatile sig_atomic_t stop;
+	std::atomic<bool> done;
+	std::unique_ptr<SadmDaemon> daemon;
+	std::thread runner;
+
+public:
+	std::string socketPath;
+
+	TestDaemon() : stop(0), done(false), socketPath(TempName("socket"))
+	{
+		daemon.reset(new SadmDaemon(socketPath, 2, 4, NULL));
+		runner = std::thread([this]() { daemon->Run(stop); done = true; });
+	}
+
+	// Whether Run() returned within the limit; if not the thread is left behind, and the process must exit
+	bool Stop(void)
+	{
+		stop = 1;
+		for (int waited = 0 ; waited < STOP_LIMIT_MS && !done ; waited += 10)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		if (!done)
+		{
+			runner.detach();
+			return(false);
+		}
+		runner.join();
+		return(true);
+	}
+};
+
+static int Connect(const std::string &socketPath)
+{
+	struct sockaddr_un addr;
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, socketPath.c_str());
+	if (fd >= 0 && connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+	{
+		close(fd);
+		fd = -1;
+	}
+	return(fd);
+}
+
+// The fixture written into a FIFO comes back as one S-ADM document per frame
+static void CheckStream(void)
+{
+	std::ifstream in(FIXTURE, std::ios::binary);
+	std::string dde((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	Check(!dde.empty(), "stream: unable to read " FIXTURE);
+
+	std::string fifo = TempName("fifo");
+	unlink(fifo.c_str());
+	Check(mkfifo(fifo.c_str(), 0600) == 0, "stream: unable to create FIFO");
+
+	TestDaemon daemon;
+	int fd = Connect(daemon.socketPath);
+	Check(fd >= 0, "stream: unable to connect");
+	if (fd >= 0)
+	{
+		SadmWriteMsg(fd, SADM_REQ_STREAM, 1, fifo.data(), fifo.size());
+
+		// Blocks until the daemon has the FIFO open
+		int fifoFd = open(fifo.c_str(), O_WRONLY);
+		Check(fifoFd >= 0 && write(fifoFd, dde.data(), dde.size()) == (ssize_t)dde.size(), "stream: unable to write FIFO");
+		if (fifoFd >= 0)
+		{
+			close(fifoFd);
+		}
+
+		SadmMsgHeader header;
+		std::string payload;
+		unsigned int frames = 0;
+		while (SadmReadMsg(fd, header, payload) && header.type == SADM_RSP_XML)
+		{
+			frames += (payload.find("<?xml") != std::string::npos) ? 1 : 0;
+		}
+		Check(header.type == SADM_RSP_END, "stream: ended with response " + std::to_string(header.type));
+		Check(frames > 1, "stream: " + std::to_string(frames) + " frames");
+		close(fd);
+	}
+	Check(daemon.Stop(), "stream: daemon did not stop");
+	unlink(fifo.c_str());
+}
+
+// A stream request waiting for a writer that never comes does not hold up shutdown, and still ends its response
+static void CheckUnconnectedStream(void)
+{
+	std::string fifo = TempName("unconnected");
+	unlink(fifo.c_str());
+	Check(mkfifo(fifo.c_str(), 0600) == 0, "unconnected: unable to create FIFO");
+
+	TestDaemon daemon;
+	int fd = Connect(daemon.socketPath);
+	Check(fd >= 0, "unconnected: unable to connect");
+	if (fd >= 0)
+	{
+		SadmWriteMsg(fd, SADM_REQ_STREAM, 1, fifo.data(), fifo.size());
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	if (!daemon.Stop())
+	{
+		Check(false, "unconnected: daemon still running " + std::to_string(STOP_LIMIT_MS) + " ms after the stop");
+		unlink(fifo.c_str());
+		printf("SadmDaemon: FAIL, %d failures\n", failures);
+		fflush(stdout);
+		_exit(1);
+	}
+	if (fd >= 0)
+	{
+		SadmMsgHeader header;
+		std::string payload;
+		Check(SadmReadMsg(fd, header, payload) && header.type == SADM_RSP_END && header.id == 1, "unconnected: no end response");
+		close(fd);
+	}
+	unlink(fifo.c_str());
+}
+
+int main(void)
+{
+	CheckStream();
+	CheckUnconnectedStream();
+
+	printf("SadmDaemon: %s, %d failures\n", failures ? "FAIL" : "pass", failures);
+	return(failures ? 1 : 0);
+}
@@ -0,0 +1,198 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*	Round trip of S-ADM frames through the shared memory ring: ShmFrameSink to ShmFrameReader in block mode, with records
+	wrapping across the end of the mirror mapped data area, and in overwrite mode, with the reader lapped by the writer.
+	Run by ctest and run_test.sh; prints each failure and exits non-zero if there are any */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string>
+#include <memory>
+#include <thread>
+
+#include "sadm_shm_sink.h"
+
+#define RING_SZ			4096		/* one page, so a few frames wrap the ring */
+#define BLOCK_FRAMES	300
+
+static int failures = 0;
+
+static void Check(bool ok, const std::string &what)
+{
+	if (!ok)
+	{
+		fprintf(stderr, "FAIL: %s\n", what.c_str());
+		failures++;
+	}
+}
+
+static std::string RingName(const char *mode)
+{
+	return("shm_ring_test_" + std::string(mode) + "_" + std::to_string(getpid()));
+}
+
+static size_t RecordSize(size_t xmlLen)
+{
+	return((sizeof(ShmFrameRecord) + xmlLen + SHM_FRAME_ALIGN - 1) & ~(size_t)(SHM_FRAME_ALIGN - 1));
+}
+
+// Frames of varying length whose contents depend on their number, so a misplaced or torn copy shows
+static std::string FrameXml(unsigned int frame, size_t len)
+{
+	std::string xml(len, ' ');
+	for (size_t i = 0 ; i < len ; i++)
+	{
+		xml[i] = (char)('a' + (frame * 7 + i) % 26);
+	}
+	return(xml);
+}
+
+static size_t FrameLen(unsigned int frame)
+{
+	return(100 + (frame * 397) % 1400);
+}
+
+// Written in two parts, as the S-ADM writer does, so the record is regrown in place before EndFrame()
+static void WriteFrame(ShmFrameSink &sink, unsigned int frame, size_t len)
+{
+	std::string xml = FrameXml(frame, len);
+	std::string timecode = "00:00:" + std::to_string(10 + frame % 50) + ":00";
+	sink.BeginFrame(frame, timecode.c_str());
+	sink.Write((const unsigned char *)xml.data(), len / 3);
+	sink.Write((const unsigned char *)xml.data() + len / 3, len - len / 3);
+	sink.EndFrame();
+}
+
+static bool ReadFrame(ShmFrameReader &reader, unsigned int frame, size_t len, uint64_t sequence, const std::string &what)
+{
+	ShmFrameRecord record;
+	std::string xml;
+	if (!reader.Next(record, xml, 5000))
+	{
+		Check(false, what + ": no frame");
+		return(false);
+	}
+	std::string timecode = "00:00:" + std::to_string(10 + frame % 50) + ":00";
+	Check(record.sequence == sequence, what + ": sequence " + std::to_string(record.sequence) + ", expected " +
+		std::to_string(sequence));
+	Check(record.frameCount == frame && timecode == record.timecode, what + ": frame " + std::to_string(frame) + " labels");
+	Check(xml == FrameXml(frame, len), what + ": frame " + std::to_string(frame) + " contents");
+	return(true);
+}
+
+// Block mode: every frame arrives in order while the writer waits for space, including those split by the end of the ring
+static void CheckBlock(void)
+{
+	std::unique_ptr<ShmFrameSink> sink(new ShmFrameSink(RingName("block"), RING_SZ));
+	ShmFrameReader reader(RingName("block"));
+
+	std::thread writer([&sink]()
+	{
+		for (unsigned int frame = 0 ; frame < BLOCK_FRAMES ; frame++)
+		{
+			WriteFrame(*sink, frame, FrameLen(frame));
+		}
+	});
+
+	uint64_t pos = 0;
+	unsigned int wrapped = 0;
+	for (unsigned int frame = 0 ; frame < BLOCK_FRAMES ; frame++)
+	{
+		if (!ReadFrame(reader, frame, FrameLen(frame), frame, "block"))
+		{
+			break;
+		}
+		size_t size = RecordSize(FrameLen(frame));
+		wrapped += (pos % RING_SZ + size > RING_SZ) ? 1 : 0;
+		pos += size;
+	}
+	writer.join();
+	Check(wrapped > 0, "block: no frame wrapped the ring");
+	Check(reader.Lost() == 0, "block: frames lost");
+
+	// Once the writer has gone the reader sees the end of the stream rather than waiting
+	sink.reset();
+	ShmFrameRecord record;
+	std::string xml;
+	Check(!reader.Next(record, xml, 0), "block: frame after the writer closed");
+}
+
+// Overwrite mode: a reader left behind by more than a ring's worth resumes at the latest frame and counts those it missed
+static void CheckOverwrite(void)
+{
+	ShmFrameSink sink(RingName("overwrite"), RING_SZ, true);
+	ShmFrameReader reader(RingName("overwrite"));
+	ShmFrameRecord record;
+	std::string xml;
+
+	unsigned int frame = 0;
+	for ( ; frame < 3 ; frame++)
+	{
+		WriteFrame(sink, frame, FrameLen(frame));
+		ReadFrame(reader, frame, FrameLen(frame), frame, "overwrite in step");
+	}
+	Check(!reader.Next(record, xml, 0), "overwrite: frame before one was written");
+
+	uint64_t written = 0;
+	for ( ; written < 4 * RING_SZ ; frame++)
+	{
+		WriteFrame(sink, frame, FrameLen(frame));
+		written += RecordSize(FrameLen(frame));
+	}
+	ReadFrame(reader, frame - 1, FrameLen(frame - 1), frame - 1, "overwrite lapped");
+	Check(reader.Lost() == frame - 4, "overwrite: lost " + std::to_string(reader.Lost()) + ", expected " +
+		std::to_string(frame - 4));
+
+	WriteFrame(sink, frame, FrameLen(frame));
+	ReadFrame(reader, frame, FrameLen(frame), frame, "overwrite after the lap");
+	Check(reader.Lost() == frame - 4, "overwrite: frames lost after the lap");
+
+	// A reader starting late begins at the latest frame, and the ones before it do not count as lost
+	ShmFrameReader late(RingName("overwrite"));
+	ReadFrame(late, frame, FrameLen(frame), frame, "overwrite late reader");
+	Check(late.Lost() == 0, "overwrite: late reader lost frames");
+}
+
+int main(void)
+{
+	CheckBlock();
+	CheckOverwrite();
+
+	printf("ShmFrameSink/ShmFrameReader: %s, %d failures\n", failures ? "FAIL" : "pass", failures);
+	return(failures ? 1 : 0);
+}
@@ -0,0 +1,170 @@
+/****************************************************************************
+ *
+ *
+ * Copyright (c) 2024 Dolby International AB.
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************/
+
+/*	Checks of TimecodeIndex time code arithmetic: drop frame counting, midnight and runs broken by time code jumps.
+	Run by ctest and run_test.sh; prints each failure and exits non-zero if there are any */
+
+#include <stdio.h>
+#include <string>
+
+#include "timecode_index.h"
+
+#define RATE_2997		4			/* frame_rate_code of 29.97 fps, drop frame */
+#define RATE_5994		7			/* 59.94 fps, drop frame */
+#define RATE_25			3
+#define DAY_2997		2589408		/* frames from midnight to midnight at 29.97 drop frame */
+#define STRIDE			14608		/* bytes between frames in the index checks */
+
+static int failures = 0;
+
+static void Check(bool ok, const std::string &what)
+{
+	if (!ok)
+	{
+		fprintf(stderr, "FAIL: %s\n", what.c_str());
+		failures++;
+	}
+}
+
+static int32_t Frames(const char *text, int frameRateCode)
+{
+	int32_t frames;
+	return(TimecodeIndex::ParseTimecode(text, frameRateCode, frames) ? frames : -1);
+}
+
+// BCD SMPTE_time_code of frames since midnight, with the drop frame flag set
+static void MakeTimecode(int32_t frames, int frameRateCode, int timecode[8])
+{
+	for (int i = 0 ; i < 8 ; i++)
+	{
+		timecode[i] = 0;
+	}
+	timecode[7] = 0x40;
+	TimecodeIndex::SetTimecode(frames, frameRateCode, timecode);
+}
+
+// Each frame of a day is labelled, parsed and encoded back to itself, and labels follow on from frame to frame
+static void CheckDay(void)
+{
+	int timecode[8];
+	int mismatches = 0;
+
+	for (int32_t frames = 0 ; frames < DAY_2997 ; frames++)
+	{
+		std::string text = TimecodeIndex::TimecodeText(frames, RATE_2997);
+		MakeTimecode(frames, RATE_2997, timecode);
+		if (Frames(text.c_str(), RATE_2997) != frames || TimecodeIndex::TimecodeFrames(timecode, RATE_2997) != frames)
+		{
+			if (mismatches++ == 0)
+			{
+				Check(false, "round trip of frame " + std::to_string(frames) + " (" + text + ")");
+			}
+		}
+	}
+	Check(Frames("23:59:59;29", RATE_2997) == DAY_2997 - 1, "last frame of the day at 29.97");
+
+	// Wraps at midnight
+	MakeTimecode(DAY_2997, RATE_2997, timecode);
+	Check(TimecodeIndex::TimecodeFrames(timecode, RATE_2997) == 0, "midnight wrap of SetTimecode()");
+}
+
+static void CheckDropFrame(void)
+{
+	// Frame numbers 0 and 1 are skipped at each minute but every tenth
+	Check(Frames("00:01:00;02", RATE_2997) == Frames("00:00:59;29", RATE_2997) + 1, "drop at 00:01:00 at 29.97");
+	Check(Frames("00:10:00;00", RATE_2997) == Frames("00:09:59;29", RATE_2997) + 1, "no drop at 00:10:00 at 29.97");
+	Check(Frames("00:01:00;00", RATE_2997) < 0 && Frames("00:01:00;01", RATE_2997) < 0, "dropped labels rejected at 29.97");
+	Check(TimecodeIndex::TimecodeText(17982, RATE_2997) == "00:10:00;00", "label of the first frame of minute 10");
+
+	// Four are skipped at 59.94, and none at 25
+	Check(Frames("00:01:00;04", RATE_5994) == Frames("00:00:59;59", RATE_5994) + 1, "drop at 00:01:00 at 59.94");
+	Check(Frames("00:01:00;03", RATE_5994) < 0, "dropped label rejected at 59.94");
+	Check(Frames("00:01:00:00", RATE_25) == Frames("00:00:59:24", RATE_25) + 1, "no drop at 25");
+}
+
+// Runs broken by a time code jump, by a change of spacing and by midnight
+static void CheckIndex(void)
+{
+	struct { const char *start; int count; uint64_t gap; } spans[] =
+	{
+		{ "00:00:59;28", 4, 0 },		/* across a dropped minute, one run */
+		{ "10:00:00;00", 3, 0 },		/* time code jump */
+		{ "10:00:00;03", 2, 4 },		/* spacing change */
+		{ "23:59:59;28", 4, 0 },		/* across midnight, so two runs */
+	};
+	TimecodeIndex index;
+	int timecode[8];
+	uint64_t offset = 0;
+	uint32_t frameNo;
+
+	for (const auto &span : spans)
+	{
+		offset += span.gap;
+		for (int i = 0 ; i < span.count ; i++)
+		{
+			MakeTimecode(Frames(span.start, RATE_2997) + i, RATE_2997, timecode);
+			index.Add(offset, timecode, RATE_2997);
+			offset += STRIDE;
+		}
+	}
+	index.Finish();
+
+	Check(index.FrameCount() == 13, "frames indexed");
+	Check(index.Runs().size() == 5, "runs: " + std::to_string(index.Runs().size()) + ", expected 5");
+	Check(index.FrameTimecode(2) == Frames("00:01:00;02", RATE_2997), "time code after the dropped frame numbers");
+	Check(index.FrameTimecode(12) == 1, "time code after midnight");
+	Check(index.FindPosition("00:01:00;03", frameNo) && frameNo == 3, "find across the dropped frame numbers");
+	Check(!index.FindPosition("00:01:00;00", frameNo), "dropped label not found");
+	Check(index.FindPosition("10:00:00;04", frameNo) && frameNo == 8, "find after a spacing change");
+	Check(index.FindPosition("23:59:59;29", frameNo) && frameNo == 10, "find before midnight");
+	Check(index.FindPosition("00:00:00;00", frameNo) && frameNo == 11, "find after midnight");
+	Check(!index.FindPosition("10:00:00;05", frameNo), "time code in no run not found");
+
+	uint64_t frameOffset = 0;
+	Check(index.FrameOffset(8, frameOffset) && frameOffset == 8 * STRIDE + 4, "offset after a spacing change");
+	Check(index.FrameOffset(12, frameOffset) && frameOffset == 12 * STRIDE + 4, "offset after midnight");
+}
+
+int main(void)
+{
+	CheckDay();
+	CheckDropFrame();
+	CheckIndex();
+
+	printf("TimecodeIndex: %s, %d failures\n", failures ? "FAIL" : "pass", failures);
+	return(failures ? 1 : 0);
+}